@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+Action agent for the TIDBIT keyboard: runs host commands the keys ask for
+
+The keyboard used to start apps and scripts by typing Win+R and a full bat
+file path, some hundred keystrokes per action. With this agent running it
+sends one HID_OP_ACTION report with the action's ID instead; the agent runs
+the command and reports back, and the OLED shows "Done: ..." or
+"Failed: ...".
+
+Action IDs are numbered from apps.txt exactly like the firmware's
+app_table.h (see app_table.read_table()). The command for each action comes
+from actions.txt, per platform; on Windows an action without a line there
+runs the bat file or command listed in apps.txt. Elsewhere only actions
+listed in actions.txt run, the others are answered with "No command".
+
+Every HELLO_INTERVAL seconds the agent announces itself with the action
+count and table CRC, so a keyboard that was replugged finds it again; a
+keyboard flashed from a different apps.txt keeps typing instead.
+
+    python action_agent.py           # run, connected through hid_broker.py
+    python action_agent.py --list    # print every action and its command here
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import threading
+import time
+
+from app_table import read_table, table_crc
+from hid_client import HidClient
+from hid_protocol import (REPORT_LENGTH, HID_OP_ACTION, HID_ACTION_RUN, HID_ACTION_ID, HID_ACTION_TAG,
+                          HID_ACTION_STARTED, HID_ACTION_DONE, HID_ACTION_FAILED, HID_ACTION_UNKNOWN,
+                          action_hello_report, action_result_report, check_version)
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+APPS_FILE = os.path.join(HERE, "apps.txt")
+COMMANDS_FILE = os.path.join(HERE, "actions.txt")
+
+HELLO_INTERVAL = 5.0  # Seconds between announcements
+COMMAND_WAIT = 5.0    # A command still running after this long counts as started fine
+PLATFORMS = {"win32": "windows", "darwin": "macos"}
+
+
+def platform_name():
+    return PLATFORMS.get(sys.platform, "linux" if sys.platform.startswith("linux") else sys.platform)
+
+
+def load_commands(path, actions, platform=None):
+    """{action ident: shell command} for this platform
+
+    Windows defaults to the apps.txt command of every action (bat files run
+    from this folder); actions.txt lines in the platform's section override
+    or add to that.
+    """
+    platform = platform or platform_name()
+    commands = {}
+    if platform == "windows":
+        for action in actions:
+            commands[action.ident] = f'"{os.path.join(HERE, action.command)}"' if action.bat else action.command
+
+    known = {action.ident for action in actions}
+    section = None
+    if os.path.exists(path):
+        with open(path) as f:
+            for number, line in enumerate(f, 1):
+                line = line.split("#", 1)[0].strip()
+                if not line:
+                    continue
+                if line.startswith("["):
+                    section = line.strip("[]")
+                    continue
+                if section != platform:
+                    continue
+                ident, _, command = line.partition(" ")
+                if ident not in known:
+                    raise ValueError(f"{path}:{number}: no action {ident} in apps.txt")
+                commands[ident] = command.strip()
+    return commands
+
+
+class ActionAgent:
+    """Answers HID_ACTION_RUN reports by running the action's command
+
+    Args:
+        keyboard: HidClient (or fake) subscribed to HID_OP_ACTION
+        actions: app_table.Action list, in firmware order
+        commands: {action ident: shell command}
+        hello_interval: seconds between HID_ACTION_HELLO announcements
+        command_wait: seconds to wait for a command before reporting it done
+        log: callable(message) for each action run
+        handlers: {action ident: callable() -> (HID_ACTION_* status, text)}
+            for actions handled in this process instead of by a command
+    """
+
+    def __init__(self, keyboard, actions, commands, hello_interval=HELLO_INTERVAL, command_wait=COMMAND_WAIT,
+                 log=print, handlers=None):
+        self.keyboard = keyboard
+        self.actions = actions
+        self.commands = commands
+        self.handlers = handlers or {}
+        self.hello_interval = hello_interval
+        self.command_wait = command_wait
+        self.log = log
+        self.crc = table_crc(actions)
+        self.runs = 0
+        self._write_lock = threading.Lock()
+        self._stop = threading.Event()
+        self._thread = None
+
+    def start(self):
+        self._thread = threading.Thread(target=self._hello_loop, name="action-hello", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._stop.set()
+        if self._thread:
+            self._thread.join()
+
+    def send(self, report):
+        with self._write_lock:
+            self.keyboard.write(report)
+
+    def hello(self):
+        self.send(action_hello_report(len(self.actions), self.crc))
+
+    def _hello_loop(self):
+        while not self._stop.is_set():
+            try:
+                self.hello()
+            except OSError:
+                pass  # Broker reconnect is up to the main loop
+            self._stop.wait(self.hello_interval)
+
+    def handle(self, data):
+        """Process one report from the keyboard; True if it was a run"""
+        if len(data) <= HID_ACTION_TAG or data[0] != HID_OP_ACTION or data[1] != HID_ACTION_RUN:
+            return False
+        action_id, tag = data[HID_ACTION_ID], data[HID_ACTION_TAG]
+        if action_id >= len(self.actions):
+            self.send(action_result_report(action_id, tag, HID_ACTION_UNKNOWN, f"action {action_id}"))
+            return True
+
+        action = self.actions[action_id]
+        handler = self.handlers.get(action.ident)
+        if handler:
+            status, text = handler()
+            self.log(f"{action.ident}: {text}")
+            self.send(action_result_report(action_id, tag, status, text))
+            return True
+
+        command = self.commands.get(action.ident)
+        if not command:
+            self.log(f"{action.ident}: no command on {platform_name()}")
+            self.send(action_result_report(action_id, tag, HID_ACTION_UNKNOWN, action.label))
+            return True
+
+        # Answer at once so the keyboard does not type it as well, then wait
+        # for the command on a worker thread
+        self.runs += 1
+        self.send(action_result_report(action_id, tag, HID_ACTION_STARTED, action.label))
+        threading.Thread(target=self._run, args=(action_id, tag, action, command),
+                         name=f"action-{action.ident.lower()}", daemon=True).start()
+        return True
+
+    def _run(self, action_id, tag, action, command):
+        kwargs = {}
+        if sys.platform == 'win32':
+            kwargs['creationflags'] = subprocess.CREATE_NO_WINDOW
+        else:
+            kwargs['start_new_session'] = True
+        try:
+            process = subprocess.Popen(command, shell=True, cwd=HERE, stdin=subprocess.DEVNULL,
+                                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, **kwargs)
+            try:
+                code = process.wait(self.command_wait)
+            except subprocess.TimeoutExpired:
+                code = 0  # Still running: a started app or script
+        except OSError as e:
+            self.log(f"{action.ident}: {e}")
+            code = None
+
+        status = HID_ACTION_DONE if code == 0 else HID_ACTION_FAILED
+        self.log(f"{action.ident}: {command} -> {'done' if code == 0 else f'failed ({code})'}")
+        try:
+            self.send(action_result_report(action_id, tag, status, action.label))
+        except OSError:
+            pass
+
+
+def print_actions(actions, commands):
+    print(f"{len(actions)} actions, table CRC 0x{table_crc(actions):02X}, commands for {platform_name()}:")
+    for number, action in enumerate(actions):
+        print(f"  {number:3d} {action.ident:<20} {commands.get(action.ident, '-')}")
+
+
+def run_agent(make_agent):
+    """Feed keyboard reports to make_agent(keyboard) until Ctrl+C
+
+    Connects to the HID broker, and reconnects (starting a new broker if
+    needed) whenever the connection is lost.
+    """
+    try:
+        keyboard = HidClient([HID_OP_ACTION])
+        print("Connected to HID broker")
+        check_version(keyboard)
+    except Exception as e:
+        print(f"ERROR: Could not connect to HID broker: {e}")
+        return
+
+    agent = make_agent(keyboard).start()
+    print("Press Ctrl+C to stop.\n")
+    while True:
+        try:
+            data = keyboard.read(REPORT_LENGTH, timeout_ms=1000)
+            if data:
+                agent.handle(data)
+        except KeyboardInterrupt:
+            break
+        except (ConnectionError, OSError) as e:
+            print(f"Error: {e}")
+            time.sleep(1)
+            # Broker went away - reconnect, starting a new one if needed
+            try:
+                keyboard.close()
+                keyboard = HidClient([HID_OP_ACTION])
+                agent.keyboard = keyboard
+                agent.hello()
+            except OSError:
+                pass
+
+    agent.stop()
+    keyboard.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--apps", default=APPS_FILE, help="apps.txt the firmware was built from")
+    parser.add_argument("--commands", default=COMMANDS_FILE, help="per-platform commands")
+    parser.add_argument("--list", action="store_true", help="print the actions and exit")
+    args = parser.parse_args()
+
+    try:
+        _, actions = read_table(args.apps)
+        commands = load_commands(args.commands, actions)
+    except (OSError, ValueError) as e:
+        sys.exit(f"ERROR: {e}")
+    if args.list:
+        print_actions(actions, commands)
+        return
+
+    print("Action agent started...")
+    print(f"{sum(1 for a in actions if a.ident in commands)} of {len(actions)} actions have a command here.")
+    run_agent(lambda keyboard: ActionAgent(keyboard, actions, commands))
+    print("\nAction agent stopped")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+// Generated by app_table.py from apps.txt, do not edit.
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef OLED_ENABLE
+#    include "logos.h"
+#    define APP_LOGO(logo) logo
+#else
+#    define APP_LOGO(logo) NULL
+#endif
+
+typedef enum {
+    APP_STEAM = 0,
+    APP_DISCORD,
+    APP_WALLPAPER,
+    APP_NORDVPN,
+    APP_IDLE,
+    APP_MONITOR,
+    APP_COUNT
+} app_id_t;
+
+#define APP_WHEEL_COUNT 4  // APP_STEAM..APP_NORDVPN, cycled by encoder 0
+
+typedef enum {
+    ACTION_STEAM_START = 0,
+    ACTION_STEAM_KILL,
+    ACTION_DISCORD_START,
+    ACTION_DISCORD_KILL,
+    ACTION_WALLPAPER_START,
+    ACTION_WALLPAPER_KILL,
+    ACTION_NORDVPN_START,
+    ACTION_NORDVPN_KILL,
+    ACTION_MONITOR_START,
+    ACTION_MONITOR_KILL,
+    ACTION_VOLUME_START,
+    ACTION_VOLUME_KILL,
+    ACTION_DISCORD_BOT_START,
+    ACTION_DISCORD_BOT_KILL,
+    ACTION_LIFX_START,
+    ACTION_LIFX_KILL,
+    ACTION_SHUTDOWN,
+    ACTION_HIBERNATE,
+    ACTION_RESTART,
+    ACTION_COUNT
+} action_id_t;
+
+#define ACTION_NONE      0xFF
+#define ACTION_TABLE_CRC 0xC8  // Sent back by action_agent.py
+
+typedef struct {
+    const char *name_P;  // Banner when there is no logo
+    const char *logo_P;  // Packed bitmap from logos.h, or NULL
+    uint8_t     start;   // ACTION_* or ACTION_NONE
+    uint8_t     kill;
+} app_t;
+
+typedef struct {
+    const char *command_P;  // Typed into Win+R when no action agent answers
+    bool        bat;        // command_P is a bat file, typed with its path
+} action_t;
+
+static const char PROGMEM app_steam_name[] = "Steam";
+static const char PROGMEM app_discord_name[] = "Discord";
+static const char PROGMEM app_wallpaper_name[] = "Desktop WP";
+static const char PROGMEM app_nordvpn_name[] = "NordVPN";
+static const char PROGMEM app_idle_name[] = "Idle";
+static const char PROGMEM app_monitor_name[] = "Monitoring";
+static const char PROGMEM action_steam_start[] = "start_steam.bat";
+static const char PROGMEM action_steam_kill[] = "kill_steam.bat";
+static const char PROGMEM action_discord_start[] = "start_discord.bat";
+static const char PROGMEM action_discord_kill[] = "kill_discord.bat";
+static const char PROGMEM action_wallpaper_start[] = "start_wallpaper.bat";
+static const char PROGMEM action_wallpaper_kill[] = "kill_wallpaper.bat";
+static const char PROGMEM action_nordvpn_start[] = "start_nordvpn.bat";
+static const char PROGMEM action_nordvpn_kill[] = "kill_nordvpn.bat";
+static const char PROGMEM action_monitor_start[] = "start_monitor.bat";
+static const char PROGMEM action_monitor_kill[] = "kill_monitor.bat";
+static const char PROGMEM action_volume_start[] = "start_volume.bat";
+static const char PROGMEM action_volume_kill[] = "kill_volume.bat";
+static const char PROGMEM action_discord_bot_start[] = "start_discord.bat";
+static const char PROGMEM action_discord_bot_kill[] = "kill_discord.bat";
+static const char PROGMEM action_lifx_start[] = "start_lifx.bat";
+static const char PROGMEM action_lifx_kill[] = "kill_lifx.bat";
+static const char PROGMEM action_shutdown[] = "shutdown /s /t 0";
+static const char PROGMEM action_hibernate[] = "shutdown /h";
+static const char PROGMEM action_restart[] = "shutdown /r /t 0";
+
+static const app_t PROGMEM apps[APP_COUNT] = {
+    [APP_STEAM]     = {app_steam_name, APP_LOGO(logo_steam), ACTION_STEAM_START, ACTION_STEAM_KILL},
+    [APP_DISCORD]   = {app_discord_name, APP_LOGO(logo_discord), ACTION_DISCORD_START, ACTION_DISCORD_KILL},
+    [APP_WALLPAPER] = {app_wallpaper_name, APP_LOGO(logo_desktop_wp), ACTION_WALLPAPER_START, ACTION_WALLPAPER_KILL},
+    [APP_NORDVPN]   = {app_nordvpn_name, APP_LOGO(logo_nordvpn), ACTION_NORDVPN_START, ACTION_NORDVPN_KILL},
+    [APP_IDLE]      = {app_idle_name, APP_LOGO(my_logo), ACTION_NONE, ACTION_NONE},
+    [APP_MONITOR]   = {app_monitor_name, NULL, ACTION_MONITOR_START, ACTION_MONITOR_KILL},
+};
+
+static const action_t PROGMEM actions[ACTION_COUNT] = {
+    [ACTION_STEAM_START]       = {action_steam_start, true},
+    [ACTION_STEAM_KILL]        = {action_steam_kill, true},
+    [ACTION_DISCORD_START]     = {action_discord_start, true},
+    [ACTION_DISCORD_KILL]      = {action_discord_kill, true},
+    [ACTION_WALLPAPER_START]   = {action_wallpaper_start, true},
+    [ACTION_WALLPAPER_KILL]    = {action_wallpaper_kill, true},
+    [ACTION_NORDVPN_START]     = {action_nordvpn_start, true},
+    [ACTION_NORDVPN_KILL]      = {action_nordvpn_kill, true},
+    [ACTION_MONITOR_START]     = {action_monitor_start, true},
+    [ACTION_MONITOR_KILL]      = {action_monitor_kill, true},
+    [ACTION_VOLUME_START]      = {action_volume_start, true},
+    [ACTION_VOLUME_KILL]       = {action_volume_kill, true},
+    [ACTION_DISCORD_BOT_START] = {action_discord_bot_start, true},
+    [ACTION_DISCORD_BOT_KILL]  = {action_discord_bot_kill, true},
+    [ACTION_LIFX_START]        = {action_lifx_start, true},
+    [ACTION_LIFX_KILL]         = {action_lifx_kill, true},
+    [ACTION_SHUTDOWN]          = {action_shutdown, false},
+    [ACTION_HIBERNATE]         = {action_hibernate, false},
+    [ACTION_RESTART]           = {action_restart, false},
+};
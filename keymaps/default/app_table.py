@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+Generate app_table.h, the firmware's app and action tables, from apps.txt
+
+Each app in apps.txt becomes an APP_<ID> constant and one row of the
+PROGMEM apps[] table: display name, packed logo and the actions that start
+and kill it. The [wheel] apps come first, so the index encoder 0 selects is
+the app's ID.
+
+Every start and kill bat file of an app, and every line of the [actions]
+section, becomes an ACTION_<ID> constant with the Win+R command the
+keyboard types when no action agent answers. action_agent.py numbers the
+actions with read_table() below, so both sides agree on every ID; the
+ACTION_TABLE_CRC of the names lets them check.
+
+    python3 app_table.py [apps.txt] [-o app_table.h]
+
+Logos must exist in logos/ and bat files next to apps.txt; names and
+labels must fit one OLED line.
+"""
+
+import argparse
+import os
+import re
+import shlex
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+OLED_COLS = 21
+SECTIONS = ("wheel", "other", "actions")
+MAX_ACTIONS = 255  # 0xFF is "no action"
+
+
+class App:
+    def __init__(self, ident, name, logo, start, kill, wheel):
+        self.ident = ident
+        self.name = name
+        self.logo = logo
+        self.start = start  # Action or None
+        self.kill = kill
+        self.wheel = wheel
+
+
+class Action:
+    """One host action: ACTION_<ident>, shown as label, typed as command"""
+
+    def __init__(self, ident, label, command):
+        self.ident = ident
+        self.label = label
+        self.command = command
+
+    @property
+    def bat(self):
+        """True for a bat file next to apps.txt, typed with its path"""
+        return self.command.lower().endswith(".bat")
+
+
+def _check_ident(ident, where):
+    if not re.fullmatch(r"[A-Z][A-Z0-9_]*", ident or ""):
+        raise ValueError(f"{where}: ID must be upper case letters, digits and _")
+
+
+def _check_text(text, what, where):
+    if not text or len(text) > OLED_COLS:
+        raise ValueError(f"{where}: {what} must be 1-{OLED_COLS} characters")
+
+
+def read_table(path):
+    """(apps, actions) of apps.txt, in firmware order"""
+    base = os.path.dirname(os.path.abspath(path))
+    apps = []
+    extra = []
+    section = None
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            where = f"{path}:{number}"
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            if line.startswith("["):
+                section = line.strip("[]")
+                if section not in SECTIONS:
+                    raise ValueError(f"{where}: unknown section [{section}]")
+                continue
+            if section is None:
+                raise ValueError(f"{where}: line outside a [wheel], [other] or [actions] section")
+
+            fields = shlex.split(line)
+            if section == "actions":
+                if len(fields) != 3:
+                    raise ValueError(f"{where}: expected ID \"Label\" command")
+                ident, label, command = fields
+                _check_ident(ident, where)
+                _check_text(label, "label", where)
+                extra.append((Action(ident, label, command), where))
+                continue
+
+            if len(fields) != 5:
+                raise ValueError(f"{where}: expected ID \"Name\" logo start kill")
+            ident, name, logo, start, kill = (None if f == "-" else f for f in fields)
+            _check_ident(ident, where)
+            if any(app.ident == ident for app, _ in apps):
+                raise ValueError(f"{where}: APP_{ident} is listed twice")
+            _check_text(name, "name", where)
+            if logo and not os.path.exists(os.path.join(base, "logos", logo + ".txt")):
+                raise ValueError(f"{where}: no logos/{logo}.txt")
+            if section == "wheel" and not (start and kill):
+                raise ValueError(f"{where}: wheel apps need a start and a kill file")
+            start = start and Action(f"{ident}_START", _short(f"Start {name}"), start)
+            kill = kill and Action(f"{ident}_KILL", _short(f"Kill {name}"), kill)
+            apps.append((App(ident, name, logo, start, kill, section == "wheel"), where))
+
+    # Wheel apps first, each group in file order
+    apps = [a for a in apps if a[0].wheel] + [a for a in apps if not a[0].wheel]
+    actions = []
+    for app, where in apps:
+        actions += [(a, where) for a in (app.start, app.kill) if a]
+    actions += extra
+
+    seen = set()
+    for action, where in actions:
+        if action.ident in seen:
+            raise ValueError(f"{where}: ACTION_{action.ident} is defined twice")
+        seen.add(action.ident)
+        if action.bat and not os.path.exists(os.path.join(base, action.command)):
+            raise ValueError(f"{where}: no {action.command}")
+    if len(actions) > MAX_ACTIONS:
+        raise ValueError(f"{path}: {len(actions)} actions, at most {MAX_ACTIONS}")
+    return [app for app, _ in apps], [action for action, _ in actions]
+
+
+def _short(text):
+    return text if len(text) <= OLED_COLS else text[:OLED_COLS]
+
+
+def table_crc(actions):
+    """CRC-8 (polynomial 0x07) of the action names, one per line"""
+    crc = 0
+    for byte in "\n".join(a.ident for a in actions).encode("ascii"):
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def _c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def write_header(path, apps, actions, source):
+    wheel = sum(app.wheel for app in apps)
+    lines = [
+        f"// Generated by app_table.py from {source}, do not edit.",
+        "",
+        "#pragma once",
+        "",
+        "#include \"quantum.h\"",
+        "",
+        "#ifdef OLED_ENABLE",
+        "#    include \"logos.h\"",
+        "#    define APP_LOGO(logo) logo",
+        "#else",
+        "#    define APP_LOGO(logo) NULL",
+        "#endif",
+        "",
+        "typedef enum {",
+    ]
+    for i, app in enumerate(apps):
+        lines.append(f"    APP_{app.ident}{' = 0' if i == 0 else ''},")
+    lines += [
+        "    APP_COUNT",
+        "} app_id_t;",
+        "",
+        f"#define APP_WHEEL_COUNT {wheel}  // APP_{apps[0].ident}..APP_{apps[wheel - 1].ident}, cycled by encoder 0",
+        "",
+        "typedef enum {",
+    ]
+    for i, action in enumerate(actions):
+        lines.append(f"    ACTION_{action.ident}{' = 0' if i == 0 else ''},")
+    lines += [
+        "    ACTION_COUNT",
+        "} action_id_t;",
+        "",
+        "#define ACTION_NONE      0xFF",
+        f"#define ACTION_TABLE_CRC 0x{table_crc(actions):02X}  // Sent back by action_agent.py",
+        "",
+        "typedef struct {",
+        "    const char *name_P;  // Banner when there is no logo",
+        "    const char *logo_P;  // Packed bitmap from logos.h, or NULL",
+        "    uint8_t     start;   // ACTION_* or ACTION_NONE",
+        "    uint8_t     kill;",
+        "} app_t;",
+        "",
+        "typedef struct {",
+        "    const char *command_P;  // Typed into Win+R when no action agent answers",
+        "    bool        bat;        // command_P is a bat file, typed with its path",
+        "} action_t;",
+        "",
+    ]
+    for app in apps:
+        lines.append(f"static const char PROGMEM app_{app.ident.lower()}_name[] = {_c_string(app.name)};")
+    for action in actions:
+        lines.append(f"static const char PROGMEM action_{action.ident.lower()}[] = {_c_string(action.command)};")
+
+    lines += ["", "static const app_t PROGMEM apps[APP_COUNT] = {"]
+    width = max(len(app.ident) for app in apps) + len("[APP_]")
+    for app in apps:
+        fields = [
+            f"app_{app.ident.lower()}_name",
+            f"APP_LOGO({app.logo})" if app.logo else "NULL",
+            f"ACTION_{app.start.ident}" if app.start else "ACTION_NONE",
+            f"ACTION_{app.kill.ident}" if app.kill else "ACTION_NONE",
+        ]
+        lines.append(f"    {'[APP_' + app.ident + ']':<{width}} = {{{', '.join(fields)}}},")
+    lines += ["};", "", "static const action_t PROGMEM actions[ACTION_COUNT] = {"]
+    width = max(len(action.ident) for action in actions) + len("[ACTION_]")
+    for action in actions:
+        fields = f"action_{action.ident.lower()}, {'true' if action.bat else 'false'}"
+        lines.append(f"    {'[ACTION_' + action.ident + ']':<{width}} = {{{fields}}},")
+    lines.append("};")
+
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("config", nargs="?", default=os.path.join(HERE, "apps.txt"))
+    parser.add_argument("-o", "--output", default=os.path.join(HERE, "app_table.h"))
+    args = parser.parse_args()
+
+    try:
+        apps, actions = read_table(args.config)
+    except (OSError, ValueError) as e:
+        sys.exit(str(e))
+    if not any(app.wheel for app in apps):
+        sys.exit(f"{args.config}: no [wheel] apps")
+    write_header(args.output, apps, actions, os.path.basename(args.config))
+    print(f"{args.output}: {len(apps)} apps, {sum(app.wheel for app in apps)} on the wheel, "
+          f"{len(actions)} actions")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""
+Audio session index for volume_balance.py
+
+SessionIndex keeps the running audio sessions keyed by normalized process
+name ("Discord.exe" -> "discord"), so finding the Discord and game sessions
+is a dictionary lookup instead of one GetAllSessions() enumeration per
+entry of games.txt. It is refreshed on a background thread: one enumeration
+per refresh, and only sessions that appeared since the last one are matched
+against the game list. When the backend can report new sessions, a refresh
+runs as soon as one is created; the periodic refresh then only has to catch
+sessions that expired.
+
+The audio API sits behind a small backend interface (sessions(),
+subscribe()): PycawBackend for Windows, FakeSessionBackend for running and
+benchmarking the index anywhere.
+"""
+
+import threading
+
+from game_matcher import DISCORD
+
+REFRESH_INTERVAL = 5.0  # Seconds between refreshes (catches expired sessions)
+
+
+def normalize(process_name):
+    """Lowercase process name without .exe"""
+    name = process_name.lower()
+    return name[:-4] if name.endswith(".exe") else name
+
+
+class PycawBackend:
+    """Windows audio sessions through pycaw"""
+
+    def __init__(self):
+        self.com_threads = threading.local()
+
+    def _com_init(self):
+        # The index refreshes from its own thread, which needs COM too
+        if getattr(self.com_threads, "ready", False):
+            return
+        if threading.current_thread() is not threading.main_thread():
+            import comtypes
+            comtypes.CoInitializeEx(comtypes.COINIT_MULTITHREADED)
+            self.com_threads.ready = True
+
+    def sessions(self):
+        """(key, process name, session) for every session owned by a process"""
+        from pycaw.pycaw import AudioUtilities
+        self._com_init()
+        for session in AudioUtilities.GetAllSessions():
+            try:
+                process = session.Process
+                if not process:
+                    continue  # System sounds
+                name = process.name()
+                yield (session.ProcessId, name), name, session
+            except Exception:
+                continue  # Process exited while enumerating
+
+    def subscribe(self, on_created):
+        """Call on_created() whenever a session is created; False if unsupported"""
+        try:
+            from comtypes import CLSCTX_ALL
+            from pycaw.callbacks import AudioSessionNotification
+            from pycaw.pycaw import AudioUtilities, IAudioSessionManager2
+        except ImportError:
+            return False
+
+        class Created(AudioSessionNotification):
+            def on_session_created(self, new_session):
+                on_created()
+
+        try:
+            device = AudioUtilities.GetSpeakers()
+            manager = device.Activate(IAudioSessionManager2._iid_, CLSCTX_ALL, None)
+            manager = manager.QueryInterface(IAudioSessionManager2)
+            self.callback = Created()  # Keep the COM object alive
+            manager.RegisterSessionNotification(self.callback)
+            manager.GetSessionEnumerator()  # Notifications start after the first enumeration
+            self.manager = manager
+        except Exception:
+            return False
+        return True
+
+
+class FakeSession:
+    def __init__(self, pid, name):
+        self.pid = pid
+        self.name = name
+
+
+class FakeSessionBackend:
+    """In-memory sessions, with the enumeration cost counted
+
+    enumerations counts sessions() calls and name_lookups the process names
+    read, the two per-session COM/psutil costs of the real backend.
+    """
+
+    def __init__(self, names=()):
+        self.live = {}
+        self.next_pid = 1000
+        self.on_created = None
+        self.enumerations = 0
+        self.name_lookups = 0
+        for name in names:
+            self.add(name)
+
+    def add(self, name):
+        session = FakeSession(self.next_pid, name)
+        self.live[session.pid] = session
+        self.next_pid += 1
+        if self.on_created:
+            self.on_created()
+        return session
+
+    def remove(self, session):
+        self.live.pop(session.pid, None)
+
+    def sessions(self):
+        self.enumerations += 1
+        for session in list(self.live.values()):
+            self.name_lookups += 1
+            yield (session.pid, session.name), session.name, session
+
+    def subscribe(self, on_created):
+        self.on_created = on_created
+        return True
+
+
+class SessionIndex:
+    """Running audio sessions by normalized process name
+
+    Args:
+        backend: PycawBackend or another object with sessions()/subscribe()
+        games: game_matcher.GameLibrary (reloaded when games.txt changes)
+            or a fixed GameMatcher
+    """
+
+    def __init__(self, backend, games):
+        self.backend = backend
+        self.games = games
+        self.matcher = games.current()
+        self.lock = threading.Lock()
+        self.known = {}          # key -> (name, session)
+        self.by_name = {}        # normalized name -> {key: session}
+        self.discord_key = None
+        self.game_key = None
+        self.game_rank = None    # (priority, fragment) of the game session
+        self.refreshes = 0
+        self.wake = threading.Event()
+        self.stopping = threading.Event()
+        self.notified = False
+
+    def start(self, interval=REFRESH_INTERVAL):
+        """Build the index now, then keep it fresh on a background thread"""
+        self.refresh()
+        self.notified = self.backend.subscribe(self.wake.set)
+        threading.Thread(target=self._run, args=(interval,), name="audio-sessions", daemon=True).start()
+        return self
+
+    def stop(self):
+        self.stopping.set()
+        self.wake.set()
+
+    def _run(self, interval):
+        while not self.stopping.is_set():
+            self.wake.wait(interval)
+            self.wake.clear()
+            if not self.stopping.is_set():
+                try:
+                    self.refresh()
+                except Exception as e:
+                    print(f"\nAudio session refresh failed: {e}")
+
+    def refresh(self):
+        """Apply created and expired sessions from one enumeration"""
+        current = {key: (normalize(name), session) for key, name, session in self.backend.sessions()}
+        matcher = self.games.current()
+        with self.lock:
+            self.refreshes += 1
+            for key in [k for k in self.known if k not in current]:
+                self._remove(key)
+            for key, (name, session) in current.items():
+                if key not in self.known:
+                    self._add(key, name, session)
+            if matcher is not self.matcher:
+                # games.txt changed: rank every running session again
+                self.matcher = matcher
+                self._pick_game()
+
+    def _add(self, key, name, session):
+        self.known[key] = (name, session)
+        self.by_name.setdefault(name, {})[key] = session
+        if self.discord_key is None and DISCORD in name:
+            self.discord_key = key
+        rank = self.matcher.match(name)
+        if rank is not None and (self.game_rank is None or rank < self.game_rank):
+            self.game_key, self.game_rank = key, rank
+
+    def _remove(self, key):
+        name, _ = self.known.pop(key)
+        sessions = self.by_name[name]
+        del sessions[key]
+        if not sessions:
+            del self.by_name[name]
+        if key == self.discord_key:
+            self.discord_key = next((k for k, (n, _) in self.known.items() if DISCORD in n), None)
+        if key == self.game_key:
+            self._pick_game()
+
+    def _pick_game(self):
+        self.game_key = self.game_rank = None
+        found = self.matcher.best(self.by_name)
+        if found:
+            name, priority, fragment = found
+            self.game_key, self.game_rank = next(iter(self.by_name[name])), (priority, fragment)
+
+    def _session(self, key):
+        return self.known[key][1] if key is not None else None
+
+    def discord(self):
+        """Discord's session, or None"""
+        with self.lock:
+            return self._session(self.discord_key)
+
+    def game(self):
+        """Session of the running game listed first in games.txt, or None"""
+        with self.lock:
+            return self._session(self.game_key)
+
+    def find(self, name):
+        """Any session whose process is called name (with or without .exe)"""
+        with self.lock:
+            sessions = self.by_name.get(normalize(name))
+            return next(iter(sessions.values())) if sessions else None
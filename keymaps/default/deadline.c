@@ -0,0 +1,55 @@
+#include "deadline.h"
+
+#define DEADLINE_BIT(id) ((uint16_t)1 << (id))
+
+_Static_assert(DEADLINE_COUNT <= 16, "armed holds one bit per slot");
+
+static deadline_fn_t handlers[DEADLINE_COUNT];
+static uint32_t      due[DEADLINE_COUNT];
+static uint16_t      armed;     // DEADLINE_BIT of the armed slots
+static uint32_t      next_due;  // Earliest due[] when armed is set; may be early after a cancel
+
+// Signed, so deadlines compare right across the 32-bit timer wrap
+static bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+void deadline_set(deadline_id_t id, uint32_t delay_ms, deadline_fn_t fn) {
+    uint32_t at = timer_read32() + delay_ms;
+    if (!armed || before(at, next_due)) {
+        next_due = at;
+    }
+    due[id]      = at;
+    handlers[id] = fn;
+    armed |= DEADLINE_BIT(id);
+}
+
+void deadline_cancel(deadline_id_t id) {
+    armed &= ~DEADLINE_BIT(id);  // next_due is left as is: a wake-up with nothing due just finds the next one
+}
+
+bool deadline_armed(deadline_id_t id) {
+    return armed & DEADLINE_BIT(id);
+}
+
+void deadline_task(void) {
+    uint32_t now = timer_read32();
+    if (!armed || before(now, next_due)) {
+        return;
+    }
+
+    for (uint8_t id = 0; id < DEADLINE_COUNT; id++) {
+        if ((armed & DEADLINE_BIT(id)) && !before(now, due[id])) {
+            armed &= ~DEADLINE_BIT(id);  // Cleared first, the callback may arm it again
+            handlers[id](id);
+        }
+    }
+
+    bool found = false;
+    for (uint8_t id = 0; id < DEADLINE_COUNT; id++) {
+        if ((armed & DEADLINE_BIT(id)) && (!found || before(due[id], next_due))) {
+            next_due = due[id];
+            found    = true;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "quantum.h"
+
+// One-shot timeouts of the keymap, all behind a single deadline.
+//
+// Each timed behavior owns a slot in deadline_id_t and arms it with the
+// callback to run once its delay has passed; arming a slot again moves its
+// deadline, and a callback may re-arm its own slot. deadline_task() must be
+// called from matrix_scan_user(): while nothing is due it is one compare
+// against the earliest deadline, and only when that passes does it look at
+// the slots. Callbacks run from the scan loop, never from an interrupt.
+//
+// Adding a timed behavior is one line in deadline_id_t.
+
+// In the order due callbacks are run
+typedef enum {
+    DEADLINE_POWER = 0,        // Shutdown/hibernate/restart confirmation ran out
+    DEADLINE_APP_COMMIT,       // App wheel left alone long enough to act on
+    DEADLINE_MONITOR_STARTUP,  // Next dot of the monitoring startup screen
+    DEADLINE_ACTION,           // action_agent.py did not start a host action
+    DEADLINE_TOAST,            // Front toast shown for its duration
+    DEADLINE_BATCH_VOLUME,     // Encoder batch windows, by opcode from HID_OP_VOLUME
+    DEADLINE_BATCH_DISCORD,
+    DEADLINE_BATCH_LIFX,
+    DEADLINE_RELIABLE,         // Next button report resend
+    DEADLINE_COUNT
+} deadline_id_t;
+
+typedef void (*deadline_fn_t)(deadline_id_t id);
+
+// Run fn delay_ms from now, replacing what the slot was armed with
+void deadline_set(deadline_id_t id, uint32_t delay_ms, deadline_fn_t fn);
+
+void deadline_cancel(deadline_id_t id);
+bool deadline_armed(deadline_id_t id);
+
+void deadline_task(void);
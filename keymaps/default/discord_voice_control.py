@@ -15,26 +15,32 @@ Setup:
 4. Create discord_config.txt with:
    BOT_TOKEN=your_bot_token_here
    GUILD_ID=your_server_id_here
+
+supervisor.py runs serve() on a thread of its own instead of main().
 """
 
 import discord
 from discord.ext import commands
 import asyncio
-import hid
 import os
 import sys
 
-# QMK HID RAW settings
-VID = 0x6E61  # OffReno keyboard vendor ID
-PID = 0x6064  # OffReno keyboard product ID
+from hid_client import HidClient
+from hid_protocol import (HID_OP_DISCORD, HID_OP_VERSION, HID_CMD_BUTTON, ReportAcker, discord_user_report,
+                          discord_muted_report, check_version, encoder_steps)
+from display_channel import DisplayChannel
+from voice_roster import VoiceRoster
+from trace_log import now_us, open_trace
 
 # Discord bot settings
 CONFIG_FILE = os.path.join(os.path.dirname(__file__), "discord_config.txt")
+STOP_POLL = 0.25  # Seconds between checks whether serve() should stop
 
 # Global state
-current_user_index = 0
-voice_users = []
-selected_user = None
+roster = VoiceRoster()
+keyboard = None
+display = None      # DisplayChannel to the OLED while the keyboard is connected
+shown_view = None   # (index, total, name) last posted to the OLED
 bot = None
 target_guild = None
 
@@ -61,89 +67,35 @@ def load_config():
 
     return config['BOT_TOKEN'], int(config['GUILD_ID'])
 
-def find_keyboard():
-    """Find the OffReno keyboard RAW HID interface"""
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            # QMK RAW HID uses usage_page 0xFF60 and usage 0x61
-            if device.get('usage_page') == 0xFF60 and device.get('usage') == 0x61:
-                print(f"Found RAW HID interface: {device.get('interface_number', 'N/A')}")
-                return device['path']
-
-    # Fallback
-    print("RAW HID interface not found by usage page, trying fallback...")
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            print(f"Using interface: {device.get('interface_number', 'N/A')}")
-            return device['path']
-
-    return None
-
-def get_voice_users(guild):
-    """Get list of users in voice channels"""
-    users = []
+def load_roster(guild):
+    """Build the roster from the voice channels, once at startup"""
+    roster.load(guild)
     print(f"\nScanning voice channels in {guild.name}...")
     print(f"Total voice channels: {len(guild.voice_channels)}")
-    for channel in guild.voice_channels:
-        print(f"  Channel: {channel.name} - Members: {len(channel.members)}")
-        for member in channel.members:
-            print(f"    - {member.display_name} (bot={member.bot})")
-            if not member.bot:  # Skip bots
-                users.append({
-                    'name': member.display_name,
-                    'member': member,
-                    'channel': channel.name
-                })
-    print(f"Found {len(users)} non-bot users in voice")
-    return users
-
-def send_user_to_oled(keyboard, username, index, total):
-    """Send username to keyboard for OLED display"""
-    # Protocol: 0xF2 = Discord command, 0x01 = Update display
-    # Format: [report_id, 0xF2, 0x01, index, total, username_bytes...]
-    data = [0] * 33  # 33 bytes: 1 for report ID + 32 for data
-    data[0] = 0x00  # Report ID (required for HID)
-    data[1] = 0xF2  # Discord command identifier
-    data[2] = 0x01  # Update display command
-    data[3] = index  # Current user index
-    data[4] = total  # Total users
-
-    # Encode username (max 27 bytes to fit in remaining space)
-    username_bytes = username[:27].encode('utf-8')
-    for i, byte in enumerate(username_bytes):
-        data[5 + i] = byte
-
-    keyboard.write(bytes(data))
-    print(f"Sent to OLED: [{index+1}/{total}] {username}")
-
-async def update_voice_users():
-    """Update the list of users in voice channels"""
-    global voice_users, current_user_index, selected_user
-
-    if not target_guild:
-        return
+    print(f"Found {len(roster)} non-bot users in voice")
+    print_roster()
 
-    new_users = get_voice_users(target_guild)
+def print_roster():
+    selected = roster.selected()
+    for member, channel in roster.users():
+        marker = ">" if member is selected else " "
+        print(f"  {marker} {member.display_name} in {channel}")
 
-    # Check if user list changed
-    if len(new_users) != len(voice_users) or \
-       any(u1['name'] != u2['name'] for u1, u2 in zip(new_users, voice_users)):
-        voice_users = new_users
+def show_selection():
+    """Post the selected user to the OLED if what it shows has changed
 
-        # Reset index if out of bounds
-        if current_user_index >= len(voice_users):
-            current_user_index = 0
+    Posts replace each other until the display channel's next frame, so a
+    fast scroll shows where it stops without a write per user passed.
+    """
+    global shown_view
 
-        # Update selected user
-        if voice_users:
-            selected_user = voice_users[current_user_index]
-            print(f"\nVoice users updated: {len(voice_users)} users")
-            for i, user in enumerate(voice_users):
-                marker = ">" if i == current_user_index else " "
-                print(f"  {marker} {user['name']} in {user['channel']}")
-        else:
-            selected_user = None
-            print("\nNo users in voice channels")
+    view = roster.view()
+    if display is None or view == shown_view:
+        return
+    index, total, name = view
+    display.post(discord_user_report(index, total, name))
+    shown_view = view
+    print(f"OLED: [{index+1}/{total}] {name}" if total else "OLED: no users")
 
 class DiscordVoiceBot(commands.Bot):
     def __init__(self):
@@ -171,65 +123,69 @@ class DiscordVoiceBot(commands.Bot):
         # Wait a moment for voice states to populate
         await asyncio.sleep(2)
 
-        # Initial user list update
-        await update_voice_users()
+        # Initial user list, kept up to date from voice state updates
+        load_roster(target_guild)
 
         # Start HID listener
         self.loop.create_task(hid_listener())
 
     async def on_voice_state_update(self, member, before, after):
-        """Called when someone joins/leaves/moves voice channels"""
-        await update_voice_users()
+        """Called when someone joins/leaves/moves voice channels or (un)mutes"""
+        if not target_guild or member.guild.id != target_guild.id:
+            return
+        if roster.apply(member, before, after):
+            show_selection()
 
 async def hid_listener():
     """Listen for HID commands from keyboard"""
-    global current_user_index, selected_user, voice_users
-
-    keyboard_path = find_keyboard()
-    if not keyboard_path:
-        print("ERROR: Could not find OffReno keyboard!")
-        return
+    global keyboard, display, shown_view
 
     try:
-        keyboard = hid.device()
-        keyboard.open_path(keyboard_path)
-        print("Connected to OffReno keyboard\n")
+        keyboard = HidClient([HID_OP_DISCORD])
+        print("Connected to HID broker\n")
+        trace = open_trace("discord")
+        check_version(keyboard, trace=trace, opcode=HID_OP_DISCORD)
+        acker = ReportAcker(keyboard, HID_OP_DISCORD).hello()
     except Exception as e:
-        print(f"ERROR: Could not open keyboard: {e}")
+        print(f"ERROR: Could not connect to HID broker: {e}")
         return
 
     print("Listening for encoder commands...\n")
 
     # Send initial state
-    if voice_users:
-        send_user_to_oled(keyboard, voice_users[current_user_index]['name'],
-                         current_user_index, len(voice_users))
+    display = DisplayChannel(keyboard).start()
+    shown_view = None
+    show_selection()
 
+    try:
+        await listen(trace, acker)
+    finally:
+        trace.close()
+        display.close()
+        display = None
+        keyboard.close()
+        keyboard = None
+
+async def listen(trace, acker):
+    """Handle encoder 2 reports until the broker connection is lost"""
     while True:
         try:
-            # Read HID data with timeout
-            data = keyboard.read(33, timeout_ms=100)
+            # Wait for the next report without blocking the bot
+            data = await keyboard.read_async(33)
 
-            if data and len(data) > 0 and data[0] == 0xF2:  # Discord command
+            if data and len(data) > 0 and data[0] == HID_OP_DISCORD and acker.accept(data):  # Discord command, not a resent copy
+                received, dispatched = keyboard.received_us, now_us()
                 command = data[1]
+                # One user per detent, however fast the encoder is turned
+                steps = encoder_steps(data, accelerate=False)
+
+                if steps:  # CW rotation - next user, CCW - previous user
+                    roster.step(steps)
+                    show_selection()
 
-                if command == 0x01:  # CW rotation - next user
-                    if voice_users:
-                        current_user_index = (current_user_index + 1) % len(voice_users)
-                        selected_user = voice_users[current_user_index]
-                        send_user_to_oled(keyboard, selected_user['name'],
-                                        current_user_index, len(voice_users))
-
-                elif command == 0x02:  # CCW rotation - previous user
-                    if voice_users:
-                        current_user_index = (current_user_index - 1) % len(voice_users)
-                        selected_user = voice_users[current_user_index]
-                        send_user_to_oled(keyboard, selected_user['name'],
-                                        current_user_index, len(voice_users))
-
-                elif command == 0x03:  # Button press - mute/unmute
-                    if selected_user:
-                        member = selected_user['member']
+                elif command == HID_CMD_BUTTON:  # Button press - mute/unmute
+                    member = roster.selected()
+                    if member:
                         try:
                             # Toggle mute
                             new_mute_state = not member.voice.mute
@@ -238,40 +194,55 @@ async def hid_listener():
                             print(f"{action}: {member.display_name}")
 
                             # Send mute status back to keyboard
-                            data_response = [0] * 33  # 33 bytes: 1 for report ID + 32 for data
-                            data_response[0] = 0x00  # Report ID (required for HID)
-                            data_response[1] = 0xF2  # Discord command identifier
-                            data_response[2] = 0x04  # Mute status update
-                            data_response[3] = 1 if new_mute_state else 0  # 1 = muted, 0 = unmuted
-                            keyboard.write(bytes(data_response))
+                            display.post(discord_muted_report(new_mute_state))
                         except discord.Forbidden:
                             print(f"ERROR: No permission to mute {member.display_name}")
                         except Exception as e:
                             print(f"ERROR muting user: {e}")
 
-            await asyncio.sleep(0.01)  # Small delay to prevent CPU spinning
+                trace.event(data, received, dispatched, steps=steps)
 
+            elif data and data[0] == HID_OP_VERSION:  # Keyboard (re)connected, its OLED may be blank
+                display.reset()
+
+        except ConnectionError:
+            print("HID broker connection lost")
+            break
         except Exception as e:
             print(f"Error in HID listener: {e}")
             await asyncio.sleep(1)
 
-    keyboard.close()
-
-async def main():
+async def run_bot(stop=None):
+    """Run the bot until it closes, or until stop (a threading.Event) is set"""
     global bot, GUILD_ID
 
-    print("Discord Voice Control starting...")
     print("Loading configuration...")
-
     BOT_TOKEN, GUILD_ID = load_config()
 
     bot = DiscordVoiceBot()
+    session = asyncio.ensure_future(bot.start(BOT_TOKEN))
+    try:
+        while not session.done() and not (stop and stop.is_set()):
+            await asyncio.wait({session}, timeout=STOP_POLL)
+    finally:
+        await bot.close()
+    if session.done():
+        session.result()  # Raise what ended the bot
 
+def serve(stop):
+    """Run the bot on this thread until stop (a threading.Event) is set
+
+    Returns early if the bot closes (wrong guild, lost gateway); raises
+    what stopped it, or SystemExit for a missing or broken config file.
+    """
+    asyncio.run(run_bot(stop))
+
+async def main():
+    print("Discord Voice Control starting...")
     try:
-        await bot.start(BOT_TOKEN)
+        await run_bot()
     except KeyboardInterrupt:
         print("\n\nStopping Discord Voice Control...")
-        await bot.close()
 
 if __name__ == "__main__":
     try:
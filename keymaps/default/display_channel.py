@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Coalesced, rate-limited OLED updates for the TIDBIT host scripts
+
+DisplayChannel sits between a script and its HidClient for the reports that
+change what the OLED shows (DISPLAY_SLOTS in hid_protocol.py). Each display
+slot holds at most one pending report: posting a newer one replaces it
+(last value wins), and posting what the slot already shows is dropped. A
+sender thread writes pending reports at no more than max_fps frames per
+second, so a fast scroll through the Discord roster or a burst of roster
+changes costs a few writes instead of one per event, while a lone update
+after a quiet spell still goes out at once.
+
+Every frame is stamped with its slot's next sequence number, and the
+keyboard drops frames older than the last one it applied to that slot.
+When the keyboard answers a version query it may have come up blank (a
+replug or a reset, the broker asks as it connects), so the script calls
+reset() and the last frame of every slot goes out again.
+
+    display = DisplayChannel(keyboard).start()   # after check_version()
+    display.post(discord_user_report(index, total, name))
+    display.reset()                               # on a HID_OP_VERSION reply
+    display.close()                               # writes what is pending
+"""
+
+import threading
+import time
+
+from hid_protocol import HID_SLOT_COUNT, display_slot, with_display_seq
+
+MAX_FPS = 20  # Frames per second across all slots of one script
+
+
+class DisplayChannel:
+    """Last-value-wins display slots written at a capped frame rate
+
+    Args:
+        keyboard: HidClient (anything with write())
+        max_fps: frame rate cap, 0 for none
+        clock: time source, time.monotonic by default
+    """
+
+    def __init__(self, keyboard, max_fps=MAX_FPS, clock=time.monotonic):
+        self.keyboard = keyboard
+        self.interval = 1.0 / max_fps if max_fps else 0.0
+        self.clock = clock
+        self.cond = threading.Condition()
+        self.pending = {}        # slot -> report, in posting order
+        self.shown = {}          # slot -> last report written (unstamped)
+        self.seq = [0] * HID_SLOT_COUNT
+        self.next_frame = 0.0
+        self.closing = False
+        self.thread = None
+        self.posted = self.written = self.superseded = self.unchanged = 0
+
+    def start(self):
+        self.thread = threading.Thread(target=self._run, name="display-channel", daemon=True)
+        self.thread.start()
+        return self
+
+    def post(self, report):
+        """Queue a display report, replacing any pending one for its slot"""
+        slot = display_slot(report)
+        if slot is None:
+            raise ValueError(f"not a display report: {report[1]:02X} {report[2]:02X}")
+        report = bytes(report)
+        with self.cond:
+            self.posted += 1
+            if self.pending.pop(slot, None) is not None:
+                self.superseded += 1
+            if report == self.shown.get(slot):
+                self.unchanged += 1
+                return
+            self.pending[slot] = report
+            self.cond.notify()
+
+    def reset(self):
+        """Forget what the keyboard shows and write each slot's last frame again
+
+        A report posted before the frame goes out replaces it, and one equal
+        to it is no longer dropped as unchanged.
+        """
+        with self.cond:
+            for slot, report in self.shown.items():
+                self.pending.setdefault(slot, report)
+            self.shown.clear()
+            if self.pending:
+                self.cond.notify()
+
+    def pump(self, now=None):
+        """Write the oldest pending frame if the frame rate allows
+
+        Returns the seconds to wait before the next frame can be written,
+        or None when nothing is pending. The sender thread calls this; a
+        simulation can call it with its own clock instead of start().
+        """
+        now = self.clock() if now is None else now
+        with self.cond:
+            if not self.pending:
+                return None
+            if now < self.next_frame:
+                return self.next_frame - now
+            frame = self._take()
+            self.next_frame = now + self.interval
+            wait = self.interval if self.pending else None
+        self.keyboard.write(frame)
+        return wait
+
+    def _take(self):
+        slot = next(iter(self.pending))
+        report = self.pending.pop(slot)
+        self.shown[slot] = report
+        self.seq[slot] = self.seq[slot] % 255 + 1  # 1-255, 0 means unsequenced
+        self.written += 1
+        return with_display_seq(report, self.seq[slot])
+
+    def _run(self):
+        while True:
+            with self.cond:
+                while not self.pending and not self.closing:
+                    self.cond.wait()
+                if self.closing:
+                    return
+            try:
+                wait = self.pump()
+            except OSError:
+                return  # Broker gone; the script notices on its next read
+            if wait:
+                with self.cond:
+                    if not self.closing:
+                        self.cond.wait(wait)
+
+    def close(self):
+        """Stop the sender and write whatever is still pending"""
+        with self.cond:
+            self.closing = True
+            self.cond.notify()
+        if self.thread:
+            self.thread.join()
+        with self.cond:
+            frames = [self._take() for _ in range(len(self.pending))]
+        try:
+            for frame in frames:
+                self.keyboard.write(frame)
+        except OSError:
+            pass
+
+    def stats(self):
+        """Counters: reports posted, frames written, superseded and unchanged reports dropped"""
+        with self.cond:
+            return {'posted': self.posted, 'written': self.written,
+                    'superseded': self.superseded, 'unchanged': self.unchanged}
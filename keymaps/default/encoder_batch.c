@@ -0,0 +1,115 @@
+#include "encoder_batch.h"
+#include "raw_hid.h"
+#include "reliable.h"
+#include "deadline.h"
+
+#define BATCH_CHANNELS (HID_OP_LIFX - HID_OP_VOLUME + 1)
+
+_Static_assert(DEADLINE_BATCH_LIFX - DEADLINE_BATCH_VOLUME + 1 == BATCH_CHANNELS, "a batch window deadline per channel");
+
+typedef struct {
+    int8_t   steps;    // Net detents not reported yet
+    uint8_t  detents;  // Detents in either direction since the last report
+    bool     open;     // A report went out less than a window ago
+    uint32_t first_at; // First of the detents not reported yet
+} batch_t;
+
+static batch_t  batches[BATCH_CHANNELS];
+static uint16_t trace_seq;  // Last HID_TRACE_SEQ sent
+
+static batch_t *batch_for(uint8_t opcode) {
+    if (opcode < HID_OP_VOLUME || opcode > HID_OP_LIFX) {
+        return NULL;
+    }
+    return &batches[opcode - HID_OP_VOLUME];
+}
+
+static void put_u32(uint8_t *data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+}
+
+// Trace stamp for the host, see HID_TRACE_*
+static void stamp(uint8_t *data, uint32_t event_at) {
+    if (++trace_seq == 0) {
+        trace_seq = 1;  // 0 is "unstamped"
+    }
+    data[HID_TRACE_SEQ]     = trace_seq >> 8;
+    data[HID_TRACE_SEQ + 1] = trace_seq;
+    put_u32(&data[HID_TRACE_EVENT], event_at);
+    put_u32(&data[HID_TRACE_SENT], timer_read32());
+}
+
+static void window_closed(deadline_id_t id);
+
+static void send_delta(uint8_t opcode, batch_t *batch) {
+    uint8_t data[HID_REPORT_SIZE] = {0};
+    data[0]                  = opcode;
+    data[1]                  = HID_CMD_DELTA;
+    data[HID_DELTA_STEPS]    = (uint8_t)batch->steps;
+    data[HID_DELTA_VELOCITY] = batch->detents >= 4 ? HID_VELOCITY_FAST
+                             : batch->detents >= 2 ? HID_VELOCITY_MEDIUM
+                                                   : HID_VELOCITY_SLOW;
+    stamp(data, batch->first_at);
+    raw_hid_send(data, sizeof(data));
+
+    batch->steps   = 0;
+    batch->detents = 0;
+    batch->open    = true;
+    deadline_set(DEADLINE_BATCH_VOLUME + (opcode - HID_OP_VOLUME), ENCODER_BATCH_WINDOW_MS, window_closed);
+}
+
+static void window_closed(deadline_id_t id) {
+    uint8_t  channel = id - DEADLINE_BATCH_VOLUME;
+    batch_t *batch   = &batches[channel];
+    if (batch->steps) {
+        send_delta(HID_OP_VOLUME + channel, batch);
+    } else {
+        // Quiet window (or a turn that cancelled out): report the next detent at once
+        batch->open    = false;
+        batch->detents = 0;
+    }
+}
+
+void encoder_batch_add(uint8_t opcode, bool clockwise) {
+    batch_t *batch = batch_for(opcode);
+    if (!batch) {
+        return;
+    }
+    if (batch->steps == 0) {
+        batch->first_at = timer_read32();  // Nothing pending from earlier detents
+    }
+    if (clockwise && batch->steps < INT8_MAX) {
+        batch->steps++;
+    } else if (!clockwise && batch->steps > -INT8_MAX) {
+        batch->steps--;
+    }
+    if (batch->detents < UINT8_MAX) {
+        batch->detents++;
+    }
+    if (!batch->open) {
+        send_delta(opcode, batch);
+    }
+}
+
+void encoder_batch_flush(uint8_t opcode) {
+    batch_t *batch = batch_for(opcode);
+    if (batch && batch->steps) {
+        send_delta(opcode, batch);
+    }
+}
+
+void encoder_batch_button(uint8_t opcode) {
+    if (!batch_for(opcode)) {
+        return;
+    }
+    encoder_batch_flush(opcode);
+
+    uint8_t data[HID_REPORT_SIZE] = {0};
+    data[0] = opcode;
+    data[1] = HID_CMD_BUTTON;
+    stamp(data, timer_read32());
+    reliable_send(data);  // A lost press would leave a toggle out of step
+}
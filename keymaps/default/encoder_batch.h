@@ -0,0 +1,28 @@
+#pragma once
+
+#include "quantum.h"
+#include "hid_protocol.h"
+
+// Coalesces the detents of the host-controlled encoders into HID_CMD_DELTA
+// reports, one per opcode per ENCODER_BATCH_WINDOW_MS at most.
+//
+// A detent after a quiet window is reported at once; detents arriving
+// within the window after a report are summed and sent as one net delta
+// when it closes, with a velocity class taken from how many there were.
+// The windows are DEADLINE_BATCH_* in deadline.h.
+//
+// Every report carries a HID_TRACE_* stamp: a sequence number, the time of
+// the first detent it sums (or of the button press) and the time it went out.
+
+#define ENCODER_BATCH_WINDOW_MS 50
+
+// Channels are the contiguous opcodes HID_OP_VOLUME..HID_OP_LIFX
+void encoder_batch_add(uint8_t opcode, bool clockwise);
+
+// Send any pending delta for the opcode now, so a button command that
+// follows is seen after the turn that preceded it
+void encoder_batch_flush(uint8_t opcode);
+
+// Flush the opcode's pending delta, then send its HID_CMD_BUTTON through
+// reliable.h; deltas are sent once
+void encoder_batch_button(uint8_t opcode);
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Fake TIDBIT raw HID endpoint for running the host scripts without hardware
+
+fake_pair() returns a FakeHidDevice, which behaves like an opened
+hid.device, and the FakeKeyboard on the other end of a socketpair, which
+plays the firmware: send() injects a 32-byte report as if raw_hid_send()
+had been called, and written reports can be received or answered by a
+responder callback.
+
+The fake keeps a clock of its own like timer_read32(), started
+BOOT_UPTIME_MS before this module was imported, and stamps the encoder
+reports of send_encoder() with HID_TRACE_* like the firmware.
+"""
+
+import socket
+import threading
+import time
+
+from hid_protocol import (HID_REPORT_SIZE, REPORT_LENGTH, HID_OP_BASE, HID_OP_VERSION,
+                          HID_VERSION_PROTOCOL, HID_VERSION_OP_BASE, HID_VERSION_OP_COUNT,
+                          HID_VERSION_UPTIME, HID_TRACE_SEQ, HID_TRACE_EVENT, HID_TRACE_SENT)
+
+BOOT_UPTIME_MS = 123456  # The keyboard's clock is not the host's
+_boot = time.monotonic() - BOOT_UPTIME_MS / 1000
+
+
+def uptime_ms():
+    """The fake keyboard's timer_read32()"""
+    return int((time.monotonic() - _boot) * 1000) & 0xFFFFFFFF
+
+
+def _recv_exact(sock, size, timeout):
+    """Read exactly size bytes; None on timeout, b'' once the peer is closed"""
+    sock.settimeout(timeout)
+    try:
+        data = sock.recv(size)
+    except socket.timeout:
+        return None
+    except OSError:
+        return b''
+    # A report is never split for long, wait for the rest of it
+    sock.settimeout(None)
+    while data and len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            return b''
+        data += chunk
+    return data
+
+
+class FakeHidDevice:
+    """Host end: the read()/write()/close() calls of hid.device"""
+
+    def __init__(self, sock):
+        self.sock = sock
+
+    def read(self, max_length, timeout_ms=0):
+        data = _recv_exact(self.sock, HID_REPORT_SIZE, timeout_ms / 1000 if timeout_ms else None)
+        if data is None:
+            return []
+        if not data:
+            raise OSError("fake keyboard unplugged")
+        return list(data[:max_length])
+
+    def write(self, data):
+        if len(data) != REPORT_LENGTH:
+            raise ValueError(f"report must be {REPORT_LENGTH} bytes, got {len(data)}")
+        self.sock.sendall(bytes(data))
+        return len(data)
+
+    def close(self):
+        self.sock.close()
+
+
+class FakeKeyboard:
+    """Firmware end: inject reports, collect what the host wrote
+
+    Args:
+        sock: socket connected to the FakeHidDevice
+        responder: optional callable(packet) run for every report the host
+            writes (packet is the 32 bytes after the report ID). It may
+            return a 32-byte reply to send back. Without a responder,
+            written reports are collected for receive().
+    """
+
+    def __init__(self, sock, responder=None):
+        self.sock = sock
+        self.responder = responder
+        self.send_lock = threading.Lock()
+        self.trace_seq = 0
+        if responder:
+            threading.Thread(target=self._respond, name="fake-keyboard", daemon=True).start()
+
+    def send(self, packet):
+        """Send a report to the host, as raw_hid_send() would"""
+        packet = bytes(packet).ljust(HID_REPORT_SIZE, b'\0')[:HID_REPORT_SIZE]
+        with self.send_lock:
+            self.sock.sendall(packet)
+
+    def send_encoder(self, packet, event_ms=None):
+        """Send an encoder report stamped like encoder_batch.c; returns its sequence number
+
+        event_ms is the uptime_ms() of the detent or press, now by default.
+        """
+        data = bytearray(bytes(packet).ljust(HID_REPORT_SIZE, b'\0'))
+        with self.send_lock:
+            self.trace_seq = self.trace_seq % 0xFFFF + 1
+            seq = self.trace_seq
+        sent = uptime_ms()
+        data[HID_TRACE_SEQ:HID_TRACE_SEQ + 2] = seq.to_bytes(2, 'big')
+        data[HID_TRACE_EVENT:HID_TRACE_EVENT + 4] = (sent if event_ms is None else event_ms).to_bytes(4, 'big')
+        data[HID_TRACE_SENT:HID_TRACE_SENT + 4] = sent.to_bytes(4, 'big')
+        self.send(data)
+        return seq
+
+    def receive(self, timeout=1.0):
+        """Next report written by the host without its report ID, or None"""
+        data = _recv_exact(self.sock, REPORT_LENGTH, timeout)
+        return data[1:] if data else None
+
+    def _respond(self):
+        while True:
+            data = _recv_exact(self.sock, REPORT_LENGTH, None)
+            if not data:
+                return
+            reply = self.responder(data[1:])
+            if reply:
+                self.send(reply)
+
+    def close(self):
+        self.sock.close()
+
+
+def version_responder(version, op_count):
+    """Responder that answers HID_OP_VERSION queries like the firmware"""
+    def respond(packet):
+        if packet[0] == HID_OP_VERSION:
+            reply = bytearray(HID_REPORT_SIZE)
+            reply[0] = HID_OP_VERSION
+            reply[HID_VERSION_PROTOCOL] = version
+            reply[HID_VERSION_OP_BASE] = HID_OP_BASE
+            reply[HID_VERSION_OP_COUNT] = op_count
+            reply[HID_VERSION_UPTIME:HID_VERSION_UPTIME + 4] = uptime_ms().to_bytes(4, 'big')
+            return bytes(reply)
+        return None
+    return respond
+
+
+def fake_pair(responder=None):
+    """Return (FakeHidDevice, FakeKeyboard) connected to each other"""
+    host_sock, firmware_sock = socket.socketpair()
+    return FakeHidDevice(host_sock), FakeKeyboard(firmware_sock, responder)
@@ -0,0 +1,37 @@
+#include "fmt.h"
+
+char *fmt_uint(char *dst, uint16_t value, uint8_t width) {
+    char    digits[FMT_UINT_DIGITS];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    while (width > count) {
+        *dst++ = ' ';
+        width--;
+    }
+    while (count) {
+        *dst++ = digits[--count];
+    }
+    *dst = '\0';
+    return dst;
+}
+
+char *fmt_str(char *dst, const char *src, uint8_t max) {
+    while (max-- && *src) {
+        *dst++ = *src++;
+    }
+    *dst = '\0';
+    return dst;
+}
+
+char *fmt_P(char *dst, const char *src_P) {
+    char c;
+    while ((c = pgm_read_byte(src_P++))) {
+        *dst++ = c;
+    }
+    *dst = '\0';
+    return dst;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "quantum.h"
+
+// Fixed-width text for the OLED lines and toasts, in place of snprintf.
+//
+// Each function writes at dst, NUL-terminates, and returns the new end, so
+// the pieces of a line chain into one buffer:
+//
+//     char *p = fmt_P(buf, PSTR("CPU: "));
+//     p = fmt_uint(p, cpu, 3);
+//     fmt_P(p, PSTR("%"));
+//
+// Nothing checks the buffer size: callers size the widths and the max of
+// fmt_str() so a line fits in OLED_VIEW_COLS or TOAST_TEXT_SIZE - 1.
+// oled_view_line() pads lines to the full width itself.
+
+#define FMT_UINT_DIGITS 5  // Widest uint16_t
+
+// value in decimal, right-aligned with spaces to width (0: no padding)
+char *fmt_uint(char *dst, uint16_t value, uint8_t width);
+
+// At most max characters of a RAM string
+char *fmt_str(char *dst, const char *src, uint8_t max);
+
+// A PROGMEM string
+char *fmt_P(char *dst, const char *src_P);
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+games.txt matcher for volume_balance.py
+
+GameMatcher compiles the games.txt fragments into an Aho-Corasick automaton
+(a trie of the fragments with failure links), so a process name is scanned
+once, character by character, whatever the number of games. Each state
+knows the best (earliest in games.txt) fragment ending there, so the scan
+also yields the best-priority match directly. best() scans the names of all
+running processes in one pass.
+
+GameLibrary loads games.txt through a cache of the compiled automaton next
+to it (games.cache, in marshal format, about half the time of compiling a
+2,000-game list), and rebuilds both only when the file's mtime or size
+changes, so startup neither re-parses games.txt nor re-runs the steamapps
+scan.
+
+    python game_matcher.py [process names...]   # show the best match, rebuild the cache if stale
+"""
+
+import collections
+import marshal
+import os
+import sys
+
+GAMES_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "games.txt")
+CACHE_VERSION = 1
+CACHE_FORMAT = (CACHE_VERSION, sys.version_info[0], sys.version_info[1])  # marshal changes between Pythons
+DISCORD = "discord"   # Matched on its own, never the game
+SEPARATOR = "\0"      # Between names in best(); never part of a fragment
+
+
+def parse_games(path):
+    """Fragments of a games.txt file, lowercase, in file order"""
+    fragments = []
+    with open(path, 'r', encoding='utf-8') as f:
+        for line in f:
+            line = line.strip()
+            # Skip comments and empty lines
+            if line and not line.startswith('#'):
+                fragments.append(line.lower())
+    return fragments
+
+
+class GameMatcher:
+    """Best-priority games.txt fragment contained in a process name
+
+    Args:
+        fragments: lowercase fragments, earlier ones win
+    """
+
+    def __init__(self, fragments=()):
+        self.patterns = []
+        seen = set()
+        for fragment in fragments:
+            if fragment and fragment != DISCORD and SEPARATOR not in fragment and fragment not in seen:
+                seen.add(fragment)
+                self.patterns.append(fragment)
+        self._build()
+
+    def _build(self):
+        goto = [{}]      # state -> {char: state}
+        out = [None]     # state -> priority of the best fragment ending here
+        for priority, pattern in enumerate(self.patterns):
+            state = 0
+            for ch in pattern:
+                nxt = goto[state].get(ch)
+                if nxt is None:
+                    nxt = len(goto)
+                    goto[state][ch] = nxt
+                    goto.append({})
+                    out.append(None)
+                state = nxt
+            if out[state] is None:
+                out[state] = priority
+
+        # Breadth first, so a state's failure target is final before its children
+        fail = [0] * len(goto)
+        queue = collections.deque(goto[0].values())
+        while queue:
+            state = queue.popleft()
+            for ch, child in goto[state].items():
+                queue.append(child)
+                f = fail[state]
+                while f and ch not in goto[f]:
+                    f = fail[f]
+                target = goto[f].get(ch, 0)
+                fail[child] = target if target != child else 0
+                # Fragments ending at the failure target end here too
+                inherited = out[fail[child]]
+                if inherited is not None and (out[child] is None or inherited < out[child]):
+                    out[child] = inherited
+
+        self.goto, self.fail, self.out = goto, fail, out
+
+    def _scan(self, text):
+        """Yield (position, priority) wherever a better match ends"""
+        goto, fail, out = self.goto, self.fail, self.out
+        state = 0
+        for pos, ch in enumerate(text):
+            while state and ch not in goto[state]:
+                state = fail[state]
+            state = goto[state].get(ch, 0)
+            if out[state] is not None:
+                yield pos, out[state]
+
+    def match(self, name):
+        """(priority, fragment) of the best fragment in a normalized name, or None"""
+        if name.startswith(DISCORD):
+            return None
+        found = min((p for _, p in self._scan(name)), default=None)
+        return None if found is None else (found, self.patterns[found])
+
+    def best(self, names):
+        """(name, priority, fragment) of the best match among names, or None
+
+        All names are scanned in one pass over SEPARATOR-joined text.
+        """
+        names = [n for n in names if not n.startswith(DISCORD)]
+        if not names:
+            return None
+        ends = []
+        total = -1
+        for name in names:
+            total += len(name) + 1
+            ends.append(total)  # Position of the separator after each name
+        winner = None
+        index = 0
+        for pos, priority in self._scan(SEPARATOR.join(names)):
+            if winner is None or priority < winner[1]:
+                while ends[index] < pos:
+                    index += 1
+                winner = (index, priority)
+        if winner is None:
+            return None
+        return names[winner[0]], winner[1], self.patterns[winner[1]]
+
+    def current(self):
+        return self
+
+    def __len__(self):
+        return len(self.patterns)
+
+    # --- Disk cache ---
+
+    def to_dict(self):
+        return {'patterns': self.patterns, 'goto': self.goto, 'fail': self.fail, 'out': self.out}
+
+    @classmethod
+    def from_dict(cls, data):
+        matcher = cls.__new__(cls)
+        matcher.patterns = data['patterns']
+        matcher.goto = data['goto']
+        matcher.fail = data['fail']
+        matcher.out = data['out']
+        return matcher
+
+
+class GameLibrary:
+    """games.txt as a GameMatcher, rebuilt when the file changes
+
+    Args:
+        path: games.txt
+        cache_path: compiled automaton cache (default: games.cache next to path)
+    """
+
+    def __init__(self, path=GAMES_FILE, cache_path=None):
+        self.path = path
+        self.cache_path = cache_path or os.path.join(os.path.dirname(path), "games.cache")
+        self.source = None
+        self.matcher = GameMatcher()
+        self.from_cache = False
+
+    def _stamp(self):
+        try:
+            st = os.stat(self.path)
+        except OSError:
+            return None
+        return [st.st_mtime_ns, st.st_size]
+
+    def current(self):
+        """The matcher for games.txt as it is now; one stat() when unchanged"""
+        stamp = self._stamp()
+        if stamp != self.source:
+            self._load(stamp)
+        return self.matcher
+
+    def _load(self, stamp):
+        self.source = stamp
+        self.from_cache = False
+        if stamp is None:
+            self.matcher = GameMatcher()
+            return
+        try:
+            with open(self.cache_path, 'rb') as f:
+                cached = marshal.loads(f.read())
+            if cached['format'] == CACHE_FORMAT and cached['source'] == stamp:
+                self.matcher = GameMatcher.from_dict(cached['matcher'])
+                self.from_cache = True
+                return
+        except (OSError, EOFError, ValueError, TypeError, KeyError):
+            pass  # Missing, stale or damaged cache, rebuild it
+
+        try:
+            self.matcher = GameMatcher(parse_games(self.path))
+        except OSError as e:
+            print(f"Warning: Could not read games.txt: {e}")
+            self.matcher = GameMatcher()
+            return
+        try:
+            tmp = self.cache_path + ".tmp"
+            with open(tmp, 'wb') as f:
+                marshal.dump({'format': CACHE_FORMAT, 'source': stamp,
+                              'matcher': self.matcher.to_dict()}, f)
+            os.replace(tmp, self.cache_path)
+        except OSError:
+            pass  # Read-only folder: works, just without the cache
+
+
+def main():
+    library = GameLibrary()
+    matcher = library.current()
+    print(f"{len(matcher)} games from {'cache' if library.from_cache else 'games.txt'}")
+    names = [n.lower().removesuffix(".exe") for n in sys.argv[1:]]
+    if names:
+        print(matcher.best(names))
+
+
+if __name__ == "__main__":
+    main()
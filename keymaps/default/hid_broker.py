@@ -0,0 +1,399 @@
+#!/usr/bin/env python3
+"""
+HID Broker for QMK TIDBIT Keyboard
+Owns the keyboard's RAW HID interface and shares it with the integration scripts
+
+Only one process opens the keyboard. Reports sent by the firmware are routed
+by opcode (byte 0) to every script subscribed to it, so the volume, Discord
+and LIFX scripts no longer race each other for reads. Writes from all
+scripts go through one queue and reach the keyboard one at a time.
+
+Scripts connect with hid_client.HidClient, which starts this broker if it
+is not running yet. Run it by hand to watch it:
+
+    python hid_broker.py            # run in the foreground
+    python hid_broker.py --stats    # print the counters of the running broker
+    python hid_broker.py --fake     # serve a fake keyboard (no hardware needed)
+
+Counters per channel (opcode): reports routed, delivered and dropped,
+subscriber queue depth (current and max), delivery latency from the
+device read to the subscriber socket (avg and max), and writes with their
+queue latency.
+
+Each time the keyboard connects the broker sends it a version query. Every
+script gets the reply and redraws its part of the OLED, which a replug or
+a firmware reset leaves blank.
+"""
+
+import json
+import queue
+import socket
+import sys
+import threading
+import time
+
+from hid_protocol import HID_OP_VERSION, HID_REPORT_SIZE, REPORT_LENGTH, build_report
+from hid_client import (BROKER_HOST, BROKER_PORT, MSG_SUBSCRIBE, MSG_WRITE, MSG_STATS, MSG_REPORT,
+                        HidClient, send_msg, recv_msg)
+
+# QMK HID RAW settings
+VID = 0x6E61  # OffReno keyboard vendor ID
+PID = 0x6064  # OffReno keyboard product ID
+USAGE_PAGE = 0xFF60
+USAGE = 0x61
+
+RECONNECT_DELAY = 2.0    # Seconds between attempts to find the keyboard
+READ_TIMEOUT_MS = 1000   # Device read timeout, only bounds shutdown time
+SUBSCRIBER_QUEUE = 64    # Reports buffered per subscriber before dropping
+WRITE_QUEUE = 256        # Reports buffered for the keyboard before dropping
+
+
+def find_keyboard():
+    """Find the OffReno keyboard RAW HID interface"""
+    import hid
+    for device in hid.enumerate():
+        if device['vendor_id'] == VID and device['product_id'] == PID:
+            # QMK RAW HID uses usage_page 0xFF60 and usage 0x61
+            if device.get('usage_page') == USAGE_PAGE and device.get('usage') == USAGE:
+                return device['path']
+
+    # Fallback
+    for device in hid.enumerate():
+        if device['vendor_id'] == VID and device['product_id'] == PID:
+            return device['path']
+
+    return None
+
+
+def open_keyboard():
+    """Open the keyboard, or return None if it is not plugged in"""
+    try:
+        import hid
+    except ImportError:
+        print("ERROR: hidapi not available - install with: pip install hidapi")
+        return None
+    path = find_keyboard()
+    if not path:
+        return None
+    keyboard = hid.device()
+    keyboard.open_path(path)
+    return keyboard
+
+
+class ChannelStats:
+    """Counters for one opcode"""
+
+    def __init__(self):
+        self.routed = 0        # Reports read from the keyboard
+        self.delivered = 0     # Copies sent to subscribers
+        self.dropped = 0       # Copies lost to full queues or no subscriber
+        self.depth = 0         # Reports waiting in subscriber queues
+        self.depth_max = 0
+        self.latency_sum = 0.0
+        self.latency_max = 0.0
+        self.writes = 0        # Reports written to the keyboard
+        self.write_latency_sum = 0.0
+        self.write_latency_max = 0.0
+
+    def as_dict(self):
+        return {
+            'routed': self.routed,
+            'delivered': self.delivered,
+            'dropped': self.dropped,
+            'queue_depth': self.depth,
+            'queue_depth_max': self.depth_max,
+            'latency_avg_ms': round(1000 * self.latency_sum / self.delivered, 3) if self.delivered else 0,
+            'latency_max_ms': round(1000 * self.latency_max, 3),
+            'writes': self.writes,
+            'write_latency_avg_ms': round(1000 * self.write_latency_sum / self.writes, 3) if self.writes else 0,
+            'write_latency_max_ms': round(1000 * self.write_latency_max, 3),
+        }
+
+
+class Subscriber:
+    """One connected script: its opcodes and an outbound queue drained by its own thread"""
+
+    def __init__(self, broker, sock):
+        self.broker = broker
+        self.sock = sock
+        self.opcodes = set()
+        self.queue = queue.Queue(maxsize=SUBSCRIBER_QUEUE)
+
+    def start(self):
+        """Start serving; call once the broker lists this subscriber, so drop() can find it"""
+        threading.Thread(target=self._receive, name="broker-client-in", daemon=True).start()
+        threading.Thread(target=self._send, name="broker-client-out", daemon=True).start()
+        return self
+
+    def offer(self, report, received):
+        """Queue a keyboard report; False if this subscriber is backed up"""
+        try:
+            self.queue.put_nowait((report, received))
+            return True
+        except queue.Full:
+            return False
+
+    def _send(self):
+        while True:
+            item = self.queue.get()
+            if item is None:
+                return
+            report, received = item
+            try:
+                send_msg(self.sock, MSG_REPORT, report)
+            except OSError:
+                self.broker.drop(self, unsent=report)
+                return
+            self.broker.delivered(report[0], time.monotonic() - received)
+
+    def _receive(self):
+        try:
+            while True:
+                kind, payload = recv_msg(self.sock)
+                if kind == MSG_SUBSCRIBE:
+                    self.opcodes = set(payload)
+                elif kind == MSG_WRITE:
+                    self.broker.write(payload)
+                elif kind == MSG_STATS:
+                    send_msg(self.sock, MSG_STATS, json.dumps(self.broker.stats()).encode('utf-8'))
+        except (ConnectionError, OSError):
+            pass
+        self.broker.drop(self)
+
+    def drain(self):
+        """Take the reports still queued; they will not be sent"""
+        reports = []
+        while True:
+            try:
+                item = self.queue.get_nowait()
+            except queue.Empty:
+                return reports
+            if item is not None:
+                reports.append(item[0])
+
+    def close(self):
+        self.queue.put(None)
+        try:
+            self.sock.close()
+        except OSError:
+            pass
+
+
+class Broker:
+    """Shares one keyboard between any number of local clients
+
+    Args:
+        open_device: callable returning an opened hid.device-like object,
+            or None while the keyboard is not plugged in
+        host, port: where to listen; port 0 picks a free one (see self.port)
+    """
+
+    def __init__(self, open_device=open_keyboard, host=BROKER_HOST, port=BROKER_PORT):
+        self.open_device = open_device
+        self.listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        if sys.platform != 'win32':
+            # Lets a restarted broker reuse the port; on Windows this would
+            # let two brokers share it
+            self.listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.listener.bind((host, port))  # Raises OSError if a broker is already running
+        self.listener.listen()
+        self.port = self.listener.getsockname()[1]
+
+        self.lock = threading.Lock()
+        self.subscribers = []
+        self.channels = {}
+        self.writes = queue.Queue(maxsize=WRITE_QUEUE)
+        self.writes_dropped = 0
+        self.device = None
+        self.connected = threading.Event()
+        self.running = True
+        self.started = time.monotonic()
+
+    def start(self):
+        threading.Thread(target=self._accept, name="broker-accept", daemon=True).start()
+        threading.Thread(target=self._device_loop, name="broker-read", daemon=True).start()
+        threading.Thread(target=self._writer, name="broker-write", daemon=True).start()
+        return self
+
+    def stop(self):
+        self.running = False
+        self.listener.close()
+        self.writes.put(None)
+        with self.lock:
+            subscribers, self.subscribers = self.subscribers, []
+        for subscriber in subscribers:
+            subscriber.close()
+
+    def _channel(self, opcode):
+        channel = self.channels.get(opcode)
+        if channel is None:
+            channel = self.channels[opcode] = ChannelStats()
+        return channel
+
+    # --- Clients ---
+
+    def _accept(self):
+        while self.running:
+            try:
+                sock, _ = self.listener.accept()
+            except OSError:
+                return
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            subscriber = Subscriber(self, sock)
+            with self.lock:
+                self.subscribers.append(subscriber)
+            subscriber.start()
+
+    def drop(self, subscriber, unsent=None):
+        """Disconnect a subscriber; unsent is a report its sender took but could not send"""
+        with self.lock:
+            lost = [unsent] if unsent is not None else []
+            if subscriber in self.subscribers:
+                self.subscribers.remove(subscriber)
+                lost += subscriber.drain()
+            # Each report lost counts on its own opcode, not on every one subscribed
+            for report in lost:
+                channel = self._channel(report[0])
+                channel.dropped += 1
+                channel.depth = max(0, channel.depth - 1)
+        subscriber.close()
+
+    def delivered(self, opcode, latency):
+        with self.lock:
+            channel = self._channel(opcode)
+            channel.delivered += 1
+            channel.depth = max(0, channel.depth - 1)
+            channel.latency_sum += latency
+            channel.latency_max = max(channel.latency_max, latency)
+
+    def publish(self, report, received):
+        """Route a keyboard report to the subscribers of its opcode"""
+        opcode = report[0]
+        with self.lock:
+            channel = self._channel(opcode)
+            channel.routed += 1
+            targets = [s for s in self.subscribers if opcode in s.opcodes]
+            if not targets:
+                channel.dropped += 1
+            for subscriber in targets:
+                if subscriber.offer(report, received):
+                    channel.depth += 1
+                    channel.depth_max = max(channel.depth_max, channel.depth)
+                else:
+                    channel.dropped += 1
+
+    # --- Keyboard ---
+
+    def write(self, report):
+        """Queue a 33-byte output report; writes are sent one at a time"""
+        if len(report) != REPORT_LENGTH:
+            return
+        try:
+            self.writes.put_nowait((bytes(report), time.monotonic()))
+        except queue.Full:
+            with self.lock:
+                self.writes_dropped += 1
+
+    def _writer(self):
+        while True:
+            item = self.writes.get()
+            if item is None:
+                return
+            report, queued = item
+            if not self.connected.wait(RECONNECT_DELAY * 2):
+                with self.lock:
+                    self.writes_dropped += 1
+                continue
+            try:
+                self.device.write(report)
+            except (OSError, ValueError, AttributeError):
+                with self.lock:
+                    self.writes_dropped += 1
+                continue
+            latency = time.monotonic() - queued
+            with self.lock:
+                channel = self._channel(report[1])
+                channel.writes += 1
+                channel.write_latency_sum += latency
+                channel.write_latency_max = max(channel.write_latency_max, latency)
+
+    def _device_loop(self):
+        while self.running:
+            try:
+                device = self.open_device()
+            except OSError:
+                device = None
+            if device is None:
+                time.sleep(RECONNECT_DELAY)
+                continue
+
+            self.device = device
+            self.connected.set()
+            print("Keyboard connected")
+            self.write(build_report(HID_OP_VERSION))  # Scripts redraw on the reply
+            try:
+                while self.running:
+                    data = device.read(HID_REPORT_SIZE, timeout_ms=READ_TIMEOUT_MS)
+                    if data:
+                        self.publish(bytes(data), time.monotonic())
+            except (OSError, ValueError):
+                print("Keyboard disconnected")
+            finally:
+                self.connected.clear()
+                self.device = None
+                try:
+                    device.close()
+                except OSError:
+                    pass
+
+    def stats(self):
+        with self.lock:
+            return {
+                'uptime_s': round(time.monotonic() - self.started, 1),
+                'keyboard_connected': self.connected.is_set(),
+                'clients': len(self.subscribers),
+                'write_queue_depth': self.writes.qsize(),
+                'writes_dropped': self.writes_dropped,
+                'channels': {f"0x{op:02X}": c.as_dict() for op, c in sorted(self.channels.items())},
+            }
+
+
+def print_stats():
+    try:
+        client = HidClient(start_broker=False)
+    except OSError:
+        print("HID broker is not running")
+        return
+    print(json.dumps(client.stats(), indent=2))
+    client.close()
+
+
+def main():
+    if "--stats" in sys.argv:
+        print_stats()
+        return
+
+    open_device = open_keyboard
+    if "--fake" in sys.argv:
+        from fake_hid import fake_pair, version_responder
+        from hid_protocol import HID_PROTOCOL_VERSION, HID_OP_COUNT
+        device, _keyboard = fake_pair(version_responder(HID_PROTOCOL_VERSION, HID_OP_COUNT))
+        open_device = lambda: device
+
+    try:
+        broker = Broker(open_device).start()
+    except OSError:
+        print(f"HID broker already running on port {BROKER_PORT}")
+        return
+
+    print(f"HID broker listening on {BROKER_HOST}:{broker.port}")
+    try:
+        while True:
+            time.sleep(3600)
+    except KeyboardInterrupt:
+        print("\nHID broker stopped")
+        broker.stop()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+Client side of hid_broker.py for the TIDBIT integration scripts
+
+HidClient connects to the broker over a local socket, subscribes to the
+opcodes a script handles, and offers the read()/write()/close() calls of a
+hid.device, so a script that used to open the keyboard itself only swaps
+the object it talks to. If no broker is running, one is started.
+
+Reports are pushed by the broker, not polled: a reader thread blocks on the
+socket and hands each report to a waiting read(), or to read_async() on an
+asyncio loop, as soon as it arrives. An idle script does not wake up.
+
+Messages on the socket are framed as a 2-byte big-endian length followed by
+a type byte and the payload (see MSG_*).
+"""
+
+import asyncio
+import json
+import os
+import queue
+import socket
+import struct
+import subprocess
+import sys
+import threading
+import time
+
+from hid_protocol import HID_REPORT_SIZE, HID_OP_VERSION
+
+BROKER_HOST = '127.0.0.1'
+BROKER_PORT = 47613
+BROKER_SCRIPT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "hid_broker.py")
+BROKER_START_TIMEOUT = 5.0  # Seconds to wait for a freshly started broker
+
+MSG_SUBSCRIBE = ord('S')  # client -> broker: opcodes to receive
+MSG_WRITE = ord('W')      # client -> broker: 33-byte output report
+MSG_STATS = ord('Q')      # client -> broker: counter request; broker -> client: JSON reply
+MSG_REPORT = ord('R')     # broker -> client: 32-byte report from the keyboard
+
+_HEADER = struct.Struct('>H')
+
+
+def send_msg(sock, kind, payload=b''):
+    """Send one framed message"""
+    sock.sendall(_HEADER.pack(len(payload) + 1) + bytes([kind]) + bytes(payload))
+
+
+def _recv_exact(sock, size):
+    data = b''
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("broker connection closed")
+        data += chunk
+    return data
+
+
+def recv_msg(sock):
+    """Receive one framed message, returns (kind, payload)"""
+    (size,) = _HEADER.unpack(_recv_exact(sock, _HEADER.size))
+    body = _recv_exact(sock, size)
+    return body[0], body[1:]
+
+
+def _start_broker():
+    """Launch hid_broker.py detached from this script"""
+    kwargs = {}
+    if sys.platform == 'win32':
+        kwargs['creationflags'] = subprocess.CREATE_NO_WINDOW | subprocess.DETACHED_PROCESS
+    else:
+        kwargs['start_new_session'] = True
+    subprocess.Popen([sys.executable, BROKER_SCRIPT], stdin=subprocess.DEVNULL,
+                     stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, **kwargs)
+
+
+class HidClient:
+    """Keyboard access through hid_broker.py, usable in place of a hid.device
+
+    Args:
+        opcodes: HID_OP_* values whose reports this client receives
+        host, port: broker address; port defaults to BROKER_PORT as it is
+            when the client is created, so a test can point the scripts at
+            a broker of its own
+        start_broker: launch hid_broker.py if nothing is listening
+    """
+
+    def __init__(self, opcodes=(), host=BROKER_HOST, port=None, start_broker=True):
+        self.sock = self._connect(host, BROKER_PORT if port is None else port, start_broker)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.reports = queue.Queue()
+        self._stats = queue.Queue()
+        self._closed = False
+        self._lock = threading.Lock()
+        self._write_lock = threading.Lock()  # Acks and display reports come from different threads
+        self._loop = None           # Set by the first read_async()
+        self._async_reports = None
+        self.received_us = 0        # time.monotonic_ns() // 1000 when the last report read arrived
+        # Version replies are always wanted, check_version() waits for one
+        send_msg(self.sock, MSG_SUBSCRIBE, bytes(set(opcodes) | {HID_OP_VERSION}))
+        threading.Thread(target=self._reader, name="hid-client-reader", daemon=True).start()
+
+    @staticmethod
+    def _connect(host, port, start_broker):
+        try:
+            return socket.create_connection((host, port))
+        except OSError:
+            if not start_broker:
+                raise
+        _start_broker()
+        deadline = time.monotonic() + BROKER_START_TIMEOUT
+        while True:
+            try:
+                return socket.create_connection((host, port))
+            except OSError:
+                if time.monotonic() > deadline:
+                    raise
+                time.sleep(0.1)
+
+    def _deliver(self, report):
+        with self._lock:
+            if self._loop is None:
+                self.reports.put(report)
+                return
+            loop, target = self._loop, self._async_reports
+        try:
+            loop.call_soon_threadsafe(target.put_nowait, report)
+        except RuntimeError:
+            pass  # Loop already closed
+
+    def _reader(self):
+        try:
+            while True:
+                kind, payload = recv_msg(self.sock)
+                if kind == MSG_REPORT:
+                    self._deliver((time.monotonic_ns() // 1000, list(payload)))
+                elif kind == MSG_STATS:
+                    self._stats.put(json.loads(payload.decode('utf-8')))
+        except (ConnectionError, OSError):
+            pass
+        finally:
+            self._deliver(None)  # Wake a blocked read
+
+    def write(self, data):
+        """Queue a 33-byte output report (report ID first) for the keyboard"""
+        with self._write_lock:
+            send_msg(self.sock, MSG_WRITE, bytes(data))
+        return len(data)
+
+    def read(self, max_length=HID_REPORT_SIZE, timeout_ms=0):
+        """Next report for the subscribed opcodes, like hid.device.read()
+
+        Blocks until a report arrives, or for timeout_ms if it is non-zero.
+        Returns [] on timeout. Raises ConnectionError once the broker is gone.
+        """
+        try:
+            report = self.reports.get(timeout=timeout_ms / 1000 if timeout_ms else None)
+        except queue.Empty:
+            return []
+        if report is None:
+            self.reports.put(None)  # Keep later reads failing too
+            raise ConnectionError("broker connection closed")
+        self.received_us, report = report
+        return report[:max_length]
+
+    async def read_async(self, max_length=HID_REPORT_SIZE):
+        """Next report for the subscribed opcodes, awaited on the running loop
+
+        Once called, reports go to the asyncio loop only; do not mix with read().
+        Raises ConnectionError once the broker is gone.
+        """
+        if self._async_reports is None:
+            with self._lock:
+                self._loop = asyncio.get_running_loop()
+                self._async_reports = asyncio.Queue()
+                # Hand over anything that arrived before the switch
+                while not self.reports.empty():
+                    self._async_reports.put_nowait(self.reports.get_nowait())
+        report = await self._async_reports.get()
+        if report is None:
+            self._async_reports.put_nowait(None)
+            raise ConnectionError("broker connection closed")
+        self.received_us, report = report
+        return report[:max_length]
+
+    def stats(self, timeout=2.0):
+        """Broker counters, as returned by Broker.stats()"""
+        with self._write_lock:
+            send_msg(self.sock, MSG_STATS)
+        return self._stats.get(timeout=timeout)
+
+    def close(self):
+        if not self._closed:
+            self._closed = True
+            try:
+                self.sock.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+            self.sock.close()
@@ -0,0 +1,214 @@
+#pragma once
+
+// Raw HID protocol between the keymap and the Python host scripts.
+//
+// This header is the single definition of the protocol: hid_protocol.py
+// reads the HID_* defines below at import time, so keep every value a plain
+// decimal or hex literal on one "#define NAME value" line.
+//
+// Every report is 32 bytes (the host prepends report ID 0x00 when writing).
+// Byte 0 is the opcode, byte 1 the command within that opcode for the
+// encoder integrations, and the payload follows at the offsets listed here.
+
+// Bump when an opcode or payload layout changes
+#define HID_PROTOCOL_VERSION 10
+
+#define HID_REPORT_SIZE 32
+
+// Opcodes (byte 0). Keep them contiguous from HID_OP_BASE, the firmware
+// dispatches through a table indexed by opcode - HID_OP_BASE.
+#define HID_OP_BASE      0xF0
+#define HID_OP_MONITOR   0xF0  // host -> kb: system stats, fixed layout (v1 scripts)
+#define HID_OP_VOLUME    0xF1  // kb -> host: encoder 1 volume balance
+#define HID_OP_DISCORD   0xF2  // both ways: encoder 2 Discord voice control
+#define HID_OP_LIFX      0xF3  // both ways: encoder 3 LIFX lamp
+#define HID_OP_VERSION   0xF4  // host -> kb query, kb -> host reply
+#define HID_OP_TELEMETRY 0xF5  // host -> kb: tagged metric frame
+#define HID_OP_ACTION    0xF6  // both ways: host action run by action_agent.py
+#define HID_OP_PERF      0xF7  // host -> kb query, kb -> host reply: timing counters
+#define HID_OP_COUNT     8
+
+// Commands (byte 1) sent by the keyboard for HID_OP_VOLUME, HID_OP_DISCORD
+// and HID_OP_LIFX
+#define HID_CMD_CW     0x01  // encoder turned clockwise (v2 firmware)
+#define HID_CMD_CCW    0x02  // encoder turned counter-clockwise (v2 firmware)
+#define HID_CMD_BUTTON 0x03  // encoder button pressed
+#define HID_CMD_DELTA  0x05  // net detents since the last report
+
+// Commands (byte 1) sent by the host
+#define HID_DISCORD_USER   0x01  // selected voice user
+#define HID_DISCORD_MUTED  0x04  // mute state of the selected user
+#define HID_LIFX_STATUS    0x04  // status text for the OLED
+#define HID_CMD_ACK        0x06  // HID_OP_VOLUME, HID_OP_DISCORD, HID_OP_LIFX: report received
+
+// HID_OP_MONITOR: cpu %, gpu %, gpu memory % (u16 BE), ping ms (u16 BE)
+#define HID_MONITOR_CPU     1
+#define HID_MONITOR_GPU     2
+#define HID_MONITOR_GPU_MEM 3
+#define HID_MONITOR_PING    5
+#define HID_MONITOR_LEN     7
+
+// HID_OP_TELEMETRY: entry count, then that many entries of a tag byte (the
+// metric ID, plus HID_TELEMETRY_DELTA when the value is a change from the
+// last one) followed by the value as an LEB128 varint. Deltas are zigzag
+// encoded first (0, -1, 1, -2, 2 -> 0, 1, 2, 3, 4). Values are clamped to
+// 0..65535. Small values take 2 bytes per metric, so a report fits ~15.
+#define HID_TELEMETRY_COUNT   1
+#define HID_TELEMETRY_ENTRIES 2
+#define HID_TELEMETRY_LEN     2
+#define HID_TELEMETRY_DELTA   0x80
+
+// Metric IDs; the keyboard ignores IDs at or above HID_METRIC_COUNT
+#define HID_METRIC_CPU       0  // CPU load, percent
+#define HID_METRIC_GPU       1  // GPU load, percent
+#define HID_METRIC_GPU_MEM   2  // GPU memory (VRAM) used, percent
+#define HID_METRIC_PING      3  // Network latency, ms
+#define HID_METRIC_CPU_TEMP  4  // Degrees C
+#define HID_METRIC_GPU_TEMP  5  // Degrees C
+#define HID_METRIC_CPU_CLOCK 6  // MHz
+#define HID_METRIC_GPU_CLOCK 7  // MHz
+#define HID_METRIC_COUNT     8
+
+// HID_CMD_DELTA: signed net detents (int8, positive = clockwise) and the
+// velocity class of the turn, from the detents counted in one window
+#define HID_DELTA_STEPS    2
+#define HID_DELTA_VELOCITY 3
+#define HID_VELOCITY_SLOW   0  // one detent
+#define HID_VELOCITY_MEDIUM 1  // two or three detents
+#define HID_VELOCITY_FAST   2  // four or more detents
+
+// Trace stamp of every report the keyboard sends on HID_OP_VOLUME,
+// HID_OP_DISCORD and HID_OP_LIFX, after the command's payload. The
+// sequence number counts those reports across all three opcodes (1-65535,
+// wrapping past 0; 0 means unstamped, older firmware). Both times are the
+// keyboard's timer_read32(): the first detent or the button press the
+// report carries, and the moment it was sent. trace_log.py records them
+// next to the host's receive, dispatch and completion times.
+#define HID_TRACE_SEQ   4  // u16 BE
+#define HID_TRACE_EVENT 6  // u32 BE, ms
+#define HID_TRACE_SENT  10 // u32 BE, ms
+#define HID_TRACE_LEN   14
+
+// HID_CMD_ACK: the HID_TRACE_SEQ of a HID_CMD_BUTTON report the script has
+// received, 0 for the hello a script sends when it connects. The keyboard
+// sends a button report again until it is acked (see reliable.h); the
+// script acks every copy and acts on the first, telling copies apart by
+// sequence number and event time.
+#define HID_ACK_SEQ 2  // u16 BE
+#define HID_ACK_LEN 4
+
+// HID_DISCORD_USER: index, total, NUL-terminated name
+#define HID_DISCORD_USER_INDEX 2
+#define HID_DISCORD_USER_TOTAL 3
+#define HID_DISCORD_USER_NAME  4
+#define HID_DISCORD_USER_LEN   4
+
+// HID_DISCORD_MUTED: 1 = muted, 0 = unmuted
+#define HID_DISCORD_MUTED_STATE 2
+#define HID_DISCORD_MUTED_LEN   3
+
+// HID_LIFX_STATUS: NUL-terminated text
+#define HID_LIFX_STATUS_TEXT 2
+#define HID_LIFX_STATUS_LEN  2
+
+// Longest name or status text the keyboard keeps
+#define HID_TEXT_MAX 27
+
+// Display slots: each host -> kb report that sets something the OLED shows
+// owns a slot, and carries a per-slot sequence number (1-255, wrapping past
+// 0) in its last byte, after the longest text field. The keyboard drops a
+// report whose sequence number is not newer than the last one applied to
+// its slot, so a late frame never overwrites fresher state. 0 means
+// unsequenced (v3 scripts) and is always applied. A HID_OP_VERSION query
+// resets the slots of the opcode it names, since the script starting over
+// numbers them from 1 again; the other scripts' slots are left alone.
+#define HID_DISPLAY_SEQ         31
+#define HID_SLOT_DISCORD_USER   0  // HID_DISCORD_USER
+#define HID_SLOT_DISCORD_MUTED  1  // HID_DISCORD_MUTED
+#define HID_SLOT_LIFX_STATUS    2  // HID_LIFX_STATUS
+#define HID_SLOT_COUNT          3
+
+// HID_OP_ACTION: the keyboard asks action_agent.py to run action ID (an
+// ACTION_* of app_table.h) and the agent answers with HID_ACTION_STARTED at
+// once, then HID_ACTION_DONE or HID_ACTION_FAILED when the command exits,
+// each with the run's tag and a text for the OLED. The agent announces
+// itself with HID_ACTION_HELLO, carrying the action count and
+// ACTION_TABLE_CRC of the apps.txt it read; the keyboard only sends runs to
+// an agent whose table matches its own, and types the Win+R command itself
+// otherwise. supervisor.py also sends HID_ACTION_MODULES with its hello and
+// whenever a module it hosts is enabled, disabled, crashes or comes back.
+#define HID_ACTION_RUN     0x01  // kb -> host: action ID, tag
+#define HID_ACTION_RESULT  0x02  // host -> kb: action ID, tag, status, text
+#define HID_ACTION_HELLO   0x03  // host -> kb: action count, table CRC
+#define HID_ACTION_MODULES 0x04  // host -> kb: enabled and running HID_MODULE_* bits
+
+#define HID_ACTION_ID          2
+#define HID_ACTION_TAG         3  // Echoed in the results of the run
+#define HID_ACTION_STATUS      4
+#define HID_ACTION_TEXT        5
+#define HID_ACTION_RESULT_LEN  5
+#define HID_ACTION_HELLO_COUNT 2
+#define HID_ACTION_HELLO_CRC   3
+#define HID_ACTION_HELLO_LEN   4
+#define HID_ACTION_MODULES_ENABLED 2  // Switched on, whether running or restarting
+#define HID_ACTION_MODULES_RUNNING 3
+#define HID_ACTION_MODULES_LEN     4
+
+#define HID_ACTION_STARTED 0  // command launched
+#define HID_ACTION_DONE    1  // command exited with status 0
+#define HID_ACTION_FAILED  2  // command failed or could not start
+#define HID_ACTION_UNKNOWN 3  // no command for this action on the host
+
+// Integrations hosted by supervisor.py
+#define HID_MODULE_MONITOR 0x01  // system_monitor_hid.py
+#define HID_MODULE_VOLUME  0x02  // volume_balance.py
+#define HID_MODULE_DISCORD 0x04  // discord_voice_control.py
+#define HID_MODULE_LIFX    0x08  // lifx_control.py
+
+// Milliseconds the keyboard waits for HID_ACTION_STARTED before it takes
+// the agent for gone and types the command instead
+#define HID_ACTION_TIMEOUT_MS 500
+
+// HID_OP_PERF: the firmware times its main callbacks (perf_stats.h) and
+// perf_stats.py reads the counters. Every query is answered by one reply
+// with the same opcode and command. Counts since the last HID_PERF_RESET;
+// durations in microseconds, u16 BE values saturate at 65535. Bucket
+// counts are sent modulo 65536, so the host takes differences.
+#define HID_PERF_INFO  0x01  // probe count, bucket count, time since reset, dropped reports
+#define HID_PERF_PROBE 0x02  // query: probe ID; reply: its counters
+#define HID_PERF_RESET 0x03  // zero every counter, then answered like HID_PERF_INFO
+
+#define HID_PERF_INFO_PROBES     2
+#define HID_PERF_INFO_BUCKETS    3
+#define HID_PERF_INFO_ELAPSED    4   // u32 BE, ms
+#define HID_PERF_INFO_DROPPED    8   // u16 BE, raw HID reports ignored
+#define HID_PERF_INFO_RESOLUTION 10  // u16 BE, us per clock tick
+#define HID_PERF_INFO_BOUNDS     12  // u16 BE upper bound of each bucket but the last
+#define HID_PERF_PROBE_ID        2
+#define HID_PERF_PROBE_CALLS     3   // u32 BE
+#define HID_PERF_PROBE_MIN       7   // u16 BE
+#define HID_PERF_PROBE_MAX       9   // u16 BE
+#define HID_PERF_PROBE_MEAN      11  // u16 BE
+#define HID_PERF_PROBE_HIST      13  // u16 BE per bucket
+#define HID_PERF_LEN             2
+#define HID_PERF_PROBE_LEN       3
+
+// Probe IDs, in perf_probe_t order
+#define HID_PERF_SCAN    0  // matrix_scan_kb
+#define HID_PERF_GAP     1  // period between matrix scans
+#define HID_PERF_OLED    2  // oled_task_kb
+#define HID_PERF_HID     3  // raw_hid_receive
+#define HID_PERF_ENCODER 4  // encoder_update_user
+#define HID_PERF_PROBES  5
+#define HID_PERF_BUCKETS 8
+
+// HID_OP_VERSION query: the opcode of the script asking, whose display
+// slots start over (0 for none, as the broker asks when the keyboard
+// connects). Reply: protocol version, first opcode, opcode count, and the
+// keyboard's timer_read32() so the host can map trace stamps to its clock.
+#define HID_VERSION_QUERY_OP 1
+#define HID_VERSION_PROTOCOL 1
+#define HID_VERSION_OP_BASE  2
+#define HID_VERSION_OP_COUNT 3
+#define HID_VERSION_UPTIME   4  // u32 BE, ms
+#define HID_VERSION_LEN      1
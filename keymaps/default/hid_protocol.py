@@ -0,0 +1,384 @@
+#!/usr/bin/env python3
+"""
+Raw HID protocol shared with the TIDBIT firmware
+
+The opcodes, commands and payload offsets are read from hid_protocol.h, the
+same header keymap.c includes, so the scripts and the firmware cannot drift
+apart. Every HID_* define in the header becomes a module constant here, e.g.
+HID_OP_DISCORD or HID_MONITOR_PING.
+
+Reports written to the keyboard are 33 bytes: report ID 0x00 followed by the
+32-byte packet. Reports read back are the bare 32-byte packet.
+"""
+
+import os
+import re
+import time
+from collections import deque
+
+HEADER_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "hid_protocol.h")
+
+_DEFINE = re.compile(r'^\s*#define\s+(HID_\w+)\s+(0[xX][0-9A-Fa-f]+|\d+)\b')
+
+
+def _load_header(path):
+    """Parse the '#define HID_NAME value' lines of hid_protocol.h"""
+    values = {}
+    with open(path, 'r') as f:
+        for line in f:
+            match = _DEFINE.match(line)
+            if match:
+                values[match.group(1)] = int(match.group(2), 0)
+    return values
+
+
+PROTOCOL = _load_header(HEADER_FILE)
+globals().update(PROTOCOL)
+
+# Report ID plus packet
+REPORT_LENGTH = HID_REPORT_SIZE + 1
+
+
+def build_report(opcode, command=None, fields=None, text_offset=None, text=''):
+    """Build an output report
+
+    Args:
+        opcode: HID_OP_* value for byte 0 of the packet
+        command: optional command for byte 1
+        fields: optional {packet offset: byte value}
+        text_offset: packet offset of a NUL-terminated text field
+        text: text for that field, truncated to HID_TEXT_MAX bytes
+    """
+    data = bytearray(REPORT_LENGTH)
+    data[0] = 0x00  # Report ID (required for HID)
+    data[1] = opcode
+    if command is not None:
+        data[2] = command
+    for offset, value in (fields or {}).items():
+        data[1 + offset] = value & 0xFF
+    if text_offset is not None:
+        encoded = text.encode('utf-8')[:HID_TEXT_MAX]
+        data[1 + text_offset:1 + text_offset + len(encoded)] = encoded
+    return bytes(data)
+
+
+def monitor_report(cpu, gpu, gpu_mem, ping):
+    """System stats: cpu %, gpu %, gpu memory %, ping ms"""
+    gpu_mem = max(0, min(gpu_mem, 0xFFFF))
+    ping = max(0, min(ping, 0xFFFF))
+    return build_report(HID_OP_MONITOR, fields={
+        HID_MONITOR_CPU: min(cpu, 255),
+        HID_MONITOR_GPU: min(gpu, 255),
+        HID_MONITOR_GPU_MEM: gpu_mem >> 8,
+        HID_MONITOR_GPU_MEM + 1: gpu_mem,
+        HID_MONITOR_PING: ping >> 8,
+        HID_MONITOR_PING + 1: ping,
+    })
+
+
+def discord_user_report(index, total, name):
+    """Selected Discord voice user, shown as [index+1/total] and the name"""
+    return build_report(HID_OP_DISCORD, HID_DISCORD_USER, fields={
+        HID_DISCORD_USER_INDEX: index,
+        HID_DISCORD_USER_TOTAL: total,
+    }, text_offset=HID_DISCORD_USER_NAME, text=name)
+
+
+def discord_muted_report(muted):
+    """Mute state of the selected Discord user"""
+    return build_report(HID_OP_DISCORD, HID_DISCORD_MUTED, fields={
+        HID_DISCORD_MUTED_STATE: 1 if muted else 0,
+    })
+
+
+def lifx_status_report(message):
+    """LIFX status text for the OLED"""
+    return build_report(HID_OP_LIFX, HID_LIFX_STATUS,
+                        text_offset=HID_LIFX_STATUS_TEXT, text=message)
+
+
+def action_hello_report(count, crc):
+    """Announce an action agent with its action count and table CRC"""
+    return build_report(HID_OP_ACTION, HID_ACTION_HELLO, fields={
+        HID_ACTION_HELLO_COUNT: count,
+        HID_ACTION_HELLO_CRC: crc,
+    })
+
+
+def action_result_report(action, tag, status, text=''):
+    """HID_ACTION_* status of the run tagged tag, with a text for the OLED"""
+    return build_report(HID_OP_ACTION, HID_ACTION_RESULT, fields={
+        HID_ACTION_ID: action,
+        HID_ACTION_TAG: tag,
+        HID_ACTION_STATUS: status,
+    }, text_offset=HID_ACTION_TEXT, text=text)
+
+
+def action_modules_report(enabled, running):
+    """HID_MODULE_* bits of the supervisor's modules: switched on, and actually running"""
+    return build_report(HID_OP_ACTION, HID_ACTION_MODULES, fields={
+        HID_ACTION_MODULES_ENABLED: enabled,
+        HID_ACTION_MODULES_RUNNING: running,
+    })
+
+
+def _u16(data, offset):
+    return data[offset] << 8 | data[offset + 1]
+
+
+def _u32(data, offset):
+    return _u16(data, offset) << 16 | _u16(data, offset + 2)
+
+
+# First firmware protocol version with trace stamps and the uptime in the version reply
+TRACE_VERSION = 8
+
+
+def trace_stamp(data):
+    """(sequence, event ms, sent ms) of a keyboard encoder report, None if unstamped"""
+    if len(data) < HID_TRACE_LEN:
+        return None
+    seq = _u16(data, HID_TRACE_SEQ)
+    if seq == 0:
+        return None
+    return seq, _u32(data, HID_TRACE_EVENT), _u32(data, HID_TRACE_SENT)
+
+
+# First firmware protocol version that resends button reports until acked
+ACK_VERSION = 9
+
+
+def ack_report(opcode, seq):
+    """HID_CMD_ACK of the report stamped seq on opcode; seq 0 is the hello"""
+    return build_report(opcode, HID_CMD_ACK, fields={HID_ACK_SEQ: seq >> 8, HID_ACK_SEQ + 1: seq})
+
+
+class ReportAcker:
+    """Acks the button reports of one encoder and drops the resent copies
+
+    Firmware from ACK_VERSION on resends an HID_CMD_BUTTON report until the
+    script acks it, but only once the script has said hello; older firmware
+    ignores both, so a script can use this with any keyboard.
+
+    Args:
+        keyboard: HidClient subscribed to opcode
+        opcode: HID_OP_VOLUME, HID_OP_DISCORD or HID_OP_LIFX
+        window: reports remembered to spot a copy
+    """
+
+    def __init__(self, keyboard, opcode, window=16):
+        self.keyboard = keyboard
+        self.opcode = opcode
+        self.seen = deque(maxlen=window)
+        self.duplicates = 0
+
+    def hello(self):
+        """Tell the firmware this script acks its reports"""
+        self.keyboard.write(ack_report(self.opcode, 0))
+        return self
+
+    def accept(self, data):
+        """Ack a report if it needs it; False if it is a copy already handled"""
+        if data[0] != self.opcode or data[1] != HID_CMD_BUTTON:
+            return True
+        stamp = trace_stamp(data)
+        if stamp is None:
+            return True  # Unstamped: firmware older than the trace stamps
+        self.keyboard.write(ack_report(self.opcode, stamp[0]))  # Copies too, their ack may be what got lost
+        key = stamp[:2]  # Sequence and press time; the send time differs between copies
+        if key in self.seen:
+            self.duplicates += 1
+            return False
+        self.seen.append(key)
+        return True
+
+
+def perf_query_report(command, probe=0):
+    """HID_OP_PERF query: HID_PERF_INFO, HID_PERF_RESET, or HID_PERF_PROBE of probe"""
+    return build_report(HID_OP_PERF, command, fields={HID_PERF_PROBE_ID: probe})
+
+
+def decode_perf_info(data):
+    """Reply to HID_PERF_INFO or HID_PERF_RESET as a dict"""
+    buckets = data[HID_PERF_INFO_BUCKETS]
+    return {
+        'probes': data[HID_PERF_INFO_PROBES],
+        'buckets': buckets,
+        'elapsed_ms': _u32(data, HID_PERF_INFO_ELAPSED),
+        'dropped': _u16(data, HID_PERF_INFO_DROPPED),
+        'resolution_us': _u16(data, HID_PERF_INFO_RESOLUTION),
+        'bounds_us': [_u16(data, HID_PERF_INFO_BOUNDS + 2 * i) for i in range(buckets - 1)],
+    }
+
+
+def decode_perf_probe(data):
+    """Reply to HID_PERF_PROBE as a dict; hist holds the bucket counts modulo 65536"""
+    return {
+        'probe': data[HID_PERF_PROBE_ID],
+        'calls': _u32(data, HID_PERF_PROBE_CALLS),
+        'min_us': _u16(data, HID_PERF_PROBE_MIN),
+        'max_us': _u16(data, HID_PERF_PROBE_MAX),
+        'mean_us': _u16(data, HID_PERF_PROBE_MEAN),
+        'hist': [_u16(data, HID_PERF_PROBE_HIST + 2 * i) for i in range(HID_PERF_BUCKETS)],
+    }
+
+
+# Display slot of each host -> kb report that sets what the OLED shows,
+# by (opcode, command)
+DISPLAY_SLOTS = {
+    (HID_OP_DISCORD, HID_DISCORD_USER): HID_SLOT_DISCORD_USER,
+    (HID_OP_DISCORD, HID_DISCORD_MUTED): HID_SLOT_DISCORD_MUTED,
+    (HID_OP_LIFX, HID_LIFX_STATUS): HID_SLOT_LIFX_STATUS,
+}
+
+
+def display_slot(report):
+    """HID_SLOT_* of a 33-byte output report, or None if it is not a display report"""
+    return DISPLAY_SLOTS.get((report[1], report[2]))
+
+
+def with_display_seq(report, seq):
+    """Copy of a 33-byte display report stamped with sequence number seq"""
+    data = bytearray(report)
+    data[1 + HID_DISPLAY_SEQ] = seq
+    return bytes(data)
+
+
+# Steps per detent of a HID_CMD_DELTA report, by velocity class
+VELOCITY_SCALE = {HID_VELOCITY_SLOW: 1, HID_VELOCITY_MEDIUM: 1, HID_VELOCITY_FAST: 2}
+
+
+def encoder_steps(data, accelerate=True):
+    """Signed steps of an encoder report, positive = clockwise
+
+    Handles the batched HID_CMD_DELTA of v3 firmware and the one-detent
+    HID_CMD_CW/HID_CMD_CCW of older firmware. With accelerate, fast turns
+    are scaled by VELOCITY_SCALE. Returns 0 for any other command.
+    """
+    command = data[1]
+    if command == HID_CMD_DELTA:
+        steps = data[HID_DELTA_STEPS]
+        steps = steps - 256 if steps > 127 else steps
+        if accelerate:
+            steps *= VELOCITY_SCALE.get(data[HID_DELTA_VELOCITY], 1)
+        return steps
+    if command == HID_CMD_CW:
+        return 1
+    if command == HID_CMD_CCW:
+        return -1
+    return 0
+
+
+def check_version(keyboard, timeout_ms=1000, trace=None, opcode=0):
+    """Ask the keyboard for its protocol version
+
+    Returns the firmware's version, or None if it did not answer (firmware
+    older than the handshake). Prints a warning when the versions differ.
+    Other reports read while waiting are dropped. With a trace_log.TraceLog,
+    the keyboard's uptime in the reply is recorded as a clock sample. A
+    script with display slots passes its opcode, so the keyboard takes its
+    frames numbered from 1 again.
+    """
+    sent = time.monotonic_ns() // 1000
+    keyboard.write(build_report(HID_OP_VERSION, fields={HID_VERSION_QUERY_OP: opcode}))
+    deadline = time.monotonic() + timeout_ms / 1000
+    while time.monotonic() < deadline:
+        data = keyboard.read(REPORT_LENGTH, timeout_ms=100)
+        if data and data[0] == HID_OP_VERSION:
+            version = data[HID_VERSION_PROTOCOL]
+            if trace is not None and version >= TRACE_VERSION:
+                trace.sync(sent, _u32(data, HID_VERSION_UPTIME), time.monotonic_ns() // 1000)
+            if version != HID_PROTOCOL_VERSION:
+                print(f"WARNING: keyboard speaks HID protocol v{version}, "
+                      f"scripts expect v{HID_PROTOCOL_VERSION} - reflash the firmware")
+            return version
+    print("WARNING: keyboard did not answer the HID version query - reflash the firmware")
+    return None
+
+
+def _varint(value):
+    """LEB128 encoding of a non-negative integer"""
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def _zigzag(delta):
+    """Map signed deltas to unsigned: 0, -1, 1, -2, 2 -> 0, 1, 2, 3, 4"""
+    return delta * 2 if delta >= 0 else -delta * 2 - 1
+
+
+class TelemetryEncoder:
+    """Packs metric updates into HID_OP_TELEMETRY reports
+
+    Only metrics whose value changed since the last report are sent, as a
+    zigzag delta when that is shorter than the absolute value. Every
+    keyframe_interval seconds all metrics are sent as absolute values so a
+    keyboard that was replugged or missed a report catches up.
+    """
+
+    def __init__(self, keyframe_interval=2.0):
+        self.keyframe_interval = keyframe_interval
+        self.reset()
+
+    def reset(self):
+        """Forget what the keyboard has; the next encode() is a keyframe"""
+        self.sent = {}
+        self.last_keyframe = None
+
+    def encode(self, values, now=None):
+        """Return the reports that bring the keyboard up to date
+
+        Args:
+            values: {HID_METRIC_* id: value}
+            now: time.monotonic() timestamp, for tests
+
+        Returns an empty list when nothing changed.
+        """
+        now = time.monotonic() if now is None else now
+        keyframe = self.last_keyframe is None or now - self.last_keyframe >= self.keyframe_interval
+        if keyframe:
+            self.last_keyframe = now
+
+        entries = []
+        for metric, value in sorted(values.items()):
+            value = max(0, min(int(value), 0xFFFF))
+            old = self.sent.get(metric)
+            if value == old and not keyframe:
+                continue
+            entry = bytes([metric]) + _varint(value)
+            if old is not None and not keyframe:
+                delta = bytes([metric | HID_TELEMETRY_DELTA]) + _varint(_zigzag(value - old))
+                if len(delta) < len(entry):
+                    entry = delta
+            entries.append(entry)
+            self.sent[metric] = value
+
+        # Split across as many reports as needed
+        space = HID_REPORT_SIZE - HID_TELEMETRY_ENTRIES
+        reports = []
+        frame = []
+        for entry in entries:
+            if frame and sum(map(len, frame)) + len(entry) > space:
+                reports.append(self._report(frame))
+                frame = []
+            frame.append(entry)
+        if frame:
+            reports.append(self._report(frame))
+        return reports
+
+    @staticmethod
+    def _report(entries):
+        data = bytearray(REPORT_LENGTH)
+        data[1] = HID_OP_TELEMETRY
+        data[1 + HID_TELEMETRY_COUNT] = len(entries)
+        payload = b''.join(entries)
+        start = 1 + HID_TELEMETRY_ENTRIES
+        data[start:start + len(payload)] = payload
+        return bytes(data)
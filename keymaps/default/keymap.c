@@ -14,8 +14,21 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <ctype.h>
+
 #include QMK_KEYBOARD_H
 #include "raw_hid.h"
+#include "hid_protocol.h"
+#include "macro_queue.h"
+#include "encoder_batch.h"
+#include "oled_view.h"
+#include "telemetry.h"
+#include "toast.h"
+#include "app_table.h"
+#include "perf_stats.h"
+#include "reliable.h"
+#include "deadline.h"
+#include "fmt.h"
 
 enum layers {
     _BASE = 0,
@@ -36,75 +49,30 @@ typedef enum {
 
 static encoder_mode_t current_mode = MODE_START;
 static int8_t app_index = 0;  // Current selected app index (-1 = idle)
-static uint32_t last_encoder_time = 0;  // Last time encoder was turned
-static bool pending_action = false;  // Action waiting to be executed
 static bool monitoring_active = false;  // System monitoring state
-static uint32_t monitoring_start_time = 0;  // Time when monitoring was activated
 static bool monitoring_startup = false;  // Whether we're in the 5-second startup phase
+static uint8_t monitoring_dots = 0;  // Seconds of the startup phase so far
 static bool volume_balance_running = false;  // Volume balance script state
 static bool discord_control_running = false;  // Discord voice control state
 static bool lifx_control_running = false;  // LIFX lamp control state
 
-// System monitor data from HID RAW
-static uint8_t cpu_load = 0;
-static uint8_t gpu_load = 0;
-static uint16_t fps = 0;
-static uint16_t ping = 0;
-
 // Discord voice control data from HID RAW
 static char discord_user[28] = "No users";  // Current selected user name
 static uint8_t discord_user_index = 0;      // Current user index
 static uint8_t discord_user_total = 0;      // Total users in voice
 static bool discord_user_muted = false;     // Mute status of selected user
-static uint32_t discord_message_time = 0;   // Time when temporary message was shown
-static char discord_message[28] = "";       // Temporary message buffer
-static bool discord_showing_message = false; // Flag to keep showing Discord display for messages
-
-// LIFX lamp control data from HID RAW
-static char lifx_message[28] = "";          // LIFX status message
-static uint32_t lifx_message_time = 0;      // Time when LIFX message was shown
-static bool lifx_showing_message = false;   // Flag to show LIFX message
-
-// Volume balancer control data
-static char volume_message[28] = "";        // Volume balancer status message
-static uint32_t volume_message_time = 0;    // Time when volume message was shown
-static bool volume_showing_message = false; // Flag to show volume message
 
 // RGB LED control data
-static char rgb_message[28] = "";           // RGB LED status message
-static uint32_t rgb_message_time = 0;       // Time when RGB message was shown
-static bool rgb_showing_message = false;    // Flag to show RGB message
 static uint8_t current_color_index = 0;     // Track current color (0-8)
 
-// Power control confirmation system
+// Power control confirmation system (messages are TOAST_POWER toasts)
 static uint8_t power_action_pending = 0;    // 0=none, 1=shutdown, 2=hibernate, 3=restart
-static uint32_t power_action_time = 0;      // Time when power action was first pressed
-static char power_message[28] = "";         // Power action message line 1 for OLED
-static char power_message2[28] = "";        // Power action message line 2 for OLED
-static bool power_showing_message = false;  // Flag to show power confirmation message
-
-// App names for starting (clockwise)
-static const char* start_apps[] = {"Steam", "Discord", "Desktop WP", "NordVPN"};
-static const char* start_bat_files[] = {
-    "start_steam.bat",
-    "start_discord.bat",
-    "start_wallpaper.bat",
-    "start_nordvpn.bat"
-};
-#define NUM_START_APPS 4
-
-// App names for killing (counterclockwise)
-static const char* kill_apps[] = {"Steam", "Discord", "Desktop WP", "NordVPN"};
-static const char* kill_bat_files[] = {
-    "kill_steam.bat",
-    "kill_discord.bat",
-    "kill_wallpaper.bat",
-    "kill_nordvpn.bat"
-};
-#define NUM_KILL_APPS 4
+
+// Apps, their logos and bat files come from app_table.h (generated from
+// apps.txt by app_table.py)
 
 // Track last opened app for OLED display
-static const char* last_app = "Idle";
+static app_id_t last_app = APP_IDLE;
 
 // RGB LED mode names for OLED display
 static const char* rgb_mode_names[] = {
@@ -138,275 +106,365 @@ static const char* rgb_color_names[] = {
 #ifdef OLED_ENABLE
 static bool oled_initialized = false;
 
-// Bitmap logos (128x32 pixels each)
-static const char PROGMEM logo_steam[] = {
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xf8,
-	0xfe, 0xc7, 0x99, 0x7d, 0x7d, 0x7d, 0x3d, 0x99, 0xc7, 0xfe, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x0f, 0x4f, 0x1f, 0x1f, 0x3e, 0x3e, 0x7c, 0xfc, 0xfc, 0xfc, 0xfe, 0xf7, 0x27, 0xdf, 0x7f,
-	0x1f, 0x0f, 0x07, 0x07, 0x03, 0x03, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x01, 0x01, 0x03, 0x02, 0x03, 0x01, 0x41, 0x40,
-	0x00, 0x40, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+#endif
 
-static const char PROGMEM logo_desktop_wp[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0x60, 0x60, 0x60, 
-    0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0xc0, 0x80, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0xfc, 0x0c, 0x8e, 0xcc, 0xec, 0x6c, 0x0e, 0x8c, 0xce, 
-    0xef, 0xef, 0xce, 0x8c, 0x1c, 0xfe, 0xfc, 0xc0, 0xc0, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00, 0x01, 0x01, 0x13, 0x3e, 0x18, 0x11, 0x33, 
-    0x67, 0x67, 0x63, 0x21, 0x24, 0x27, 0xa7, 0x23, 0x21, 0x30, 0x1f, 0x0f, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 
-    0x06, 0x06, 0x06, 0x06, 0x06, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+// Raw HID commands from the Python scripts, dispatched by opcode. Layouts
+// are defined in hid_protocol.h.
+static void hid_monitor(uint8_t *data, uint8_t length) {
+    telemetry_set(HID_METRIC_CPU, data[HID_MONITOR_CPU]);
+    telemetry_set(HID_METRIC_GPU, data[HID_MONITOR_GPU]);
+    telemetry_set(HID_METRIC_GPU_MEM, (data[HID_MONITOR_GPU_MEM] << 8) | data[HID_MONITOR_GPU_MEM + 1]);
+    telemetry_set(HID_METRIC_PING, (data[HID_MONITOR_PING] << 8) | data[HID_MONITOR_PING + 1]);
+    oled_view_touch(VIEW_SRC_MONITOR);
+}
 
-static const char PROGMEM logo_discord[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xf8, 0xfc, 0xfe, 0xfe, 0xff, 0x7f, 0x7f, 0xfe,
-    0xfe, 0xfe, 0xfe, 0x7f, 0x7f, 0xff, 0xfe, 0xfe, 0xfc, 0xf8, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x3f, 0x7f, 0x7f, 0x7f, 0x7e, 0x1c, 0x3c, 0x3f,
-    0x3f, 0x3f, 0x3f, 0x3c, 0x1c, 0x7e, 0x7f, 0x7f, 0x7f, 0x3f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+static void hid_telemetry(uint8_t *data, uint8_t length) {
+    if (telemetry_receive(data, length)) {
+        oled_view_touch(VIEW_SRC_MONITOR);
+    }
+}
 
-static const char PROGMEM logo_nordvpn[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0xc0, 0xe0, 0xf0, 0xf0, 0xf8, 0xfc, 0xfc, 0xfc, 0xfe, 0xfe, 0xfe, 0xfe, 0xfe, 0xfe, 0xfe,
-    0xfe, 0xfe, 0xfe, 0xfc, 0xfc, 0xfc, 0xf8, 0xf0, 0xf0, 0xe0, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0xfc,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0x1f, 0x0f, 0x0f, 0x1f,
-    0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfc, 0xf0, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0x3f, 0x0f, 0x07, 0x01, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x01, 0x03, 0x00, 0x01, 0x07, 0x0f, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
-    0x07, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x07, 0x01, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
+// Copy a NUL-terminated text field (max HID_TEXT_MAX chars, and what fits
+// in size) out of a report
+static void hid_copy_text(char *dest, uint8_t size, const uint8_t *data, uint8_t offset, uint8_t length) {
+    uint8_t len = 0;
+    for (uint8_t i = offset; i < length && len < HID_TEXT_MAX && len < size - 1 && data[i] != 0; i++) {
+        dest[len++] = data[i];
+    }
+    dest[len] = '\0';  // Null terminate
+}
+
+// Host actions run by action_agent.py once it has said hello with a table
+// matching app_table.h. The run last sent waits for HID_ACTION_STARTED; if
+// none comes within HID_ACTION_TIMEOUT_MS (DEADLINE_ACTION) it is typed
+// into Win+R instead.
+static bool    action_agent_ready = false;
+static uint8_t action_waiting_id;
+static uint8_t action_tag;
+
+// HID_MODULE_* bits supervisor.py last reported enabled but not running,
+// and their names by bit
+static uint8_t modules_down;
+static const char PROGMEM module_names[][8] = {"Monitor", "Volume", "Discord", "LIFX"};
+
+// Take the toggle states from what the supervisor actually runs, so a key
+// press always flips the real state; toast the modules that just went down,
+// as many names as fit and "+N" for the rest
+static void hid_modules(uint8_t enabled, uint8_t running) {
+    volume_balance_running = enabled & HID_MODULE_VOLUME;
+    lifx_control_running   = enabled & HID_MODULE_LIFX;
+    if (discord_control_running != ((enabled & HID_MODULE_DISCORD) != 0)) {
+        discord_control_running = !discord_control_running;
+        oled_view_touch(VIEW_SRC_DISCORD);
+    }
+
+    uint8_t down   = enabled & ~running;
+    uint8_t failed = down & ~modules_down;
+    modules_down   = down;
+    if (!failed) {
+        return;
+    }
+
+    char   *text = toast_post(TOAST_ACTION, 3000);
+    char   *end  = text + TOAST_TEXT_SIZE - 1;
+    char   *p    = fmt_P(text, PSTR("Restarting: "));
+    char   *names = p;
+    uint8_t left = __builtin_popcount(failed);
+    for (uint8_t i = 0; failed; i++, failed >>= 1) {
+        if (!(failed & 1)) {
+            continue;
+        }
+        // A comma before it, and room for "+N" after it if more follow
+        uint8_t need = (p != names) + strlen_P(module_names[i]) + (left > 1 ? 2 : 0);
+        if (p + need > end) {
+            p = fmt_P(p, PSTR("+"));
+            fmt_uint(p, left, 0);
+            break;
+        }
+        if (p != names) {
+            p = fmt_P(p, PSTR(","));
+        }
+        p = fmt_P(p, module_names[i]);
+        left--;
+    }
+}
+
+static bool *script_running(uint8_t opcode) {
+    switch (opcode) {
+        case HID_OP_VOLUME:
+            return &volume_balance_running;
+        case HID_OP_DISCORD:
+            return &discord_control_running;
+        default:
+            return &lifx_control_running;
+    }
+}
+
+static void script_set_running(uint8_t opcode, bool running) {
+    bool *flag = script_running(opcode);
+    if (*flag != running) {
+        *flag = running;
+        if (opcode == HID_OP_DISCORD) {
+            oled_view_touch(VIEW_SRC_DISCORD);
+        }
+    }
+}
+
+// A script acked a button report or said hello, so it is running
+static void hid_ack(uint8_t *data, uint8_t length) {
+    if (length < HID_ACK_LEN) {
+        return;
+    }
+    reliable_ack(data[0], data[HID_ACK_SEQ] << 8 | data[HID_ACK_SEQ + 1]);
+    script_set_running(data[0], true);
+}
+
+// A button press its script never acked: the script is gone
+void reliable_lost_user(uint8_t opcode) {
+    script_set_running(opcode, false);
+    char *text = toast_post(TOAST_ACTION, 3000);
+    strcpy_P(text, PSTR("No answer: "));
+    strcpy_P(text + strlen(text), module_names[opcode - HID_OP_VOLUME + 1]);  // Opcodes follow the HID_MODULE_* bits
+}
+
+static void hid_action(uint8_t *data, uint8_t length) {
+    if (data[1] == HID_ACTION_MODULES && length >= HID_ACTION_MODULES_LEN) {
+        hid_modules(data[HID_ACTION_MODULES_ENABLED], data[HID_ACTION_MODULES_RUNNING]);
+    }
+    else if (data[1] == HID_ACTION_HELLO && length >= HID_ACTION_HELLO_LEN) {
+        action_agent_ready = data[HID_ACTION_HELLO_COUNT] == ACTION_COUNT && data[HID_ACTION_HELLO_CRC] == ACTION_TABLE_CRC;
+        if (!action_agent_ready) {
+            toast_post_P(TOAST_ACTION, PSTR("Agent: other apps.txt"), PSTR("Reflash the keymap"), 5000);
+        }
+    }
+    else if (data[1] == HID_ACTION_RESULT && length >= HID_ACTION_RESULT_LEN) {
+        if (data[HID_ACTION_TAG] == action_tag) {
+            deadline_cancel(DEADLINE_ACTION);
+        }
+
+        const char *prefix_P;
+        uint16_t    duration;
+        switch (data[HID_ACTION_STATUS]) {
+            case HID_ACTION_DONE:
+                prefix_P = PSTR("Done: ");
+                duration = 2000;
+                break;
+            case HID_ACTION_FAILED:
+                prefix_P = PSTR("Failed: ");
+                duration = 5000;
+                break;
+            case HID_ACTION_UNKNOWN:
+                prefix_P = PSTR("No command: ");
+                duration = 5000;
+                break;
+            default:
+                return;  // Started, the result follows
+        }
+        char   *text = toast_post(TOAST_ACTION, duration);
+        strcpy_P(text, prefix_P);
+        uint8_t used = strlen(text);
+        hid_copy_text(text + used, TOAST_TEXT_SIZE - used, data, HID_ACTION_TEXT, length);
+    }
+}
+
+// Sequence number last applied per display slot, 0 = none yet
+static uint8_t display_seq[HID_SLOT_COUNT];
 
-static const char PROGMEM my_logo[] = {
-
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x80, 0xe0, 0xf8, 0x7c, 0x1c, 0x0e, 0x06, 0x06, 0x07, 0x06, 0x06, 0x0e, 0x1c, 
-    0xfc, 0xf8, 0xe0, 0x00, 0x00, 0x40, 0x60, 0xfc, 0xfe, 0xfe, 0x66, 0x46, 0x00, 0x40, 0x60, 0xfc, 
-    0xfe, 0xfe, 0x66, 0x46, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0xfe, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 
-    0x0e, 0xde, 0xfc, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xe0, 0x60, 0x60, 0x60, 0xe0, 0xc0, 
-    0x80, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xe0, 0xe0, 0x80, 0xc0, 0x60, 0x60, 0xe0, 0xe0, 0xc0, 0x80, 
-    0x00, 0x00, 0x00, 0x00, 0x80, 0xc0, 0xc0, 0xe0, 0xe0, 0x60, 0xe0, 0xe0, 0xc0, 0x80, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x0f, 0x3f, 0xff, 0xf0, 0xc0, 0x80, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0xc0, 
-    0xf8, 0x7f, 0x3f, 0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 
-    0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 
-    0x0f, 0xff, 0xfd, 0xf8, 0x00, 0x00, 0x00, 0x7e, 0xff, 0xff, 0x8c, 0x0c, 0x0c, 0x0c, 0x8c, 0x8f, 
-    0xcf, 0x4f, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 
-    0x00, 0x00, 0x00, 0x3e, 0xff, 0xff, 0xc1, 0x80, 0x00, 0x00, 0x00, 0x80, 0xf7, 0xff, 0x7f, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 
-    0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x01, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+// Opcode whose script numbers each display slot
+static const uint8_t PROGMEM display_slot_ops[HID_SLOT_COUNT] = {
+    [HID_SLOT_DISCORD_USER]  = HID_OP_DISCORD,
+    [HID_SLOT_DISCORD_MUTED] = HID_OP_DISCORD,
+    [HID_SLOT_LIFX_STATUS]   = HID_OP_LIFX,
 };
 
-// HID RAW receive callback - receives data from Python script
-void raw_hid_receive(uint8_t *data, uint8_t length) {
-    if (data[0] == 0xF0) {  // System monitor data packet
-        cpu_load = data[1];
-        gpu_load = data[2];
-        fps = (data[3] << 8) | data[4];
-        ping = (data[5] << 8) | data[6];
+// True if a display report is newer than what its slot shows (and records
+// it as applied); false for a late frame that must be dropped
+static bool hid_display_fresh(uint8_t slot, const uint8_t *data, uint8_t length) {
+    if (length <= HID_DISPLAY_SEQ || data[HID_DISPLAY_SEQ] == 0) {
+        return true;  // Unsequenced
+    }
+    uint8_t seq = data[HID_DISPLAY_SEQ];
+    if (display_seq[slot] != 0 && (int8_t)(seq - display_seq[slot]) <= 0) {
+        return false;
+    }
+    display_seq[slot] = seq;
+    return true;
+}
+
+static void hid_volume(uint8_t *data, uint8_t length) {
+    if (data[1] == HID_CMD_ACK) {
+        hid_ack(data, length);
+    }
+}
+
+static void hid_discord(uint8_t *data, uint8_t length) {
+    if (data[1] == HID_CMD_ACK) {
+        hid_ack(data, length);
     }
-    else if (data[0] == 0xF2 && data[1] == 0x01) {  // Discord user update
-        discord_user_index = data[2];
-        discord_user_total = data[3];
-
-        // Extract username from remaining bytes (max 27 chars)
-        uint8_t name_len = 0;
-        for (uint8_t i = 4; i < length && i < 31 && data[i] != 0; i++) {
-            discord_user[name_len++] = data[i];
+    else if (data[1] == HID_DISCORD_USER && length >= HID_DISCORD_USER_LEN) {
+        if (!hid_display_fresh(HID_SLOT_DISCORD_USER, data, length)) {
+            return;
         }
-        discord_user[name_len] = '\0';  // Null terminate
+        discord_user_index = data[HID_DISCORD_USER_INDEX];
+        discord_user_total = data[HID_DISCORD_USER_TOTAL];
+        hid_copy_text(discord_user, sizeof(discord_user), data, HID_DISCORD_USER_NAME, length);
+        oled_view_touch(VIEW_SRC_DISCORD);
     }
-    else if (data[0] == 0xF2 && data[1] == 0x04) {  // Discord mute status update
-        discord_user_muted = data[2];  // 0 = unmuted, 1 = muted
-
-        // Set temporary message with mute status (keep it short - max 21 chars)
-        if (discord_user_muted) {
-            // Truncate username if too long
-            char short_name[15];
-            strncpy(short_name, discord_user, 14);
-            short_name[14] = '\0';
-            snprintf(discord_message, sizeof(discord_message), "%s MUTED", short_name);
-        } else {
-            char short_name[15];
-            strncpy(short_name, discord_user, 14);
-            short_name[14] = '\0';
-            snprintf(discord_message, sizeof(discord_message), "%s UNMUTED", short_name);
+    else if (data[1] == HID_DISCORD_MUTED && length >= HID_DISCORD_MUTED_LEN) {
+        if (!hid_display_fresh(HID_SLOT_DISCORD_MUTED, data, length)) {
+            return;
         }
-        discord_message_time = timer_read32();  // Mark message time for 3-second display
-        discord_showing_message = true;
+        discord_user_muted = data[HID_DISCORD_MUTED_STATE];  // 0 = unmuted, 1 = muted
+
+        // Set temporary message with mute status, the username cut so it fits one line
+        const char *state_P = discord_user_muted ? PSTR(" MUTED") : PSTR(" UNMUTED");
+        char       *text    = toast_post(TOAST_DISCORD, 3000);
+        text = fmt_str(text, discord_user, TOAST_TEXT_SIZE - 1 - strlen_P(state_P));
+        fmt_P(text, state_P);
+    }
+}
+
+static void hid_lifx(uint8_t *data, uint8_t length) {
+    if (data[1] == HID_CMD_ACK) {
+        hid_ack(data, length);
+    }
+    else if (data[1] == HID_LIFX_STATUS && length >= HID_LIFX_STATUS_LEN) {
+        if (!hid_display_fresh(HID_SLOT_LIFX_STATUS, data, length)) {
+            return;
+        }
+        hid_copy_text(toast_post(TOAST_LIFX, 5000), TOAST_TEXT_SIZE, data, HID_LIFX_STATUS_TEXT, length);
     }
-    else if (data[0] == 0xF3 && data[1] == 0x04) {  // LIFX status message
-        // Extract message from remaining bytes (max 27 chars)
-        uint8_t msg_len = 0;
-        for (uint8_t i = 2; i < length && i < 29 && data[i] != 0; i++) {
-            lifx_message[msg_len++] = data[i];
+}
+
+// Big-endian value of size bytes at data + offset, saturated to fit
+static void put_be(uint8_t *data, uint8_t offset, uint8_t size, uint32_t value) {
+    if (size < 4 && value >> (8 * size)) {
+        value = (1UL << (8 * size)) - 1;
+    }
+    for (uint8_t i = size; i-- > 0; value >>= 8) {
+        data[offset + i] = value;
+    }
+}
+
+// Handshake - lets a host script check it speaks the same protocol version
+static void hid_version(uint8_t *data, uint8_t length) {
+    uint8_t opcode = length > HID_VERSION_QUERY_OP ? data[HID_VERSION_QUERY_OP] : 0;
+    for (uint8_t slot = 0; slot < HID_SLOT_COUNT; slot++) {
+        if (pgm_read_byte(&display_slot_ops[slot]) == opcode) {
+            display_seq[slot] = 0;  // The script numbers its frames from 1 again
         }
-        lifx_message[msg_len] = '\0';  // Null terminate
-        lifx_message_time = timer_read32();  // Mark message time for 5-second display
-        lifx_showing_message = true;
     }
+
+    uint8_t reply[HID_REPORT_SIZE] = {0};
+    reply[0] = HID_OP_VERSION;
+    reply[HID_VERSION_PROTOCOL] = HID_PROTOCOL_VERSION;
+    reply[HID_VERSION_OP_BASE] = HID_OP_BASE;
+    reply[HID_VERSION_OP_COUNT] = HID_OP_COUNT;
+    put_be(reply, HID_VERSION_UPTIME, 4, timer_read32());
+    raw_hid_send(reply, sizeof(reply));
 }
 
-// Helper function to write large text using multiple rows (for apps without bitmaps yet)
-void render_text_large(const char* text) {
-    // Write text on all 4 lines to make it appear larger/bolder
-    for (uint8_t i = 0; i < 4; i++) {
-        oled_set_cursor(0, i);
-
-        // Add spacing to center text
-        if (strcmp(text, "Ready") == 0) {
-            oled_write_P(PSTR("      READY       "), false);
-        } else if (strcmp(text, "Discord") == 0) {
-            oled_write_P(PSTR("     DISCORD      "), false);
-        } else if (strcmp(text, "Closed WP") == 0) {
-            oled_write_P(PSTR("    CLOSED WP     "), false);
-        } else if (strcmp(text, "Closed VPN") == 0) {
-            oled_write_P(PSTR("   CLOSED VPN     "), false);
-        } else if (strcmp(text, "Monitoring") == 0) {
-            oled_write_P(PSTR("   MONITORING     "), false);
-        } else if (strcmp(text, "NordVPN") == 0) {
-            oled_write_P(PSTR("     NORDVPN      "), false);
+_Static_assert(HID_PERF_PROBES == PERF_PROBE_COUNT, "HID_PERF_* probe IDs out of step with perf_probe_t");
+_Static_assert(HID_PERF_BUCKETS == PERF_BUCKETS, "HID_PERF_BUCKETS out of step with perf_stats.h");
+
+// Diagnostics - timing counters of the main callbacks for perf_stats.py
+static void hid_perf(uint8_t *data, uint8_t length) {
+    uint8_t reply[HID_REPORT_SIZE] = {0};
+    reply[0] = HID_OP_PERF;
+    reply[1] = data[1];
+
+    if (data[1] == HID_PERF_PROBE && length >= HID_PERF_PROBE_LEN && data[HID_PERF_PROBE_ID] < PERF_PROBE_COUNT) {
+        const perf_stats_t *stats = perf_get(data[HID_PERF_PROBE_ID]);
+        reply[HID_PERF_PROBE_ID] = data[HID_PERF_PROBE_ID];
+        put_be(reply, HID_PERF_PROBE_CALLS, 4, stats->calls);
+        put_be(reply, HID_PERF_PROBE_MIN, 2, stats->min_us);
+        put_be(reply, HID_PERF_PROBE_MAX, 2, stats->max_us);
+        put_be(reply, HID_PERF_PROBE_MEAN, 2, perf_mean_us(stats));
+        for (uint8_t i = 0; i < PERF_BUCKETS; i++) {
+            put_be(reply, HID_PERF_PROBE_HIST + 2 * i, 2, stats->buckets[i]);  // Wraps, the host takes differences
+        }
+    } else if (data[1] == HID_PERF_INFO || data[1] == HID_PERF_RESET) {
+        if (data[1] == HID_PERF_RESET) {
+            perf_reset();
+        }
+        reply[HID_PERF_INFO_PROBES] = PERF_PROBE_COUNT;
+        reply[HID_PERF_INFO_BUCKETS] = PERF_BUCKETS;
+        put_be(reply, HID_PERF_INFO_ELAPSED, 4, perf_elapsed_ms());
+        put_be(reply, HID_PERF_INFO_DROPPED, 2, perf_dropped());
+        put_be(reply, HID_PERF_INFO_RESOLUTION, 2, perf_resolution_us());
+        for (uint8_t i = 0; i < PERF_BUCKETS - 1; i++) {
+            put_be(reply, HID_PERF_INFO_BOUNDS + 2 * i, 2, pgm_read_word(&perf_bucket_us[i]));
         }
+    } else {
+        return;
     }
+    raw_hid_send(reply, sizeof(reply));
 }
 
-// Main render function - uses bitmaps where available, text otherwise
-void render_large_text(const char* text) {
-    if (strcmp(text, "Steam") == 0) {
-        // Use bitmap for Steam
-        oled_write_raw_P(logo_steam, sizeof(logo_steam));
-    } else if (strcmp(text, "Discord") == 0) {
-        // Use bitmap for Discord
-        oled_write_raw_P(logo_discord, sizeof(logo_discord));
-    } else if (strcmp(text, "Desktop WP") == 0 || strcmp(text, "Closed WP") == 0) {
-        // Use bitmap for Wallpaper Engine
-        oled_write_raw_P(logo_desktop_wp, sizeof(logo_desktop_wp));
-    } else if (strcmp(text, "NordVPN") == 0 || strcmp(text, "Closed VPN") == 0) {
-        // Use bitmap for NordVPN
-        oled_write_raw_P(logo_nordvpn, sizeof(logo_nordvpn));
-    } else if (strcmp(text, "Idle") == 0) {
-        // Use my custom idle logo
-        oled_write_raw_P(my_logo, sizeof(my_logo));
+typedef struct {
+    void (*handler)(uint8_t *data, uint8_t length);
+    uint8_t min_length;  // Shorter reports are dropped
+} hid_command_t;
+
+static const hid_command_t PROGMEM hid_commands[HID_OP_COUNT] = {
+    [HID_OP_MONITOR - HID_OP_BASE]   = {hid_monitor, HID_MONITOR_LEN},
+    [HID_OP_VOLUME - HID_OP_BASE]    = {hid_volume, 2},
+    [HID_OP_DISCORD - HID_OP_BASE]   = {hid_discord, 2},
+    [HID_OP_LIFX - HID_OP_BASE]      = {hid_lifx, 2},
+    [HID_OP_VERSION - HID_OP_BASE]   = {hid_version, HID_VERSION_LEN},
+    [HID_OP_TELEMETRY - HID_OP_BASE] = {hid_telemetry, HID_TELEMETRY_LEN},
+    [HID_OP_ACTION - HID_OP_BASE]    = {hid_action, 2},
+    [HID_OP_PERF - HID_OP_BASE]      = {hid_perf, HID_PERF_LEN},
+};
+
+static void hid_dispatch(uint8_t *data, uint8_t length) {
+    if (length == 0) {
+        perf_drop();
+        return;
+    }
+    uint8_t op = data[0] - HID_OP_BASE;  // Wraps above HID_OP_COUNT for opcodes below the base
+    if (op >= HID_OP_COUNT) {
+        perf_drop();
+        return;  // Not one of ours
+    }
+
+    hid_command_t command;
+    memcpy_P(&command, &hid_commands[op], sizeof(command));
+    if (command.handler && length >= command.min_length) {
+        command.handler(data, length);
     } else {
-        // Use text rendering for others
-        render_text_large(text);
+        perf_drop();
+    }
+}
+
+// HID RAW receive callback - receives data from Python script
+void raw_hid_receive(uint8_t *data, uint8_t length) {
+    perf_time_t start = perf_now();
+    hid_dispatch(data, length);
+    perf_record(PERF_HID, start);
+}
+
+#ifdef OLED_ENABLE
+
+// Logo if the app has one, else its name in capitals on every line
+static void render_app(app_id_t app) {
+    const char *logo_P = pgm_read_ptr(&apps[app].logo_P);
+    if (logo_P) {
+        oled_view_packed_P(logo_P);
+        return;
+    }
+
+    const char *name_P = pgm_read_ptr(&apps[app].name_P);
+    uint8_t     length = strlen_P(name_P);
+    uint8_t     indent = (OLED_VIEW_COLS - length) / 2;
+    char        banner[OLED_VIEW_COLS + 1];
+    memset(banner, ' ', indent);
+    for (uint8_t i = 0; i < length; i++) {
+        banner[indent + i] = toupper(pgm_read_byte(name_P + i));
+    }
+    banner[indent + length] = '\0';
+    for (uint8_t i = 0; i < OLED_VIEW_LINES; i++) {
+        oled_view_line(i, banner);
     }
 }
 #endif
@@ -429,21 +487,121 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     )
 };
 
-// Helper function to execute bat file via Win+R
-void execute_bat_file(const char* bat_file) {
-    tap_code16(LGUI(KC_R));  // Win+R to open Run dialog
-    wait_ms(150);
+// Queue a command for the Win+R Run dialog. The keystrokes are typed by
+// macro_queue_task() one report per scan, so nothing here blocks.
+static void run_dialog_command(const char* path_P, const char* command_P) {
+    if (macro_queue_free() < 8) {
+        return;  // A previous command is still typing, drop this one whole
+    }
+    macro_queue_tap(LGUI(KC_R));  // Win+R to open Run dialog
+    macro_queue_delay(150);
 
     // Clear any existing text
-    tap_code16(LCTL(KC_A));
-    wait_ms(50);
+    macro_queue_tap(LCTL(KC_A));
+    macro_queue_delay(50);
 
+    if (path_P) {
+        macro_queue_string_P(path_P);
+    }
+    macro_queue_string_P(command_P);
+
+    macro_queue_delay(50);
+    macro_queue_tap(KC_ENT);
+}
+
+// Helper function to execute bat file via Win+R
+void execute_bat_file(const char* bat_file_P) {
     // Type the full path to the bat file
-    send_string("C:\\Users\\Renobatio\\qmk_firmware\\keyboards\\nullbitsco\\tidbit\\keymaps\\default\\");
-    send_string(bat_file);
+    run_dialog_command(PSTR("C:\\Users\\Renobatio\\qmk_firmware\\keyboards\\nullbitsco\\tidbit\\keymaps\\default\\"), bat_file_P);
+}
+
+// Type an action's command into Win+R
+static void type_action(uint8_t action) {
+    action_t entry;
+    memcpy_P(&entry, &actions[action], sizeof(entry));
+    if (entry.bat) {
+        execute_bat_file(entry.command_P);
+    } else {
+        run_dialog_command(NULL, entry.command_P);
+    }
+}
+
+// The agent did not start the last run in time: take it for gone
+static void action_timeout(deadline_id_t id) {
+    action_agent_ready = false;
+    type_action(action_waiting_id);
+}
+
+// A 3 second toast of a PROGMEM label and a name, cut to one line
+static void toast_named(toast_source_t source, const char *label_P, const char *name) {
+    char *text = toast_post(source, 3000);
+    char *end  = fmt_P(text, label_P);
+    fmt_str(end, name, TOAST_TEXT_SIZE - 1 - (end - text));
+}
+
+// Run a host action: one report to action_agent.py, or typed into Win+R
+// when no agent is listening
+static void run_action(uint8_t action) {
+    if (action >= ACTION_COUNT) {
+        return;  // ACTION_NONE
+    }
+    if (!action_agent_ready) {
+        type_action(action);
+        return;
+    }
+
+    uint8_t data[HID_REPORT_SIZE] = {0};
+    data[0]              = HID_OP_ACTION;
+    data[1]              = HID_ACTION_RUN;
+    data[HID_ACTION_ID]  = action;
+    data[HID_ACTION_TAG] = ++action_tag;
+    raw_hid_send(data, sizeof(data));
+
+    action_waiting_id = action;
+    deadline_set(DEADLINE_ACTION, HID_ACTION_TIMEOUT_MS, action_timeout);
+}
+
+// Run an app's start or kill action, if it has one
+static void run_app(app_id_t app, bool start) {
+    run_action(pgm_read_byte(start ? &apps[app].start : &apps[app].kill));
+}
+
+// The app wheel was left alone for 2 seconds: start or kill the app it shows
+static void app_commit(deadline_id_t id) {
+    // Execute the appropriate bat file
+    run_app((app_id_t)app_index, current_mode == MODE_START);
+
+    // Reset to idle
+    app_index = -1;
+    last_app = APP_IDLE;
+    oled_view_touch(VIEW_SRC_APP);
+}
 
-    wait_ms(50);
-    tap_code(KC_ENT);
+// Monitoring startup phase: a dot per second, the stats after 5 seconds
+static void monitoring_tick(deadline_id_t id) {
+    if (++monitoring_dots >= 5) {
+        monitoring_startup = false;
+    } else {
+        deadline_set(id, 1000, monitoring_tick);
+    }
+    oled_view_touch(VIEW_SRC_MONITOR);
+}
+
+// Power action not cancelled within 5 seconds: execute it
+static void power_commit(deadline_id_t id) {
+    if (power_action_pending == 1) {
+        // Shutdown
+        run_action(ACTION_SHUTDOWN);
+    } else if (power_action_pending == 2) {
+        // Hibernate
+        run_action(ACTION_HIBERNATE);
+    } else if (power_action_pending == 3) {
+        // Restart
+        run_action(ACTION_RESTART);
+    }
+    // Clear pending action
+    power_action_pending = 0;
+    toast_dismiss(TOAST_POWER);
 }
 
 // Handle custom keycodes
@@ -454,19 +612,13 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 if (power_action_pending == 1) {
                     // Second press - cancel shutdown
                     power_action_pending = 0;
-                    power_action_time = 0;
-                    power_showing_message = false;
-                    strcpy(power_message, "Shutdown Cancelled");
-                    power_message2[0] = '\0';  // Clear second line
-                    power_action_time = timer_read32();
-                    power_showing_message = true;
+                    deadline_cancel(DEADLINE_POWER);
+                    toast_post_P(TOAST_POWER, PSTR("Shutdown Cancelled"), NULL, 3000);
                 } else {
                     // First press - show confirmation
                     power_action_pending = 1;  // Shutdown
-                    power_action_time = timer_read32();
-                    strcpy(power_message, "Press again to cancel :");
-                    strcpy(power_message2, "Shutdown");
-                    power_showing_message = true;
+                    deadline_set(DEADLINE_POWER, 5000, power_commit);
+                    toast_post_P(TOAST_POWER, PSTR("Press again to cancel :"), PSTR("Shutdown"), TOAST_STICKY);
                 }
             }
             return false;  // Prevent '/' from being sent
@@ -476,19 +628,13 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 if (power_action_pending == 2) {
                     // Second press - cancel hibernate
                     power_action_pending = 0;
-                    power_action_time = 0;
-                    power_showing_message = false;
-                    strcpy(power_message, "Hibernate Cancelled");
-                    power_message2[0] = '\0';  // Clear second line
-                    power_action_time = timer_read32();
-                    power_showing_message = true;
+                    deadline_cancel(DEADLINE_POWER);
+                    toast_post_P(TOAST_POWER, PSTR("Hibernate Cancelled"), NULL, 3000);
                 } else {
                     // First press - show confirmation
                     power_action_pending = 2;  // Hibernate
-                    power_action_time = timer_read32();
-                    strcpy(power_message, "Press again to cancel :");
-                    strcpy(power_message2, "Hibernate");
-                    power_showing_message = true;
+                    deadline_set(DEADLINE_POWER, 5000, power_commit);
+                    toast_post_P(TOAST_POWER, PSTR("Press again to cancel :"), PSTR("Hibernate"), TOAST_STICKY);
                 }
             }
             return false;  // Prevent '*' from being sent
@@ -498,19 +644,13 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 if (power_action_pending == 3) {
                     // Second press - cancel restart
                     power_action_pending = 0;
-                    power_action_time = 0;
-                    power_showing_message = false;
-                    strcpy(power_message, "Restart Cancelled");
-                    power_message2[0] = '\0';  // Clear second line
-                    power_action_time = timer_read32();
-                    power_showing_message = true;
+                    deadline_cancel(DEADLINE_POWER);
+                    toast_post_P(TOAST_POWER, PSTR("Restart Cancelled"), NULL, 3000);
                 } else {
                     // First press - show confirmation
                     power_action_pending = 3;  // Restart
-                    power_action_time = timer_read32();
-                    strcpy(power_message, "Press again to cancel :");
-                    strcpy(power_message2, "Restart");
-                    power_showing_message = true;
+                    deadline_set(DEADLINE_POWER, 5000, power_commit);
+                    toast_post_P(TOAST_POWER, PSTR("Press again to cancel :"), PSTR("Restart"), TOAST_STICKY);
                 }
             }
             return false;  // Prevent '-' from being sent
@@ -522,21 +662,23 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 if (monitoring_active) {
                     // Start monitoring - begin 5 second startup phase
                     monitoring_startup = true;
-                    monitoring_start_time = timer_read32();
-                    execute_bat_file("start_monitor.bat");
-                    last_app = "Monitoring";
+                    monitoring_dots = 0;
+                    deadline_set(DEADLINE_MONITOR_STARTUP, 1000, monitoring_tick);
+                    run_app(APP_MONITOR, true);
+                    last_app = APP_MONITOR;
+                    oled_view_touch(VIEW_SRC_APP);
                     // Cancel any pending encoder rotation action
-                    pending_action = false;
+                    deadline_cancel(DEADLINE_APP_COMMIT);
                 } else {
                     // Stop monitoring
                     monitoring_startup = false;
-                    execute_bat_file("kill_monitor.bat");
-                    last_app = "Idle";
+                    deadline_cancel(DEADLINE_MONITOR_STARTUP);
+                    run_app(APP_MONITOR, false);
+                    last_app = APP_IDLE;
+                    oled_view_touch(VIEW_SRC_APP);
                     // Reset monitoring data
-                    cpu_load = 0;
-                    gpu_load = 0;
-                    fps = 0;
-                    ping = 0;
+                    telemetry_reset();
+                    oled_view_touch(VIEW_SRC_MONITOR);
                 }
             }
             return false;  // Prevent KC_P7 from being sent
@@ -544,10 +686,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         case KC_P4:  // Encoder 1 button - rebalance volumes
             if (record->event.pressed) {
                 // Send HID RAW command to rebalance Discord/Game volumes
-                uint8_t data[32] = {0};
-                data[0] = 0xF1;  // Volume command identifier
-                data[1] = 0x03;  // 0x03 = Rebalance command
-                raw_hid_send(data, sizeof(data));
+                encoder_batch_button(HID_OP_VOLUME);
             }
             return false;  // Prevent KC_P4 from being sent
 
@@ -555,15 +694,11 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
             if (record->event.pressed) {
                 volume_balance_running = !volume_balance_running;
                 if (volume_balance_running) {
-                    execute_bat_file("start_volume.bat");
-                    strcpy(volume_message, "Volume Balancer ON");
-                    volume_message_time = timer_read32();
-                    volume_showing_message = true;
+                    run_action(ACTION_VOLUME_START);
+                    toast_post_P(TOAST_VOLUME, PSTR("Volume Balancer ON"), NULL, 3000);
                 } else {
-                    execute_bat_file("kill_volume.bat");
-                    strcpy(volume_message, "Volume Balancer OFF");
-                    volume_message_time = timer_read32();
-                    volume_showing_message = true;
+                    run_action(ACTION_VOLUME_KILL);
+                    toast_post_P(TOAST_VOLUME, PSTR("Volume Balancer OFF"), NULL, 3000);
                 }
             }
             return false;  // Prevent KC_P5 from being sent
@@ -574,12 +709,10 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 uint8_t mode = rgblight_get_mode();
                 // Mode numbers start at 1, array starts at 0
                 if (mode >= 1 && mode <= NUM_RGB_MODES) {
-                    snprintf(rgb_message, sizeof(rgb_message), "LED: %s", rgb_mode_names[mode - 1]);
+                    toast_named(TOAST_RGB, PSTR("LED: "), rgb_mode_names[mode - 1]);
                 } else {
-                    strcpy(rgb_message, "LED Mode Changed");
+                    toast_post_P(TOAST_RGB, PSTR("LED Mode Changed"), NULL, 3000);
                 }
-                rgb_message_time = timer_read32();
-                rgb_showing_message = true;
             }
             return false;  // Prevent '8' from being sent
 
@@ -601,19 +734,14 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 }
 
                 // Show color name on OLED
-                snprintf(rgb_message, sizeof(rgb_message), "Color: %s", rgb_color_names[current_color_index]);
-                rgb_message_time = timer_read32();
-                rgb_showing_message = true;
+                toast_named(TOAST_RGB, PSTR("Color: "), rgb_color_names[current_color_index]);
             }
             return false;  // Prevent '9' from being sent
 
         case KC_P1:  // Encoder 2 button - Mute/unmute only
             if (record->event.pressed && discord_control_running) {
                 // Send mute/unmute command for selected user
-                uint8_t data[32] = {0};
-                data[0] = 0xF2;  // Discord command identifier
-                data[1] = 0x03;  // 0x03 = Mute/unmute command
-                raw_hid_send(data, sizeof(data));
+                encoder_batch_button(HID_OP_DISCORD);
             }
             return false;  // Prevent KC_P1 from being sent
 
@@ -622,30 +750,24 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 discord_control_running = !discord_control_running;
                 if (discord_control_running) {
                     // Start Discord bot
-                    execute_bat_file("start_discord.bat");
-                    strcpy(discord_message, "DICTATOR MODE ON");
-                    discord_message_time = timer_read32();
-                    discord_showing_message = true;
+                    run_action(ACTION_DISCORD_BOT_START);
+                    toast_post_P(TOAST_DISCORD, PSTR("DICTATOR MODE ON"), NULL, 3000);
                     discord_user_index = 0;
                     discord_user_total = 0;
                     strcpy(discord_user, "Starting...");
                 } else {
                     // Stop Discord bot
-                    execute_bat_file("kill_discord.bat");
-                    strcpy(discord_message, "DEMOCRACY RESTORED");
-                    discord_message_time = timer_read32();
-                    discord_showing_message = true;  // Keep showing Discord display for shutdown message
+                    run_action(ACTION_DISCORD_BOT_KILL);
+                    toast_post_P(TOAST_DISCORD, PSTR("DEMOCRACY RESTORED"), NULL, 3000);
                 }
+                oled_view_touch(VIEW_SRC_DISCORD);
             }
             return false;  // Prevent KC_P2 from being sent
 
         case KC_P0:  // Encoder 3 button - Toggle LIFX lamp on/off
             if (record->event.pressed) {
                 // Send toggle command to LIFX control script
-                uint8_t data[32] = {0};
-                data[0] = 0xF3;  // LIFX command identifier
-                data[1] = 0x03;  // 0x03 = Toggle lamp on/off command
-                raw_hid_send(data, sizeof(data));
+                encoder_batch_button(HID_OP_LIFX);
             }
             return false;  // Prevent KC_P0 from being sent
 
@@ -654,10 +776,10 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 lifx_control_running = !lifx_control_running;
                 if (lifx_control_running) {
                     // Start LIFX control script
-                    execute_bat_file("start_lifx.bat");
+                    run_action(ACTION_LIFX_START);
                 } else {
                     // Stop LIFX control script
-                    execute_bat_file("kill_lifx.bat");
+                    run_action(ACTION_LIFX_KILL);
                 }
             }
             return false;
@@ -668,21 +790,23 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
                 if (monitoring_active) {
                     // Start monitoring - begin 5 second startup phase
                     monitoring_startup = true;
-                    monitoring_start_time = timer_read32();
-                    execute_bat_file("start_monitor.bat");
-                    last_app = "Monitoring";
+                    monitoring_dots = 0;
+                    deadline_set(DEADLINE_MONITOR_STARTUP, 1000, monitoring_tick);
+                    run_app(APP_MONITOR, true);
+                    last_app = APP_MONITOR;
+                    oled_view_touch(VIEW_SRC_APP);
                     // Cancel any pending encoder rotation action
-                    pending_action = false;
+                    deadline_cancel(DEADLINE_APP_COMMIT);
                 } else {
                     // Stop monitoring
                     monitoring_startup = false;
-                    execute_bat_file("kill_monitor.bat");
-                    last_app = "Idle";
+                    deadline_cancel(DEADLINE_MONITOR_STARTUP);
+                    run_app(APP_MONITOR, false);
+                    last_app = APP_IDLE;
+                    oled_view_touch(VIEW_SRC_APP);
                     // Reset monitoring data
-                    cpu_load = 0;
-                    gpu_load = 0;
-                    fps = 0;
-                    ping = 0;
+                    telemetry_reset();
+                    oled_view_touch(VIEW_SRC_MONITOR);
                 }
             }
             return false;
@@ -690,8 +814,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
     return true;
 }
 
-// Custom encoder rotation handler
-bool encoder_update_user(uint8_t index, bool clockwise) {
+static bool encoder_update_app(uint8_t index, bool clockwise) {
     if (index == 0) { // First encoder - app control
         // Don't process rotation if monitoring is active
         if (monitoring_active) {
@@ -701,58 +824,53 @@ bool encoder_update_user(uint8_t index, bool clockwise) {
         // Update mode based on direction
         if (clockwise) {
             current_mode = MODE_START;
-            // Cycle through start apps
+            // Cycle through the wheel apps
             app_index++;
-            if (app_index >= NUM_START_APPS) {
+            if (app_index >= APP_WHEEL_COUNT) {
                 app_index = 0;
             }
-            last_app = start_apps[app_index];
         } else {
             current_mode = MODE_KILL;
-            // Cycle through kill apps
+            // Cycle through the wheel apps
             app_index++;
-            if (app_index >= NUM_KILL_APPS) {
+            if (app_index >= APP_WHEEL_COUNT) {
                 app_index = 0;
             }
-            last_app = kill_apps[app_index];
         }
+        last_app = (app_id_t)app_index;  // Wheel apps come first in app_table.h
+        oled_view_touch(VIEW_SRC_APP);
 
-        // Mark that we have a pending action and reset timer
-        pending_action = true;
-        last_encoder_time = timer_read32();
+        // Act on the app shown once the wheel rests for 2 seconds
+        deadline_set(DEADLINE_APP_COMMIT, 2000, app_commit);
 
         return false; // Skip default encoder behavior
     }
     else if (index == 1) { // Second encoder - volume balancing
-        // Send HID RAW command for volume control
-        uint8_t data[32] = {0};
-        data[0] = 0xF1;  // Volume command identifier
-        data[1] = clockwise ? 0x01 : 0x02;  // 0x01=CW (game up), 0x02=CCW (discord up)
-
-        raw_hid_send(data, sizeof(data));
+        // Batched HID RAW delta for volume control (CW = game up, CCW = discord up)
+        encoder_batch_add(HID_OP_VOLUME, clockwise);
         return false;
     }
     else if (index == 2) { // Third encoder - Discord voice control
-        // Send HID RAW command for Discord user cycling
-        uint8_t data[32] = {0};
-        data[0] = 0xF2;  // Discord command identifier
-        data[1] = clockwise ? 0x01 : 0x02;  // 0x01=CW (next user), 0x02=CCW (prev user)
-
-        raw_hid_send(data, sizeof(data));
+        // Batched HID RAW delta for Discord user cycling (CW = next user, CCW = previous)
+        encoder_batch_add(HID_OP_DISCORD, clockwise);
         return false;
     }
     else if (index == 3) { // Fourth encoder - LIFX lamp brightness
-        // Send HID RAW command for LIFX brightness control
-        uint8_t data[32] = {0};
-        data[0] = 0xF3;  // LIFX command identifier
-        data[1] = clockwise ? 0x01 : 0x02;  // 0x01=CW (brightness up), 0x02=CCW (brightness down)
-
-        raw_hid_send(data, sizeof(data));
+        // Batched HID RAW delta for LIFX brightness control (CW = brighter)
+        encoder_batch_add(HID_OP_LIFX, clockwise);
         return false;
     }
     return true; // Continue with default behavior for other encoders
 }
 
+// Custom encoder rotation handler
+bool encoder_update_user(uint8_t index, bool clockwise) {
+    perf_time_t start = perf_now();
+    bool        result = encoder_update_app(index, clockwise);
+    perf_record(PERF_ENCODER, start);
+    return result;
+}
+
 // Initialize keyboard
 void keyboard_post_init_user(void) {
     // Set RGB LED brightness to 100% (255 out of 255)
@@ -760,332 +878,137 @@ void keyboard_post_init_user(void) {
     rgblight_enable();  // Ensure RGB is enabled
 }
 
-// Matrix scan for 2-second timeout and monitoring startup
+// Matrix scan: queued keystrokes and the timeouts in deadline.h
 void matrix_scan_user(void) {
-    // Handle pending app launch/kill actions (only when not monitoring)
-    if (pending_action && !monitoring_active) {
-        // Check if 2 seconds have elapsed since last encoder turn
-        if (timer_elapsed32(last_encoder_time) >= 2000) {
-            // Execute the appropriate bat file
-            if (current_mode == MODE_START) {
-                execute_bat_file(start_bat_files[app_index]);
-            } else {
-                execute_bat_file(kill_bat_files[app_index]);
-            }
+    // Type at most one keystroke of any queued Run dialog command
+    macro_queue_task();
+    // App commit, monitoring startup, power actions, host action timeout,
+    // toast expiry, encoder batch windows, button report resends
+    deadline_task();
+}
 
-            // Clear pending action and reset to idle
-            pending_action = false;
-            app_index = -1;
-            last_app = "Idle";
-        }
-    }
-    
-    // Handle monitoring startup phase (5 seconds)
-    if (monitoring_startup && monitoring_active) {
-        if (timer_elapsed32(monitoring_start_time) >= 5000) {
-            // 5 seconds elapsed, exit startup phase
-            monitoring_startup = false;
-        }
-    }
+#ifdef OLED_ENABLE
+// Screens drawn by oled_task_user()
+enum oled_screen {
+    SCREEN_TOAST = 0,
+    SCREEN_MONITOR_STARTUP,
+    SCREEN_MONITOR,
+    SCREEN_DISCORD,
+    SCREEN_APP
+};
 
-    // Handle power action timeout (5 seconds)
-    if (power_action_pending != 0) {
-        if (timer_elapsed32(power_action_time) >= 5000) {
-            // 5 seconds elapsed - execute action
-            if (power_action_pending == 1) {
-                // Shutdown
-                tap_code16(LGUI(KC_R));
-                wait_ms(150);
-                tap_code16(LCTL(KC_A));
-                wait_ms(50);
-                send_string("shutdown /s /t 0");
-                wait_ms(50);
-                tap_code(KC_ENT);
-            } else if (power_action_pending == 2) {
-                // Hibernate
-                tap_code16(LGUI(KC_R));
-                wait_ms(150);
-                tap_code16(LCTL(KC_A));
-                wait_ms(50);
-                send_string("shutdown /h");
-                wait_ms(50);
-                tap_code(KC_ENT);
-            } else if (power_action_pending == 3) {
-                // Restart
-                tap_code16(LGUI(KC_R));
-                wait_ms(150);
-                tap_code16(LCTL(KC_A));
-                wait_ms(50);
-                send_string("shutdown /r /t 0");
-                wait_ms(50);
-                tap_code(KC_ENT);
-            }
-            // Clear pending action
-            power_action_pending = 0;
-            power_action_time = 0;
-            power_showing_message = false;
-        }
-    }
+// Toasts each mode shows: power toasts cover everything, Discord toasts
+// cover the Discord screen, which in turn holds back the other toasts while
+// the bot runs; held-back toasts wait, their clocks stopped
+static uint8_t visible_toasts(void) {
+    if (monitoring_active) return TOAST_BIT(TOAST_POWER);
+    if (discord_control_running) return TOAST_BIT(TOAST_POWER) | TOAST_BIT(TOAST_DISCORD);
+    return TOAST_ALL;
 }
 
-#ifdef OLED_ENABLE
-// Custom OLED display - show app name in large format across whole screen
-bool oled_task_user(void) {
-    // State tracking for clearing only when needed (prevents flickering)
-    static bool last_monitoring_active = false;
-    static bool last_monitoring_startup = false;
-    static bool last_discord_active = false;
-    static bool last_lifx_active = false;
-    static bool last_volume_active = false;
-    static bool last_rgb_active = false;
-    static bool last_power_active = false;
+static uint8_t current_oled_screen(void) {
+    if (toast_top()) return SCREEN_TOAST;
+    if (monitoring_active) return monitoring_startup ? SCREEN_MONITOR_STARTUP : SCREEN_MONITOR;
+    if (discord_control_running) return SCREEN_DISCORD;
+    return SCREEN_APP;
+}
+
+// Data sources each screen shows; a touch on one of them redraws the screen
+static const uint8_t PROGMEM screen_sources[] = {
+    [SCREEN_TOAST]           = VIEW_SRC_BIT(VIEW_SRC_MESSAGE),
+    [SCREEN_MONITOR_STARTUP] = VIEW_SRC_BIT(VIEW_SRC_MONITOR),
+    [SCREEN_MONITOR]         = VIEW_SRC_BIT(VIEW_SRC_MONITOR),
+    [SCREEN_DISCORD]         = VIEW_SRC_BIT(VIEW_SRC_DISCORD),
+    [SCREEN_APP]             = VIEW_SRC_BIT(VIEW_SRC_APP),
+};
+
+// "CPU:  42%": label, the metric right-aligned in 3 columns, unit
+static void render_metric(uint8_t line, const char *label_P, uint8_t metric, const char *unit_P) {
+    char  buf[OLED_VIEW_COLS + 1];
+    char *p = fmt_P(buf, label_P);
+    p = fmt_uint(p, telemetry_get(metric), 3);
+    fmt_P(p, unit_P);
+    oled_view_line(line, buf);
+}
 
+// The front toast on line 1 (and its second line on line 2), the other lines blank
+static void render_toast(const toast_t *toast) {
+    oled_view_line_P(0, PSTR(""));
+    oled_view_line(1, toast->text);
+    oled_view_line_P(2, toast->detail_P ? toast->detail_P : PSTR(""));
+    oled_view_line_P(3, PSTR(""));
+}
+
+// Custom OLED display - show app name in large format across whole screen.
+// Only screens whose data changed are redrawn, and oled_view only sends the
+// characters that differ from what is already on the display.
+bool oled_task_user(void) {
     // Clear display on first run only
     if (!oled_initialized) {
-        oled_clear();
+        oled_view_invalidate();
         oled_initialized = true;
     }
 
-    // Check if we need to clear the display (only on state changes)
-    bool should_clear = false;
-    bool current_discord_display = discord_control_running || discord_showing_message;
-    if (monitoring_active != last_monitoring_active || current_discord_display != last_discord_active ||
-        lifx_showing_message != last_lifx_active || volume_showing_message != last_volume_active ||
-        rgb_showing_message != last_rgb_active || power_showing_message != last_power_active) {
-        should_clear = true;  // Mode changed
-    } else if (monitoring_active && (monitoring_startup != last_monitoring_startup)) {
-        should_clear = true;  // Within monitoring, startup phase changed
-    }
-
-    if (should_clear) {
-        oled_clear();
-    }
-
-    // Update state tracking
-    last_monitoring_active = monitoring_active;
-    last_monitoring_startup = monitoring_startup;
-    last_discord_active = current_discord_display;
-    last_lifx_active = lifx_showing_message;
-    last_volume_active = volume_showing_message;
-    last_rgb_active = rgb_showing_message;
-    last_power_active = power_showing_message;
-
-    // Priority 1: Power confirmation messages (highest priority)
-    if (power_showing_message) {
-        char buf[22];
-
-        // Check if cancellation message should clear after 3 seconds
-        if (power_action_pending == 0 && power_action_time != 0 && timer_elapsed32(power_action_time) >= 3000) {
-            // Clear cancellation message after 3 seconds
-            power_message[0] = '\0';
-            power_message2[0] = '\0';
-            power_action_time = 0;
-            power_showing_message = false;
-            oled_clear();
-            render_large_text(last_app);
-        } else {
-            // Show power confirmation message (two lines)
-            oled_set_cursor(0, 0);
-            oled_write_P(PSTR("                     "), false);
-
-            oled_set_cursor(0, 1);
-            snprintf(buf, sizeof(buf), "%-21s", power_message);
-            oled_write(buf, false);
+    toast_task(visible_toasts());
 
-            oled_set_cursor(0, 2);
-            snprintf(buf, sizeof(buf), "%-21s", power_message2);
-            oled_write(buf, false);
+    uint8_t screen = current_oled_screen();
 
-            oled_set_cursor(0, 3);
-            oled_write_P(PSTR("                     "), false);
-        }
+    if (!oled_view_begin(screen, pgm_read_byte(&screen_sources[screen]))) {
+        return false;  // Nothing on screen changed
     }
-    // Priority 2: If in monitoring mode
-    else if (monitoring_active) {
-        if (monitoring_startup) {
-            // Show "Monitoring" with dots based on elapsed time
-            uint32_t elapsed = timer_elapsed32(monitoring_start_time);
-            uint8_t dots = (elapsed / 1000);  // 1 dot per second
-            if (dots > 5) dots = 5;
-
-            oled_set_cursor(0, 1);  // Center vertically
-            oled_write_P(PSTR("  Monitoring"), false);
-            for (uint8_t i = 0; i < dots; i++) {
-                oled_write_P(PSTR("."), false);
-            }
-        } else {
-            // Show system stats
-            char buf[22];
-
-            // Line 0: CPU
-            oled_set_cursor(0, 0);
-            snprintf(buf, sizeof(buf), "CPU: %3d%%", cpu_load);
-            oled_write(buf, false);
-
-            // Line 1: GPU
-            oled_set_cursor(0, 1);
-            snprintf(buf, sizeof(buf), "GPU: %3d%%", gpu_load);
-            oled_write(buf, false);
-
-            // Line 2: GPU Memory (VRAM)
-            oled_set_cursor(0, 2);
-            snprintf(buf, sizeof(buf), "MEM: %3d%%", fps);
-            oled_write(buf, false);
-
-            // Line 3: Ping
-            oled_set_cursor(0, 3);
-            snprintf(buf, sizeof(buf), "MS : %3dms", ping);
-            oled_write(buf, false);
-        }
-    } else if (discord_control_running || discord_showing_message) {
-        // Discord voice control mode - show selected user or temporary message
-        char buf[22];
-
-        // Check if we have a temporary message to show (within 3 seconds)
-        static bool last_showing_temp = false;
-        bool show_temp_message = false;
-        if (discord_message_time != 0 && timer_elapsed32(discord_message_time) < 3000) {
-            show_temp_message = true;
-        } else if (discord_message_time != 0) {
-            // Clear message after 3 seconds
-            discord_message[0] = '\0';
-            discord_message_time = 0;
-            discord_showing_message = false;
-            oled_clear();  // Clear when transitioning from temp message
-        }
 
-        // Clear display when switching between temp and normal
-        if (show_temp_message != last_showing_temp) {
-            oled_clear();
+    char buf[22];
+    switch (screen) {
+        case SCREEN_TOAST:
+            // Power confirmation, script status, mute status, LED mode...
+            render_toast(toast_top());
+            break;
+
+        case SCREEN_MONITOR_STARTUP: {
+            // Show "Monitoring" with a dot per second (monitoring_tick)
+            strcpy(buf, "  Monitoring");
+            memset(buf + 12, '.', monitoring_dots);
+            buf[12 + monitoring_dots] = '\0';
+
+            oled_view_line_P(0, PSTR(""));
+            oled_view_line(1, buf);  // Center vertically
+            oled_view_line_P(2, PSTR(""));
+            oled_view_line_P(3, PSTR(""));
+            break;
         }
-        last_showing_temp = show_temp_message;
 
-        if (show_temp_message) {
-            // Show temporary message (startup/shutdown/mute status)
-            // Clear all lines with padding
-            oled_set_cursor(0, 0);
-            oled_write_P(PSTR("                     "), false);
-
-            oled_set_cursor(0, 1);
-            snprintf(buf, sizeof(buf), "%-21s", discord_message);
-            oled_write(buf, false);
-
-            oled_set_cursor(0, 2);
-            oled_write_P(PSTR("                     "), false);
+        case SCREEN_MONITOR:
+            // Show system stats
+            render_metric(0, PSTR("CPU: "), HID_METRIC_CPU, PSTR("%"));
+            render_metric(1, PSTR("GPU: "), HID_METRIC_GPU, PSTR("%"));
+            // GPU Memory (VRAM)
+            render_metric(2, PSTR("MEM: "), HID_METRIC_GPU_MEM, PSTR("%"));
+            render_metric(3, PSTR("MS : "), HID_METRIC_PING, PSTR("ms"));
+            break;
 
-            oled_set_cursor(0, 3);
-            oled_write_P(PSTR("                     "), false);
-        } else {
-            // Show normal Discord user info
-            // Line 0: Title (pad to 21 chars)
-            oled_set_cursor(0, 0);
-            oled_write_P(PSTR("Discord Voice        "), false);
+        case SCREEN_DISCORD:
+            // Normal Discord user info
+            oled_view_line_P(0, PSTR("Discord Voice"));
 
-            // Line 1: User count (pad to 21 chars)
-            oled_set_cursor(0, 1);
             if (discord_user_total > 0) {
-                snprintf(buf, sizeof(buf), "[%d/%d]                  ", discord_user_index + 1, discord_user_total);
+                char *p = fmt_P(buf, PSTR("["));
+                p = fmt_uint(p, discord_user_index + 1, 0);
+                p = fmt_P(p, PSTR("/"));
+                p = fmt_uint(p, discord_user_total, 0);
+                fmt_P(p, PSTR("]"));
+                oled_view_line(1, buf);
             } else {
-                snprintf(buf, sizeof(buf), "No users             ");
+                oled_view_line_P(1, PSTR("No users"));
             }
-            oled_write(buf, false);
-
-            // Line 2: Username (pad to 21 chars)
-            oled_set_cursor(0, 2);
-            snprintf(buf, sizeof(buf), "%-21s", discord_user);
-            oled_write(buf, false);
-
-            // Line 3: Clear it (pad to 21 chars)
-            oled_set_cursor(0, 3);
-            oled_write_P(PSTR("                     "), false);
-        }
-    } else if (lifx_showing_message) {
-        // LIFX status message mode - show message for 5 seconds then return to logo
-        char buf[22];
-
-        // Check if we should still show the message (within 5 seconds)
-        if (lifx_message_time != 0 && timer_elapsed32(lifx_message_time) < 5000) {
-            // Show LIFX status message
-            oled_set_cursor(0, 0);
-            oled_write_P(PSTR("                     "), false);
-
-            oled_set_cursor(0, 1);
-            snprintf(buf, sizeof(buf), "%-21s", lifx_message);
-            oled_write(buf, false);
-
-            oled_set_cursor(0, 2);
-            oled_write_P(PSTR("                     "), false);
-
-            oled_set_cursor(0, 3);
-            oled_write_P(PSTR("                     "), false);
-        } else {
-            // Clear message after 5 seconds and return to logo
-            lifx_message[0] = '\0';
-            lifx_message_time = 0;
-            lifx_showing_message = false;
-            oled_clear();
-            // Show logo
-            render_large_text(last_app);
-        }
-    } else if (volume_showing_message) {
-        // Volume balancer status message mode - show message for 3 seconds then return to logo
-        char buf[22];
-
-        // Check if we should still show the message (within 3 seconds)
-        if (volume_message_time != 0 && timer_elapsed32(volume_message_time) < 3000) {
-            // Show volume balancer status message
-            oled_set_cursor(0, 0);
-            oled_write_P(PSTR("                     "), false);
-
-            oled_set_cursor(0, 1);
-            snprintf(buf, sizeof(buf), "%-21s", volume_message);
-            oled_write(buf, false);
-
-            oled_set_cursor(0, 2);
-            oled_write_P(PSTR("                     "), false);
-
-            oled_set_cursor(0, 3);
-            oled_write_P(PSTR("                     "), false);
-        } else {
-            // Clear message after 3 seconds and return to logo
-            volume_message[0] = '\0';
-            volume_message_time = 0;
-            volume_showing_message = false;
-            oled_clear();
-            // Show logo
-            render_large_text(last_app);
-        }
-    } else if (rgb_showing_message) {
-        // RGB LED status message mode - show message for 3 seconds then return to logo
-        char buf[22];
-
-        // Check if we should still show the message (within 3 seconds)
-        if (rgb_message_time != 0 && timer_elapsed32(rgb_message_time) < 3000) {
-            // Show RGB status message
-            oled_set_cursor(0, 0);
-            oled_write_P(PSTR("                     "), false);
-
-            oled_set_cursor(0, 1);
-            snprintf(buf, sizeof(buf), "%-21s", rgb_message);
-            oled_write(buf, false);
 
-            oled_set_cursor(0, 2);
-            oled_write_P(PSTR("                     "), false);
+            oled_view_line(2, discord_user);
+            oled_view_line_P(3, PSTR(""));
+            break;
 
-            oled_set_cursor(0, 3);
-            oled_write_P(PSTR("                     "), false);
-        } else {
-            // Clear message after 3 seconds and return to logo
-            rgb_message[0] = '\0';
-            rgb_message_time = 0;
-            rgb_showing_message = false;
-            oled_clear();
-            // Show logo
-            render_large_text(last_app);
-        }
-    } else {
-        // Normal mode - render large text filling the screen
-        render_large_text(last_app);
+        default:
+            // Normal mode - render large text filling the screen
+            render_app(last_app);
+            break;
     }
 
     return false;  // Return false to prevent oled_task_kb from running
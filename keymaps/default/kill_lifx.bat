@@ -1,3 +1,4 @@
 @echo off
-taskkill /F /FI "WINDOWTITLE eq *lifx_control.py*" >nul 2>&1
-taskkill /F /FI "COMMANDLINE eq *lifx_control.py*" >nul 2>&1
+REM Stop lifx_control.py only; other Python scripts keep running
+powershell -NoProfile -Command "Get-CimInstance Win32_Process -Filter \"(Name='pythonw.exe' OR Name='python.exe') AND CommandLine LIKE '%%lifx_control.py%%'\" | Invoke-CimMethod -MethodName Terminate" >nul 2>&1
+exit
@@ -1,4 +1,4 @@
 @echo off
-taskkill /F /IM pythonw.exe >nul 2>&1
-taskkill /F /IM python.exe /FI "WINDOWTITLE eq System Monitor*" >nul 2>&1
-exit
\ No newline at end of file
+REM Stop system_monitor_hid.py only; other Python scripts keep running
+powershell -NoProfile -Command "Get-CimInstance Win32_Process -Filter \"(Name='pythonw.exe' OR Name='python.exe') AND CommandLine LIKE '%%system_monitor_hid.py%%'\" | Invoke-CimMethod -MethodName Terminate" >nul 2>&1
+exit
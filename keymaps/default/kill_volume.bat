@@ -1,4 +1,4 @@
 @echo off
-REM Kill all pythonw.exe processes (background Python processes)
-taskkill /F /IM pythonw.exe >nul 2>&1
+REM Stop volume_balance.py only; other Python scripts keep running
+powershell -NoProfile -Command "Get-CimInstance Win32_Process -Filter \"(Name='pythonw.exe' OR Name='python.exe') AND CommandLine LIKE '%%volume_balance.py%%'\" | Invoke-CimMethod -MethodName Terminate" >nul 2>&1
 exit
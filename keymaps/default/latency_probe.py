@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+Background network latency prober for the TIDBIT system monitor
+
+LatencyProbe times a TCP connect to a target (default 8.8.8.8:53, Google
+DNS) once per interval on its own thread. The handshake round trip is the
+same as an ICMP echo's, but needs no raw socket, no privileges and no
+ping subprocess, and works the same on Windows and Linux. A refused
+connection still answers, so it counts as a reply; a timeout counts as a
+lost probe.
+
+Results go into a sliding window of the last WINDOW probes; snapshot()
+returns its RTT min/avg/p95, jitter and loss without waiting on the network.
+
+    python latency_probe.py                      # probe 8.8.8.8:53 and print snapshots
+    python latency_probe.py --target host:port
+    python latency_probe.py --local              # probe a listener on 127.0.0.1
+"""
+
+import collections
+import socket
+import sys
+import threading
+import time
+
+DEFAULT_TARGET = ('8.8.8.8', 53)
+INTERVAL = 1.0   # Seconds between probes
+TIMEOUT = 1.0    # Seconds before a probe counts as lost
+WINDOW = 30      # Probes in the sliding window
+
+# Statistics over the window, in ms. last is the latest probe, None if it
+# was lost; the others are None until a probe has been answered.
+Snapshot = collections.namedtuple('Snapshot', 'last min avg p95 jitter loss sent')
+EMPTY = Snapshot(None, None, None, None, None, 0.0, 0)
+
+
+def tcp_rtt(target, timeout=TIMEOUT):
+    """Seconds taken by a TCP handshake (or refusal) with target, None if lost"""
+    host, port = target
+    try:
+        infos = socket.getaddrinfo(host, port, type=socket.SOCK_STREAM)
+    except socket.gaierror:
+        return None
+    family, kind, proto, _, address = infos[0]
+    sock = socket.socket(family, kind, proto)
+    sock.settimeout(timeout)
+    started = time.perf_counter()
+    try:
+        sock.connect(address)
+    except ConnectionRefusedError:
+        pass  # The host answered with a reset, which is a round trip too
+    except OSError:
+        return None
+    finally:
+        sock.close()
+    return time.perf_counter() - started
+
+
+def summarize(rtts, sent):
+    """Snapshot of a window; rtts are seconds, None for lost probes"""
+    answered = [r * 1000 for r in rtts if r is not None]
+    if not answered:
+        return Snapshot(None, None, None, None, None, 100.0 if sent else 0.0, sent)
+    ordered = sorted(answered)
+    # Mean difference between consecutive answered probes (RFC 3550 style)
+    diffs = [abs(b - a) for a, b in zip(answered, answered[1:])]
+    return Snapshot(
+        last=rtts[-1] * 1000 if rtts[-1] is not None else None,
+        min=ordered[0],
+        avg=sum(answered) / len(answered),
+        p95=ordered[min(len(ordered) - 1, (len(ordered) * 95 + 99) // 100 - 1)],
+        jitter=sum(diffs) / len(diffs) if diffs else 0.0,
+        loss=100.0 * (len(rtts) - len(answered)) / len(rtts),
+        sent=sent,
+    )
+
+
+class LatencyProbe:
+    """Probes a target in the background and keeps window statistics
+
+    Args:
+        target: (host, port) to time TCP connects to
+        interval: seconds between probes
+        timeout: seconds before a probe is lost (at most interval)
+        window: probes kept for the statistics
+        measure: callable(target, timeout) -> seconds or None, tcp_rtt by default
+    """
+
+    def __init__(self, target=DEFAULT_TARGET, interval=INTERVAL, timeout=TIMEOUT,
+                 window=WINDOW, measure=tcp_rtt):
+        self.target = target
+        self.interval = interval
+        self.timeout = min(timeout, interval)
+        self.measure = measure
+        self.rtts = collections.deque(maxlen=window)
+        self.sent = 0
+        self._snapshot = EMPTY
+        self.stopping = threading.Event()
+        self.thread = None
+
+    def start(self):
+        self.thread = threading.Thread(target=self._run, name="latency-probe", daemon=True)
+        self.thread.start()
+        return self
+
+    def stop(self):
+        self.stopping.set()
+        if self.thread:
+            self.thread.join(self.interval + self.timeout)
+
+    def snapshot(self):
+        """Latest window statistics; never blocks"""
+        return self._snapshot
+
+    def probe(self):
+        """Run one probe now and update the statistics"""
+        rtt = self.measure(self.target, self.timeout)
+        self.rtts.append(rtt)
+        self.sent += 1
+        # Replaced whole, so readers on other threads need no lock
+        self._snapshot = summarize(list(self.rtts), self.sent)
+        return rtt
+
+    def _run(self):
+        next_probe = time.monotonic()
+        while not self.stopping.is_set():
+            self.probe()
+            next_probe += self.interval
+            now = time.monotonic()
+            if next_probe < now:
+                next_probe = now + self.interval
+            self.stopping.wait(next_probe - now)
+
+
+def parse_target(text):
+    host, _, port = text.rpartition(':')
+    return host.strip('[]'), int(port)
+
+
+def _local_listener():
+    """Listening socket on 127.0.0.1 that accepts and drops connections"""
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.bind(('127.0.0.1', 0))
+    listener.listen()
+
+    def accept():
+        while True:
+            try:
+                conn, _ = listener.accept()
+            except OSError:
+                return
+            conn.close()
+
+    threading.Thread(target=accept, daemon=True).start()
+    return listener
+
+
+def _fmt(value):
+    return "   -  " if value is None else f"{value:6.2f}"
+
+
+def main():
+    target = DEFAULT_TARGET
+    if "--local" in sys.argv:
+        target = _local_listener().getsockname()
+    elif "--target" in sys.argv:
+        target = parse_target(sys.argv[sys.argv.index("--target") + 1])
+
+    print(f"Probing {target[0]}:{target[1]} every {INTERVAL:g} s (Ctrl+C to stop)")
+    probe = LatencyProbe(target).start()
+    try:
+        while True:
+            time.sleep(INTERVAL)
+            s = probe.snapshot()
+            print(f"last {_fmt(s.last)}  min {_fmt(s.min)}  avg {_fmt(s.avg)}  p95 {_fmt(s.p95)}  "
+                  f"jitter {_fmt(s.jitter)} ms  loss {s.loss:5.1f}%  ({s.sent} sent)")
+    except KeyboardInterrupt:
+        probe.stop()
+
+
+if __name__ == "__main__":
+    main()
@@ -9,176 +9,145 @@ Encoder 3 Controls (KC_P0):
   Button press = Toggle lamp on/off
 
 Setup:
-1. Install lifxlan: pip install lifxlan
-2. Ensure LIFX lamp is on the same network
-3. Run this script, it will auto-discover your LIFX lamp
+1. Ensure LIFX lamp is on the same network
+2. Run this script, it will auto-discover your LIFX lamp (and remember
+   its address in lifx_cache.json for the next launch)
+
+Brightness and power are kept in a local model of the lamp (lifx_lan.Lamp)
+and sent in the background without waiting for the lamp to answer, so a
+detent never waits on the network.
+
+    python lifx_control.py          # control the "Desk Light" lamp
+    python lifx_control.py --fake   # control a fake lamp on 127.0.0.1
+
+supervisor.py runs serve() on a thread of its own instead of main().
 """
 
-import hid
-import time
-from lifxlan import LifxLAN
+import sys
+import threading
 
-# QMK HID RAW settings
-VID = 0x6E61  # OffReno keyboard vendor ID
-PID = 0x6064  # OffReno keyboard product ID
+from display_channel import DisplayChannel
+from hid_client import HidClient
+from hid_protocol import (HID_OP_LIFX, HID_OP_VERSION, HID_CMD_BUTTON, ReportAcker,
+                          lifx_status_report, check_version, encoder_steps)
+from lifx_lan import BROADCAST, CACHE_FILE, FakeBulb, Transport, find_lamp
+from trace_log import now_us, open_trace
 
 # LIFX settings
 BRIGHTNESS_STEP = 6553  # ~10% of 65535 max brightness
 MIN_BRIGHTNESS = 6553   # Minimum 10%
 MAX_BRIGHTNESS = 65535  # Maximum 100%
 
+LAMP_LABEL = "Desk Light"  # Only this lamp is controlled
+STOP_POLL_MS = 250  # How often serve() checks whether it should stop
+
 # Global state
-lifx = None
 lamp = None
-current_brightness = 32768  # Start at ~50%
-
-def find_keyboard():
-    """Find the OffReno keyboard RAW HID interface"""
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            # QMK RAW HID uses usage_page 0xFF60 and usage 0x61
-            if device.get('usage_page') == 0xFF60 and device.get('usage') == 0x61:
-                print(f"Found RAW HID interface: {device.get('interface_number', 'N/A')}")
-                return device['path']
-
-    # Fallback
-    print("RAW HID interface not found by usage page, trying fallback...")
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            print(f"Using interface: {device.get('interface_number', 'N/A')}")
-            return device['path']
-
-    return None
-
-def send_status_to_oled(keyboard, message):
-    """Send LIFX status message to keyboard for OLED display"""
-    # Format: [report_id, 0xF3, 0x04, message_bytes...]
-    data = [0] * 33  # 33 bytes: 1 for report ID + 32 for data
-    data[0] = 0x00  # Report ID (required for HID)
-    data[1] = 0xF3  # LIFX command identifier
-    data[2] = 0x04  # Status message command
-
-    # Encode message (max 27 bytes to fit in remaining space)
-    message_bytes = message[:27].encode('utf-8')
-    for i, byte in enumerate(message_bytes):
-        data[3 + i] = byte
-
-    keyboard.write(bytes(data))
-
-def discover_lifx_lamp(keyboard):
-    """Discover LIFX lamp on network - only connect to 'Desk Light'"""
-    global lifx, lamp
-
-    lifx = LifxLAN()  # Discover all lamps
-    devices = lifx.get_lights()
-
-    if not devices:
-        send_status_to_oled(keyboard, "Could not find Lamp")
-        return False
 
-    # Filter for "Desk Light" only
-    for device in devices:
-        label = device.get_label()
-        if label == "Desk Light":
-            lamp = device
-            send_status_to_oled(keyboard, f"Found: {label}")
-
-            # Get current state
-            try:
-                power = lamp.get_power()
-                color = lamp.get_color()
-                brightness = color[2]  # HSBK format: [hue, saturation, brightness, kelvin]
-                return True
-            except Exception as e:
-                send_status_to_oled(keyboard, "Could not find Lamp")
-                return False
-
-    # "Desk Light" not found
-    send_status_to_oled(keyboard, "Could not find Lamp")
-    return False
+def send_status_to_oled(display, message):
+    """Post LIFX status message to the keyboard's OLED"""
+    display.post(lifx_status_report(message))
 
-def toggle_lamp():
-    """Toggle lamp on/off"""
-    global lamp
+def discover_lifx_lamp(display, broadcast=BROADCAST, cache_path=CACHE_FILE):
+    """Find the LIFX lamp on the network - only connect to 'Desk Light'
 
-    if not lamp:
-        return
+    The lamp's address is cached in lifx_cache.json, so only the first
+    launch (or one after the lamp changed address) broadcasts discovery.
+    """
+    global lamp
 
     try:
-        current_power = lamp.get_power()
-        new_power = 0 if current_power else 65535
-        lamp.set_power(new_power, duration=500)  # 500ms transition
-    except Exception as e:
-        pass
-
-def adjust_brightness(direction):
-    """Adjust lamp brightness
-
-    Args:
-        direction: 1 for increase (CW), -1 for decrease (CCW)
-    """
-    global lamp, current_brightness
+        lamp = find_lamp(Transport(), LAMP_LABEL, cache_path, broadcast)
+    except OSError:
+        lamp = None
 
     if not lamp:
-        return
+        send_status_to_oled(display, "Could not find Lamp")
+        return False
 
-    try:
-        # Get current color (HSBK format)
-        color = lamp.get_color()
-        hue, saturation, brightness, kelvin = color
+    lamp.start()
+    send_status_to_oled(display, f"Found: {lamp.label}")
+    return True
 
-        # Calculate new brightness
-        new_brightness = brightness + (BRIGHTNESS_STEP * direction)
-        new_brightness = max(MIN_BRIGHTNESS, min(MAX_BRIGHTNESS, new_brightness))
+def toggle_lamp():
+    """Toggle lamp on/off"""
+    if lamp:
+        lamp.toggle()
 
-        # Set new brightness
-        lamp.set_color([hue, saturation, new_brightness, kelvin], duration=100)
+def adjust_brightness(direction):
+    """Adjust lamp brightness on the local model; sent in the background
 
-        current_brightness = new_brightness
-    except:
-        pass
+    Args:
+        direction: signed steps, positive to increase (CW)
+    """
+    if lamp:
+        lamp.adjust_brightness(BRIGHTNESS_STEP * direction, MIN_BRIGHTNESS, MAX_BRIGHTNESS)
 
-def hid_listener():
-    """Listen for HID commands from keyboard"""
-    keyboard_path = find_keyboard()
-    if not keyboard_path:
-        return
+def serve(stop, broadcast=BROADCAST, cache_path=CACHE_FILE):
+    """Handle encoder 3 until stop (a threading.Event) is set
 
-    try:
-        keyboard = hid.device()
-        keyboard.open_path(keyboard_path)
-    except:
-        return
+    Returns early if the lamp is not found. Raises ConnectionError if the
+    HID broker connection is lost, OSError if it cannot be reached at the
+    start.
+    """
+    keyboard = HidClient([HID_OP_LIFX])
+    trace = open_trace("lifx")
+    check_version(keyboard, trace=trace, opcode=HID_OP_LIFX)
+    acker = ReportAcker(keyboard, HID_OP_LIFX).hello()
+    display = DisplayChannel(keyboard).start()
 
     # Discover LIFX lamp and send status to OLED
-    if not discover_lifx_lamp(keyboard):
+    if not discover_lifx_lamp(display, broadcast, cache_path):
+        display.close()
+        keyboard.close()
+        trace.close()
         return  # Exit if lamp not found
 
     try:
-        while True:
-            # Read HID data with timeout
-            data = keyboard.read(33, timeout_ms=100)
-
-            if data and len(data) > 0 and data[0] == 0xF3:  # LIFX command
-                command = data[1]
+        while not stop.is_set():
+            # Wait for the keyboard, waking up now and then to check stop
+            data = keyboard.read(33, timeout_ms=STOP_POLL_MS)
 
-                if command == 0x01:  # CW rotation - brightness up
-                    adjust_brightness(1)
+            if data and len(data) > 0 and data[0] == HID_OP_LIFX and acker.accept(data):  # LIFX command, not a resent copy
+                dispatched = now_us()
+                steps = encoder_steps(data)
 
-                elif command == 0x02:  # CCW rotation - brightness down
-                    adjust_brightness(-1)
+                if steps:  # Rotation - CW brighter, CCW dimmer
+                    adjust_brightness(steps)
 
-                elif command == 0x03:  # Button press - toggle on/off
+                elif data[1] == HID_CMD_BUTTON:  # Button press - toggle on/off
                     toggle_lamp()
 
-            time.sleep(0.01)  # Small delay to prevent CPU spinning
+                # Done once the lamp model has it; the datagram goes out in the background
+                trace.event(data, keyboard.received_us, dispatched, steps=steps)
 
-    except KeyboardInterrupt:
-        pass
+            elif data and data[0] == HID_OP_VERSION:  # Keyboard (re)connected, its OLED may be blank
+                display.reset()
+
+    except ConnectionError:
+        print("HID broker connection lost")
+        raise
     finally:
+        lamp.stop()
+        display.close()
         keyboard.close()
+        trace.close()
+
+def hid_listener(broadcast=BROADCAST, cache_path=CACHE_FILE):
+    """Listen for HID commands from keyboard until Ctrl+C"""
+    try:
+        serve(threading.Event(), broadcast, cache_path)
+    except (KeyboardInterrupt, OSError):
+        pass
 
 def main():
+    if "--fake" in sys.argv:
+        # Control a fake lamp on 127.0.0.1 instead of the LAN
+        bulb = FakeBulb(LAMP_LABEL)
+        print(f"Fake LIFX lamp at {bulb.address[0]}:{bulb.address[1]}")
+        hid_listener(broadcast=bulb.address, cache_path=None)
+        return
+
     # Start listening for commands (discovery happens inside)
     hid_listener()
 
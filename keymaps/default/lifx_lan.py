@@ -0,0 +1,466 @@
+#!/usr/bin/env python3
+"""
+LIFX LAN transport and local lamp model for lifx_control.py
+
+Talks the LIFX LAN protocol (UDP port 56700, 36-byte header plus payload)
+directly, for the few messages the lamp control needs:
+
+    LightGet -> LightState       hue/saturation/brightness/kelvin, power, label
+    SetColor, LightSetPower      sent without ack or response (fire and forget)
+
+Lamp keeps the bulb's state locally and applies encoder steps to it, so a
+detent costs no network round trip. A sender thread sends only the newest
+target state, at most RATE messages a second, and repeats the last one
+once after REPEAT_DELAY in case the datagram was lost. A background resync
+reads the bulb every RESYNC_INTERVAL to pick up changes made elsewhere
+(the phone app, a wall switch), unless the lamp was changed from here
+within the last RESYNC_GRACE seconds.
+
+find_lamp() asks the bulb recorded in the cache file first (one unicast
+LightGet) and only broadcasts discovery when it does not answer.
+
+FakeBulb is a LIFX bulb on a local UDP socket, with optional reply delay
+and packet loss, for running lifx_control.py and sim/lifx_bench.py without
+a lamp.
+
+    python lifx_lan.py                   # discover bulbs on the LAN and print their state
+"""
+
+import itertools
+import json
+import os
+import random
+import socket
+import struct
+import threading
+import time
+
+PORT = 56700
+BROADCAST = ('255.255.255.255', PORT)
+CACHE_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "lifx_cache.json")
+
+RATE = 20              # Set messages per second per lamp (LIFX's recommended maximum)
+REPEAT_DELAY = 0.3     # Seconds before the last target is sent once more
+RESYNC_INTERVAL = 30.0 # Seconds between background reads of the bulb
+RESYNC_GRACE = 2.0     # Seconds after a local change during which the bulb is not read back
+TIMEOUT = 0.5          # Seconds to wait for a reply
+RETRIES = 2
+
+# Message types
+GET_SERVICE = 2
+STATE_SERVICE = 3
+ACKNOWLEDGEMENT = 45
+LIGHT_GET = 101
+LIGHT_SET_COLOR = 102
+LIGHT_STATE = 107
+LIGHT_SET_POWER = 117
+LIGHT_STATE_POWER = 118
+
+# size, protocol/addressable/tagged, source, target, reserved, flags, sequence,
+# reserved, type, reserved
+_HEADER = struct.Struct('<HHI8s6sBBQHH')
+_PROTOCOL = 1024
+_ADDRESSABLE = 1 << 12
+_TAGGED = 1 << 13
+_RES_REQUIRED = 1
+_ACK_REQUIRED = 2
+
+_SET_COLOR = struct.Struct('<B4HI')          # reserved, h, s, b, k, duration ms
+_LIGHT_STATE = struct.Struct('<4HhH32sQ')    # h, s, b, k, reserved, power, label, reserved
+_SET_POWER = struct.Struct('<HI')            # level, duration ms
+
+
+def pack(msg_type, payload=b'', mac=None, source=0, sequence=0, res=False, ack=False):
+    """One LIFX datagram; mac None addresses every bulb (tagged)"""
+    target = bytes.fromhex(mac.replace(':', '')) + b'\0\0' if mac else bytes(8)
+    frame = _PROTOCOL | _ADDRESSABLE | (0 if mac else _TAGGED)
+    flags = (_RES_REQUIRED if res else 0) | (_ACK_REQUIRED if ack else 0)
+    header = _HEADER.pack(_HEADER.size + len(payload), frame, source, target, bytes(6),
+                          flags, sequence & 0xFF, 0, msg_type, 0)
+    return header + payload
+
+
+def unpack(data):
+    """(msg_type, mac, source, sequence, flags, payload) of a datagram, None if malformed"""
+    if len(data) < _HEADER.size:
+        return None
+    size, _, source, target, _, flags, sequence, _, msg_type, _ = _HEADER.unpack_from(data)
+    if size != len(data):
+        return None
+    mac = ':'.join(f'{b:02x}' for b in target[:6])
+    return msg_type, mac, source, sequence, flags, data[_HEADER.size:]
+
+
+class BulbState:
+    """HSBK color (0-65535 each, kelvin 1500-9000), power (0 or 65535) and label"""
+
+    def __init__(self, hue=0, saturation=0, brightness=32768, kelvin=3500, power=65535, label=""):
+        self.hue, self.saturation, self.brightness, self.kelvin = hue, saturation, brightness, kelvin
+        self.power = power
+        self.label = label
+
+    @classmethod
+    def from_payload(cls, payload):
+        h, s, b, k, _, power, label, _ = _LIGHT_STATE.unpack_from(payload)
+        return cls(h, s, b, k, power, label.split(b'\0', 1)[0].decode('utf-8', 'replace'))
+
+    def to_payload(self):
+        return _LIGHT_STATE.pack(self.hue, self.saturation, self.brightness, self.kelvin, 0,
+                                 self.power, self.label.encode('utf-8')[:32], 0)
+
+    def color(self):
+        return self.hue, self.saturation, self.brightness, self.kelvin
+
+    def __eq__(self, other):
+        return isinstance(other, BulbState) and (self.color(), self.power) == (other.color(), other.power)
+
+
+class Transport:
+    """UDP socket with a random source ID, replies matched by sequence number"""
+
+    def __init__(self, bind=('0.0.0.0', 0)):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+        self.sock.bind(bind)
+        self.source = random.randint(2, 0xFFFFFFFF)
+        self.sequences = itertools.count(1)
+        self.lock = threading.Lock()   # One request at a time owns the socket's replies
+        self.sent = 0
+
+    def send(self, address, msg_type, payload=b'', mac=None, res=False):
+        """Send one datagram without waiting; returns its sequence number"""
+        sequence = next(self.sequences) & 0xFF
+        self.sock.sendto(pack(msg_type, payload, mac, self.source, sequence, res), address)
+        self.sent += 1
+        return sequence
+
+    def request(self, address, msg_type, reply_type, payload=b'', mac=None,
+                timeout=TIMEOUT, retries=RETRIES, collect=False):
+        """Send and wait for replies of reply_type
+
+        Returns the first reply as (mac, sender address, payload), or None
+        after retries timeouts. With collect, waits the whole timeout and
+        returns every reply (for broadcast discovery).
+        """
+        with self.lock:
+            replies = []
+            for _ in range(retries + 1):
+                sequence = self.send(address, msg_type, payload, mac, res=True)
+                deadline = time.monotonic() + timeout
+                while True:
+                    remaining = deadline - time.monotonic()
+                    if remaining <= 0:
+                        break
+                    self.sock.settimeout(remaining)
+                    try:
+                        data, sender = self.sock.recvfrom(1024)
+                    except socket.timeout:
+                        break
+                    except OSError:
+                        continue  # Windows reports ICMP port unreachable as an error
+                    message = unpack(data)
+                    if not message:
+                        continue
+                    kind, reply_mac, source, reply_seq, _, reply_payload = message
+                    if kind != reply_type or source != self.source or reply_seq != sequence:
+                        continue  # Stray or late reply to an earlier request
+                    replies.append((reply_mac, sender, reply_payload))
+                    if not collect:
+                        return replies[0]
+                if replies:
+                    return replies
+            return replies if collect else None
+
+    def close(self):
+        self.sock.close()
+
+
+class Lamp:
+    """Local model of one bulb, written fire-and-forget
+
+    Args:
+        transport: Transport
+        mac, address: the bulb's MAC ("d0:73:d5:..") and (ip, port)
+        state: BulbState read from the bulb
+    """
+
+    def __init__(self, transport, mac, address, state):
+        self.transport = transport
+        self.mac = mac
+        self.address = tuple(address)
+        self.state = state
+        self.label = state.label
+        self.cond = threading.Condition()
+        self.sent = BulbState(*state.color(), state.power)   # Last state sent (or read)
+        self.changed_at = 0.0         # monotonic time of the last local change
+        self.repeat_at = None         # When the last target is sent again
+        self.next_send = 0.0
+        self.stopping = False
+        self.stopped = threading.Event()  # Wakes the resync loop; changes do not
+        self.sets = self.resyncs = 0
+
+    def start(self, resync_interval=RESYNC_INTERVAL):
+        threading.Thread(target=self._send_loop, name="lifx-send", daemon=True).start()
+        threading.Thread(target=self._resync_loop, args=(resync_interval,),
+                         name="lifx-resync", daemon=True).start()
+        return self
+
+    def stop(self):
+        """Send the final target if it may not have arrived, then stop the background threads"""
+        self.stopped.set()
+        with self.cond:
+            self.stopping = True
+            self.cond.notify_all()
+            if self.state != self.sent or self.repeat_at is not None:
+                try:
+                    self._flush(time.monotonic(), force=True)
+                except OSError:
+                    pass
+
+    # --- Local changes, applied at once ---
+
+    def adjust_brightness(self, delta, minimum=0, maximum=65535):
+        """Change brightness by delta; returns the new target"""
+        with self.cond:
+            self.state.brightness = max(minimum, min(maximum, self.state.brightness + delta))
+            self._changed()
+            return self.state.brightness
+
+    def set_power(self, on):
+        with self.cond:
+            self.state.power = 65535 if on else 0
+            self._changed()
+
+    def toggle(self):
+        """Switch the lamp on or off; returns True if it is now on"""
+        with self.cond:
+            self.state.power = 0 if self.state.power else 65535
+            self._changed()
+            return bool(self.state.power)
+
+    def _changed(self):
+        self.changed_at = time.monotonic()
+        self.cond.notify_all()
+
+    # --- Sending ---
+
+    def _flush(self, now, force=False):
+        """Send what differs between the model and what was sent; caller holds cond"""
+        repeat = force or (self.repeat_at is not None and now >= self.repeat_at)
+        state, sent = self.state, self.sent
+        if state.color() != sent.color() or repeat:
+            payload = _SET_COLOR.pack(0, *state.color(), 100)
+            self.transport.send(self.address, LIGHT_SET_COLOR, payload, self.mac)
+            self.sets += 1
+        if state.power != sent.power or repeat:
+            payload = _SET_POWER.pack(state.power, 500)
+            self.transport.send(self.address, LIGHT_SET_POWER, payload, self.mac)
+            self.sets += 1
+        # A repeat closes the burst; anything new schedules the next repeat
+        self.repeat_at = None if repeat else now + REPEAT_DELAY
+        self.sent = BulbState(*state.color(), state.power)
+        self.next_send = now + 1.0 / RATE
+
+    def _send_loop(self):
+        with self.cond:
+            while not self.stopping:
+                now = time.monotonic()
+                dirty = self.state != self.sent
+                if dirty and now >= self.next_send:
+                    try:
+                        self._flush(now)
+                    except OSError:
+                        pass  # Network down; the next change or repeat tries again
+                    continue
+                if not dirty and self.repeat_at is not None and now >= self.repeat_at:
+                    try:
+                        self._flush(now, force=True)
+                    except OSError:
+                        pass
+                    continue
+                wake = self.next_send if dirty else self.repeat_at
+                self.cond.wait(None if wake is None else max(0.0, wake - now))
+
+    # --- Reading the bulb back ---
+
+    def resync(self):
+        """Read the bulb and adopt its state, unless it was just changed here
+
+        Returns True if the model changed.
+        """
+        started = time.monotonic()
+        reply = self.transport.request(self.address, LIGHT_GET, LIGHT_STATE, mac=self.mac)
+        if reply is None:
+            return False
+        remote = BulbState.from_payload(reply[2])
+        with self.cond:
+            self.resyncs += 1
+            if (self.changed_at >= started - RESYNC_GRACE or self.state != self.sent
+                    or self.repeat_at is not None):
+                return False  # A local change is in flight; ours wins
+            if remote == self.state:
+                return False
+            self.state = remote
+            self.sent = BulbState(*remote.color(), remote.power)
+            return True
+
+    def _resync_loop(self, interval):
+        # Not on cond: every local change notifies it, and a read per detent
+        # is what the model is there to avoid
+        while not self.stopped.wait(interval):
+            try:
+                self.resync()
+            except OSError:
+                pass
+
+
+def discover(transport, broadcast=BROADCAST, timeout=1.0):
+    """{mac: ((ip, port), BulbState)} of every bulb answering a broadcast LightGet"""
+    bulbs = {}
+    for mac, address, payload in transport.request(broadcast, LIGHT_GET, LIGHT_STATE, timeout=timeout,
+                                                   retries=1, collect=True):
+        bulbs[mac] = (address, BulbState.from_payload(payload))
+    return bulbs
+
+
+def load_cache(path=CACHE_FILE):
+    try:
+        with open(path, 'r') as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return {}
+
+
+def save_cache(lamps, path=CACHE_FILE):
+    try:
+        with open(path, 'w') as f:
+            json.dump(lamps, f, indent=2)
+    except OSError:
+        pass  # Works without the cache, just discovers every launch
+
+
+def find_lamp(transport, label, cache_path=CACHE_FILE, broadcast=BROADCAST):
+    """Lamp for the bulb called label, or None
+
+    Tries the MAC and address cached for label first; broadcasts discovery
+    only if that bulb does not answer, and records what it finds
+    (cache_path None: no cache). The
+    returned Lamp's found_by is "cache" or "discovery".
+    """
+    cache = load_cache(cache_path) if cache_path else {}
+    entry = cache.get(label)
+    if entry:
+        address = (entry['ip'], entry['port'])
+        reply = transport.request(address, LIGHT_GET, LIGHT_STATE, mac=entry['mac'])
+        if reply is not None:
+            state = BulbState.from_payload(reply[2])
+            if state.label == label:
+                lamp = Lamp(transport, entry['mac'], address, state)
+                lamp.found_by = "cache"
+                return lamp
+
+    for mac, (address, state) in discover(transport, broadcast).items():
+        if state.label == label:
+            cache[label] = {'mac': mac, 'ip': address[0], 'port': address[1]}
+            if cache_path:
+                save_cache(cache, cache_path)
+            lamp = Lamp(transport, mac, address, state)
+            lamp.found_by = "discovery"
+            return lamp
+    return None
+
+
+class FakeBulb:
+    """A LIFX bulb answering on a local UDP socket
+
+    Args:
+        label: bulb label
+        mac: bulb MAC
+        delay: Wi-Fi round trip in seconds, half before a datagram is
+            handled and half before the reply is sent
+        loss: fraction of received datagrams dropped
+        state: initial BulbState
+    """
+
+    def __init__(self, label="Desk Light", mac="d0:73:d5:00:00:01", delay=0.0, loss=0.0,
+                 state=None, bind=('127.0.0.1', 0), seed=1):
+        self.label = label
+        self.mac = mac
+        self.delay = delay
+        self.loss = loss
+        self.state = state or BulbState(label=label)
+        self.state.label = label
+        self.rng = random.Random(seed)
+        self.received = {}      # msg_type -> count
+        self.dropped = 0
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.bind(bind)
+        self.address = self.sock.getsockname()
+        threading.Thread(target=self._serve, name="fake-lifx", daemon=True).start()
+
+    def _serve(self):
+        while True:
+            try:
+                data, sender = self.sock.recvfrom(1024)
+            except OSError:
+                return
+            if self.delay:
+                # Half the round trip on the way in, half on the way back
+                threading.Timer(self.delay / 2, self._handle, (data, sender)).start()
+            else:
+                self._handle(data, sender)
+
+    def _handle(self, data, sender):
+        message = unpack(data)
+        if not message:
+            return
+        kind, target, source, sequence, flags, payload = message
+        if target not in (self.mac, "00:00:00:00:00:00"):
+            return
+        if self.rng.random() < self.loss:
+            self.dropped += 1
+            return
+        self.received[kind] = self.received.get(kind, 0) + 1
+        if kind == LIGHT_SET_COLOR:
+            _, h, s, b, k, _ = _SET_COLOR.unpack_from(payload)
+            self.state.hue, self.state.saturation, self.state.brightness, self.state.kelvin = h, s, b, k
+        elif kind == LIGHT_SET_POWER:
+            self.state.power = _SET_POWER.unpack_from(payload)[0]
+        replies = []
+        if flags & _ACK_REQUIRED:
+            replies.append((ACKNOWLEDGEMENT, b''))
+        if kind == LIGHT_GET or (flags & _RES_REQUIRED and kind == LIGHT_SET_COLOR):
+            replies.append((LIGHT_STATE, self.state.to_payload()))
+        elif kind == LIGHT_SET_POWER and flags & _RES_REQUIRED:
+            replies.append((LIGHT_STATE_POWER, struct.pack('<H', self.state.power)))
+        elif kind == GET_SERVICE:
+            replies.append((STATE_SERVICE, struct.pack('<BI', 1, self.address[1])))
+        for reply_type, reply_payload in replies:
+            data = pack(reply_type, reply_payload, self.mac, source, sequence)
+            if self.delay:
+                threading.Timer(self.delay / 2, self._reply, (data, sender)).start()
+            else:
+                self._reply(data, sender)
+
+    def _reply(self, data, sender):
+        try:
+            self.sock.sendto(data, sender)
+        except OSError:
+            pass
+
+    def close(self):
+        self.sock.close()
+
+
+def main():
+    transport = Transport()
+    bulbs = discover(transport)
+    if not bulbs:
+        print("No LIFX bulbs answered")
+    for mac, (address, state) in bulbs.items():
+        print(f"{state.label or '(no label)':<20} {mac}  {address[0]}:{address[1]}  "
+              f"power {'on' if state.power else 'off'}  brightness {100 * state.brightness // 65535}%")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""
+Pack full-screen OLED bitmaps into the op stream oled_write_packed_P() decodes
+
+Each input is a text file holding the 512-byte SSD1306 page buffer as hex
+bytes (0x.., '#' starts a comment), the layout image2cpp-style tools
+produce; a shorter bitmap is padded with blank columns. The output is a
+header with one PROGMEM array per input, named after the file:
+
+    python3 logo_pack.py -o logos.h logos/*.txt
+    python3 keymaps/default/logo_pack.py -o tidbit_logo.h logos/tidbit_oled.txt
+
+The op codes are read from oled_pack.h next to tidbit.c, which documents the
+format. The encoder picks the shortest op sequence for each bitmap, and
+every result is decoded again and compared before it is written.
+
+--report prints the flash used by each bitmap, raw and packed.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADER_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "oled_pack.h")
+
+FRAME_SIZE = 512  # OLED_MATRIX_SIZE of a 128x32 display
+MAX_SHORT = 64    # literal and zero ops
+MAX_LONG = 66     # run and copy ops
+MAX_DISTANCE = 256
+
+_DEFINE = re.compile(r'^\s*#define\s+(OLED_PACK_\w+)\s+(0[xX][0-9A-Fa-f]+)\b')
+
+
+def _load_ops(path):
+    ops = {}
+    with open(path) as f:
+        for line in f:
+            match = _DEFINE.match(line)
+            if match:
+                ops[match.group(1)] = int(match.group(2), 16)
+    return ops
+
+
+OPS = _load_ops(HEADER_FILE)
+LITERAL, ZEROS, RUN, COPY = (OPS[f"OLED_PACK_{name}"] for name in ("LITERAL", "ZEROS", "RUN", "COPY"))
+
+
+def read_bitmap(path):
+    with open(path) as f:
+        text = "".join(line.split("#", 1)[0] for line in f)
+    data = bytes(int(value, 16) for value in re.findall(r'0x[0-9A-Fa-f]{1,2}', text))
+    if len(data) > FRAME_SIZE:
+        raise ValueError(f"{path}: {len(data)} bytes, a frame is {FRAME_SIZE}")
+    return data + bytes(FRAME_SIZE - len(data))
+
+
+def _copy_length(data, pos, distance):
+    length = 0
+    while pos + length < len(data) and length < MAX_LONG and data[pos + length - distance] == data[pos + length]:
+        length += 1
+    return length
+
+
+def pack(data):
+    """Shortest op stream for data, by dynamic programming from the end"""
+    size = len(data)
+    cost = [0] * (size + 1)
+    choice = [None] * size
+    for pos in range(size - 1, -1, -1):
+        best, pick = None, None
+
+        def consider(length, op_bytes, op):
+            nonlocal best, pick
+            total = op_bytes + cost[pos + length]
+            if best is None or total < best:
+                best, pick = total, op
+
+        for length in range(1, min(MAX_SHORT, size - pos) + 1):
+            consider(length, 1 + length, (LITERAL, length, None))
+
+        run = 1
+        while pos + run < size and run < MAX_LONG and data[pos + run] == data[pos]:
+            run += 1
+        for length in range(1, run + 1):
+            if data[pos] == 0 and length <= MAX_SHORT:
+                consider(length, 1, (ZEROS, length, None))
+            if length >= 3:
+                consider(length, 2, (RUN, length, data[pos]))
+
+        for distance in range(1, min(pos, MAX_DISTANCE) + 1):
+            longest = _copy_length(data, pos, distance)
+            for length in range(3, longest + 1):
+                consider(length, 2, (COPY, length, distance))
+
+        cost[pos], choice[pos] = best, pick
+
+    out = bytearray()
+    pos = 0
+    while pos < size:
+        op, length, arg = choice[pos]
+        if op == LITERAL:
+            out.append(op | (length - 1))
+            out += data[pos:pos + length]
+        elif op == ZEROS:
+            out.append(op | (length - 1))
+        elif op == RUN:
+            out += bytes((op | (length - 3), arg))
+        else:
+            out += bytes((op | (length - 3), arg - 1))
+        pos += length
+    return bytes(out)
+
+
+def unpack(packed, size=FRAME_SIZE):
+    """Python model of oled_write_packed_P()"""
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        op = packed[i]
+        count = (op & 0x3F) + 1
+        kind = op & 0xC0
+        if kind == LITERAL:
+            out += packed[i + 1:i + 1 + count]
+            i += 1 + count
+        elif kind == ZEROS:
+            out += bytes(count)
+            i += 1
+        elif kind == RUN:
+            out += bytes([packed[i + 1]]) * (count + 2)
+            i += 2
+        else:
+            start = len(out) - packed[i + 1] - 1
+            for k in range(count + 2):
+                out.append(out[start + k])
+            i += 2
+    return bytes(out), i
+
+
+def write_header(path, logos, script_name):
+    with open(path, "w") as f:
+        f.write(f"// Generated by {script_name} from the bitmaps in logos/, do not edit.\n")
+        f.write("// Draw with oled_write_packed_P(); the format is described in oled_pack.h.\n")
+        f.write("\n#pragma once\n")
+        for name, data, packed in logos:
+            f.write(f"\n// {name}: {len(data)} bytes packed into {len(packed)}\n")
+            f.write(f"static const char PROGMEM {name}[] = {{\n")
+            for row in range(0, len(packed), 16):
+                f.write("    " + ", ".join(f"0x{b:02x}" for b in packed[row:row + 16]))
+                f.write(",\n" if row + 16 < len(packed) else "\n")
+            f.write("};\n")
+
+
+def report(logos):
+    print(f"{'bitmap':<16} {'raw':>5} {'packed':>7} {'saved':>6}")
+    raw_total = packed_total = 0
+    for name, data, packed in logos:
+        raw_total += len(data)
+        packed_total += len(packed)
+        print(f"{name:<16} {len(data):>5} {len(packed):>7} {len(data) - len(packed):>6}")
+    print(f"{'total':<16} {raw_total:>5} {packed_total:>7} {raw_total - packed_total:>6}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("bitmaps", nargs="+", help="text files of hex bytes, one bitmap each")
+    parser.add_argument("-o", "--output", help="header to write")
+    parser.add_argument("--report", action="store_true", help="print raw and packed sizes")
+    args = parser.parse_args()
+
+    logos = []
+    for path in args.bitmaps:
+        name = os.path.splitext(os.path.basename(path))[0]
+        data = read_bitmap(path)
+        packed = pack(data)
+        decoded, used = unpack(packed)
+        if decoded != data or used != len(packed):
+            sys.exit(f"{path}: packed bitmap does not decode back to the original")
+        logos.append((name, data, packed))
+
+    if args.output:
+        write_header(args.output, logos, os.path.basename(sys.argv[0]))
+    if args.report or not args.output:
+        report(logos)
+
+
+if __name__ == "__main__":
+    main()
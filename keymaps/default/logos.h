@@ -0,0 +1,52 @@
+// Generated by logo_pack.py from the bitmaps in logos/, do not edit.
+// Draw with oled_write_packed_P(); the format is described in oled_pack.h.
+
+#pragma once
+
+// logo_desktop_wp: 512 bytes packed into 69
+static const char PROGMEM logo_desktop_wp[] = {
+    0x7a, 0x01, 0x80, 0xc0, 0x8a, 0x60, 0x01, 0xc0, 0x80, 0x69, 0x7f, 0x15, 0xf8, 0xfc, 0x0c, 0x8e,
+    0xcc, 0xec, 0x6c, 0x0e, 0x8c, 0xce, 0xef, 0xef, 0xce, 0x8c, 0x1c, 0xfe, 0xfc, 0xc0, 0xc0, 0x00,
+    0xff, 0xff, 0x68, 0x7f, 0xc1, 0x6b, 0x12, 0x01, 0x01, 0x13, 0x3e, 0x18, 0x11, 0x33, 0x67, 0x67,
+    0x63, 0x21, 0x24, 0x27, 0xa7, 0x23, 0x21, 0x30, 0x1f, 0x0f, 0x69, 0x7f, 0x01, 0x01, 0x03, 0x8a,
+    0x06, 0x01, 0x03, 0x03, 0x78
+};
+
+// logo_discord: 512 bytes packed into 48
+static const char PROGMEM logo_discord[] = {
+    0x76, 0x7f, 0x7f, 0x07, 0xc0, 0xf8, 0xfc, 0xfe, 0xfe, 0xff, 0x7f, 0x7f, 0x81, 0xfe, 0x07, 0x7f,
+    0x7f, 0xff, 0xfe, 0xfe, 0xfc, 0xf8, 0xc0, 0x6b, 0x7f, 0x01, 0x1f, 0x3f, 0x80, 0x7f, 0x02, 0x7e,
+    0x1c, 0x3c, 0x81, 0x3f, 0x02, 0x3c, 0x1c, 0x7e, 0x80, 0x7f, 0x01, 0x3f, 0x1f, 0x74, 0x7f, 0x7f
+};
+
+// logo_nordvpn: 512 bytes packed into 70
+static const char PROGMEM logo_nordvpn[] = {
+    0x70, 0x04, 0xc0, 0xe0, 0xf0, 0xf0, 0xf8, 0x80, 0xfc, 0x87, 0xfe, 0x80, 0xfc, 0x04, 0xf8, 0xf0,
+    0xf0, 0xe0, 0xc0, 0x62, 0x7f, 0x01, 0xf0, 0xfc, 0x88, 0xff, 0x05, 0x7f, 0x1f, 0x0f, 0x0f, 0x1f,
+    0x7f, 0x88, 0xff, 0x01, 0xfc, 0xf0, 0x5f, 0x7f, 0xc3, 0x6d, 0x03, 0x3f, 0x0f, 0x07, 0x01, 0x41,
+    0x00, 0x03, 0x45, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x0f, 0x3f, 0xc3, 0x91, 0x5f, 0x7f, 0xc0,
+    0x6a, 0xc0, 0x7a, 0xd6, 0x19, 0x72
+};
+
+// logo_steam: 512 bytes packed into 73
+static const char PROGMEM logo_steam[] = {
+    0x41, 0x7f, 0x83, 0x80, 0x67, 0xff, 0x6e, 0x4a, 0x05, 0x80, 0xc0, 0xf8, 0xfe, 0xc7, 0x99, 0x80,
+    0x7d, 0x04, 0x3d, 0x99, 0xc7, 0xfe, 0x38, 0x65, 0x7f, 0x06, 0x0f, 0x4f, 0x1f, 0x1f, 0x3e, 0x3e,
+    0x7c, 0x80, 0xfc, 0x0a, 0xfe, 0xf7, 0x27, 0xdf, 0x7f, 0x1f, 0x0f, 0x07, 0x07, 0x03, 0x03, 0x80,
+    0x01, 0x43, 0x00, 0x40, 0x66, 0x7f, 0x00, 0x04, 0x41, 0x07, 0x01, 0x01, 0x03, 0x02, 0x03, 0x01,
+    0x41, 0x40, 0xc2, 0x73, 0x00, 0x20, 0xc2, 0x14, 0x74
+};
+
+// my_logo: 512 bytes packed into 155
+static const char PROGMEM my_logo[] = {
+    0x52, 0x7f, 0x7f, 0x0f, 0x80, 0xe0, 0xf8, 0x7c, 0x1c, 0x0e, 0x06, 0x06, 0x07, 0x06, 0x06, 0x0e,
+    0x1c, 0xfc, 0xf8, 0xe0, 0x41, 0x06, 0x40, 0x60, 0xfc, 0xfe, 0xfe, 0x66, 0x46, 0xc5, 0x07, 0x42,
+    0x80, 0xfe, 0x83, 0x06, 0x03, 0x0e, 0xde, 0xfc, 0xf8, 0x43, 0x02, 0x80, 0xc0, 0xe0, 0x80, 0x60,
+    0x02, 0xe0, 0xc0, 0x80, 0x43, 0x80, 0xe0, 0x01, 0x80, 0xc0, 0xc0, 0x0d, 0xc0, 0x0e, 0xc3, 0x1b,
+    0x02, 0xc0, 0xe0, 0xe0, 0xc2, 0x0d, 0x64, 0x04, 0x0f, 0x3f, 0xff, 0xf0, 0xc0, 0x80, 0x80, 0x40,
+    0x80, 0x80, 0x04, 0xc0, 0xf8, 0x7f, 0x3f, 0x02, 0x42, 0x80, 0xff, 0x41, 0xcb, 0x07, 0x83, 0x07,
+    0x02, 0x0f, 0xff, 0xfd, 0xc1, 0x7f, 0x03, 0x7e, 0xff, 0xff, 0x8c, 0x80, 0x0c, 0x03, 0x8c, 0x8f,
+    0xcf, 0x4f, 0xce, 0x2d, 0x03, 0x3e, 0xff, 0xff, 0xc1, 0xc1, 0x79, 0x03, 0x80, 0xf7, 0xff, 0x7f,
+    0x66, 0x01, 0x01, 0x01, 0x84, 0x03, 0x00, 0x01, 0x46, 0x80, 0x03, 0xcd, 0x07, 0xc7, 0x19, 0xc3,
+    0x32, 0xc3, 0x2f, 0xd2, 0x25, 0xc4, 0x4d, 0x01, 0x01, 0x01, 0x51
+};
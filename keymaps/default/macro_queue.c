@@ -0,0 +1,143 @@
+#include "macro_queue.h"
+
+typedef enum {
+    MACRO_TAP = 0,
+    MACRO_DELAY,
+    MACRO_STRING,
+    MACRO_STRING_P
+} macro_step_type_t;
+
+typedef struct {
+    uint8_t type;
+    union {
+        uint16_t    keycode;
+        uint16_t    delay_ms;
+        const char *str;
+    };
+} macro_step_t;
+
+static macro_step_t queue[MACRO_QUEUE_SIZE];
+static uint8_t      queue_head = 0;  // Next step to run
+static uint8_t      queue_tail = 0;  // Next free slot
+
+// Progress through the step at queue_head
+static bool     step_started = false;
+static uint32_t delay_until  = 0;     // MACRO_DELAY deadline
+static uint8_t  string_pos   = 0;     // Next character of a MACRO_STRING*
+
+// Keystroke currently being typed: one report per phase, mods pressed in
+// order, then the key down and up, then mods released.
+static uint8_t stroke_kc     = KC_NO;
+static uint8_t stroke_mods   = 0;     // Left mod bits, as in QK_LCTL >> 8
+static uint8_t stroke_phase  = 0;
+static uint8_t stroke_phases = 0;
+
+uint8_t macro_queue_free(void) {
+    return MACRO_QUEUE_SIZE - (uint8_t)(queue_tail - queue_head);
+}
+
+bool macro_queue_busy(void) {
+    return queue_head != queue_tail || stroke_phases;
+}
+
+static bool enqueue(uint8_t type, macro_step_t step) {
+    if (!macro_queue_free()) return false;
+    step.type = type;
+    queue[queue_tail++ & (MACRO_QUEUE_SIZE - 1)] = step;
+    return true;
+}
+
+bool macro_queue_tap(uint16_t keycode) {
+    return enqueue(MACRO_TAP, (macro_step_t){.keycode = keycode});
+}
+
+bool macro_queue_delay(uint16_t ms) {
+    return enqueue(MACRO_DELAY, (macro_step_t){.delay_ms = ms});
+}
+
+bool macro_queue_string(const char *str) {
+    return enqueue(MACRO_STRING, (macro_step_t){.str = str});
+}
+
+bool macro_queue_string_P(const char *str) {
+    return enqueue(MACRO_STRING_P, (macro_step_t){.str = str});
+}
+
+static void stroke_start(uint8_t kc, uint8_t mods) {
+    stroke_kc     = kc;
+    stroke_mods   = mods & 0x0F;
+    stroke_phase  = 0;
+    stroke_phases = 2 * __builtin_popcount(stroke_mods) + 2;
+}
+
+// KC_LCTL, KC_LSFT, KC_LALT, KC_LGUI for the n-th set bit of stroke_mods
+static uint8_t stroke_mod(uint8_t n) {
+    for (uint8_t bit = 0; bit < 4; bit++) {
+        if ((stroke_mods & (1 << bit)) && n-- == 0) return KC_LCTL + bit;
+    }
+    return KC_NO;
+}
+
+// Sends exactly one keyboard report
+static void stroke_step(void) {
+    uint8_t mods = stroke_phases / 2 - 1;
+    if (stroke_phase < mods) {
+        register_code(stroke_mod(stroke_phase));
+    } else if (stroke_phase == mods) {
+        register_code(stroke_kc);
+    } else if (stroke_phase == mods + 1) {
+        unregister_code(stroke_kc);
+    } else {
+        unregister_code(stroke_mod(stroke_phase - mods - 2));
+    }
+    if (++stroke_phase == stroke_phases) stroke_phases = 0;
+}
+
+static void step_done(void) {
+    queue_head++;
+    step_started = false;
+}
+
+void macro_queue_task(void) {
+    if (stroke_phases) {
+        stroke_step();
+        return;
+    }
+    if (queue_head == queue_tail) return;
+
+    macro_step_t *step = &queue[queue_head & (MACRO_QUEUE_SIZE - 1)];
+    switch (step->type) {
+        case MACRO_TAP:
+            stroke_start((uint8_t)step->keycode, step->keycode >> 8);
+            step_done();
+            stroke_step();
+            break;
+
+        case MACRO_DELAY:
+            if (!step_started) {
+                delay_until  = timer_read32() + step->delay_ms;
+                step_started = true;
+            } else if ((int32_t)(timer_read32() - delay_until) >= 0) {
+                step_done();
+            }
+            break;
+
+        case MACRO_STRING:
+        case MACRO_STRING_P: {
+            if (!step_started) {
+                string_pos   = 0;
+                step_started = true;
+            }
+            char c = step->type == MACRO_STRING_P ? pgm_read_byte(step->str + string_pos) : step->str[string_pos];
+            if (!c) {
+                step_done();
+                break;
+            }
+            string_pos++;
+            uint8_t kc = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)c]);
+            stroke_start(kc, PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)c) ? (QK_LSFT >> 8) : 0);
+            stroke_step();
+            break;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "quantum.h"
+
+// Queued keystroke macros, drained one keyboard report per matrix scan so
+// typing a long Run-dialog command never stalls the scan loop.
+//
+// Steps are enqueued with the functions below and executed in order by
+// macro_queue_task(), which must be called from matrix_scan_user(). Strings
+// are referenced, not copied: pass literals or other storage that outlives
+// the macro.
+
+#define MACRO_QUEUE_SIZE 16  // Steps, must be a power of two
+
+// Number of free step slots; check before enqueueing a multi-step macro so
+// it is never cut in half.
+uint8_t macro_queue_free(void);
+bool    macro_queue_busy(void);
+
+bool macro_queue_tap(uint16_t keycode);           // Basic keycode, optionally with left mods (LGUI(KC_R))
+bool macro_queue_delay(uint16_t ms);
+bool macro_queue_string(const char *str);         // String in RAM
+bool macro_queue_string_P(const char *str);       // String in PROGMEM
+
+void macro_queue_task(void);
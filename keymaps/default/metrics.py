@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+Metrics collection for the TIDBIT system monitor
+
+A Provider wraps one source of HID_METRIC_* values (psutil, NVML, network
+latency from latency_probe.py). MetricsEngine opens each provider once,
+samples it on its own thread at its own interval, and keeps the latest value
+of every metric plus a ring buffer of recent samples. Readers never wait on
+a provider: latest() returns whatever was sampled last.
+
+Providers whose library or hardware is missing decline in open() and are
+left out, so the engine runs anywhere (no NVML, no psutil).
+
+    python metrics.py    # sample for a few seconds and print values and provider costs
+"""
+
+import collections
+import threading
+import time
+
+from hid_protocol import (HID_METRIC_CPU, HID_METRIC_GPU, HID_METRIC_GPU_MEM, HID_METRIC_PING,
+                          HID_METRIC_GPU_TEMP, HID_METRIC_CPU_CLOCK, HID_METRIC_GPU_CLOCK)
+from latency_probe import LatencyProbe, DEFAULT_TARGET
+
+HISTORY = 64  # Samples kept per metric
+
+
+class Provider:
+    """One source of metrics
+
+    Subclasses set name and interval (seconds between samples) and
+    implement sample(), returning {HID_METRIC_*: int}. open() runs once
+    before the first sample and returns False if the source is unavailable;
+    close() runs once when the engine stops.
+    """
+
+    name = "provider"
+    interval = 1.0
+
+    def open(self):
+        return True
+
+    def sample(self):
+        return {}
+
+    def close(self):
+        pass
+
+
+class CpuProvider(Provider):
+    """CPU load and clock from psutil, without blocking"""
+
+    name = "cpu"
+    interval = 0.1
+
+    def open(self):
+        try:
+            import psutil
+        except ImportError:
+            print("psutil not available - CPU monitoring disabled")
+            return False
+        self.psutil = psutil
+        psutil.cpu_percent(interval=None)  # Prime: the first call has no baseline
+        return True
+
+    def sample(self):
+        values = {HID_METRIC_CPU: int(self.psutil.cpu_percent(interval=None))}
+        freq = self.psutil.cpu_freq()
+        if freq:
+            values[HID_METRIC_CPU_CLOCK] = int(freq.current)
+        return values
+
+
+class NvmlProvider(Provider):
+    """NVIDIA GPU load, memory, temperature and clock through one NVML handle"""
+
+    name = "nvml"
+    interval = 0.25
+
+    def __init__(self, index=0):
+        self.index = index
+        self.nvml = None
+
+    def open(self):
+        try:
+            import pynvml
+            pynvml.nvmlInit()
+            self.handle = pynvml.nvmlDeviceGetHandleByIndex(self.index)
+        except Exception:  # Not installed, no driver or no GPU
+            print("pynvml not available - GPU monitoring disabled")
+            return False
+        self.nvml = pynvml
+        return True
+
+    def sample(self):
+        nvml, handle = self.nvml, self.handle
+        mem = nvml.nvmlDeviceGetMemoryInfo(handle)
+        return {
+            HID_METRIC_GPU: nvml.nvmlDeviceGetUtilizationRates(handle).gpu,
+            HID_METRIC_GPU_MEM: int(mem.used * 100 / mem.total) if mem.total else 0,
+            HID_METRIC_GPU_TEMP: nvml.nvmlDeviceGetTemperature(handle, nvml.NVML_TEMPERATURE_GPU),
+            HID_METRIC_GPU_CLOCK: nvml.nvmlDeviceGetClockInfo(handle, nvml.NVML_CLOCK_GRAPHICS),
+        }
+
+    def close(self):
+        if self.nvml:
+            try:
+                self.nvml.nvmlShutdown()
+            except Exception:
+                pass
+            self.nvml = None
+
+
+class PingProvider(Provider):
+    """Network round trip from a background latency_probe.LatencyProbe"""
+
+    name = "ping"
+    interval = 1.0
+
+    def __init__(self, target=DEFAULT_TARGET):
+        self.probe = LatencyProbe(target, interval=self.interval)
+
+    def open(self):
+        self.probe.start()
+        return True
+
+    def sample(self):
+        snapshot = self.probe.snapshot()
+        if not snapshot.sent:
+            return {}
+        if snapshot.last is None:
+            # 0 while the target does not answer, as the ping command gave
+            return {HID_METRIC_PING: 0}
+        # At least 1, so a sub-millisecond answer on a LAN does not read as lost
+        return {HID_METRIC_PING: max(1, int(round(snapshot.last)))}
+
+    def close(self):
+        self.probe.stop()
+
+
+def default_providers():
+    return [CpuProvider(), NvmlProvider(), PingProvider()]
+
+
+class ProviderStats:
+    """Sampling cost of one provider"""
+
+    def __init__(self):
+        self.samples = 0
+        self.errors = 0
+        self.time_sum = 0.0
+        self.time_max = 0.0
+
+    def as_dict(self):
+        return {
+            'samples': self.samples,
+            'errors': self.errors,
+            'sample_avg_ms': round(1000 * self.time_sum / self.samples, 3) if self.samples else 0,
+            'sample_max_ms': round(1000 * self.time_max, 3),
+        }
+
+
+class MetricsEngine:
+    """Samples providers in the background and keeps their latest values
+
+    Args:
+        providers: Provider instances; those whose open() fails are dropped
+        history: samples kept per metric
+    """
+
+    def __init__(self, providers=None, history=HISTORY):
+        self.providers = default_providers() if providers is None else providers
+        self.history_size = history
+        self.lock = threading.Lock()
+        self.values = {}
+        self.history = {}
+        self.stats = {}
+        self.stopping = threading.Event()
+        self.threads = []
+
+    def start(self):
+        for provider in self.providers:
+            if not provider.open():
+                continue
+            self.stats[provider.name] = ProviderStats()
+            thread = threading.Thread(target=self._run, args=(provider,),
+                                      name=f"metrics-{provider.name}", daemon=True)
+            thread.start()
+            self.threads.append((thread, provider))
+        return self
+
+    def stop(self):
+        self.stopping.set()
+        for thread, provider in self.threads:
+            thread.join(provider.interval + 2)
+            provider.close()
+        self.threads = []
+
+    def _run(self, provider):
+        stats = self.stats[provider.name]
+        next_sample = time.monotonic()
+        while not self.stopping.is_set():
+            started = time.monotonic()
+            try:
+                values = provider.sample()
+            except Exception:
+                values = None  # Keep the last good values
+            elapsed = time.monotonic() - started
+            with self.lock:
+                stats.samples += 1
+                stats.time_sum += elapsed
+                stats.time_max = max(stats.time_max, elapsed)
+                if values is None:
+                    stats.errors += 1
+                else:
+                    self._record(values, started)
+            # Fixed schedule; skip ticks a slow sample overran instead of bunching up
+            next_sample += provider.interval
+            now = time.monotonic()
+            if next_sample < now:
+                next_sample = now + provider.interval
+            self.stopping.wait(next_sample - now)
+
+    def _record(self, values, when):
+        for metric, value in values.items():
+            self.values[metric] = value
+            ring = self.history.get(metric)
+            if ring is None:
+                ring = self.history[metric] = collections.deque(maxlen=self.history_size)
+            ring.append((when, value))
+
+    def latest(self):
+        """{HID_METRIC_*: value} of every metric sampled so far"""
+        with self.lock:
+            return dict(self.values)
+
+    def get(self, metric, default=0):
+        with self.lock:
+            return self.values.get(metric, default)
+
+    def recent(self, metric, seconds=None):
+        """(monotonic time, value) samples of a metric, oldest first"""
+        with self.lock:
+            samples = list(self.history.get(metric, ()))
+        if seconds is not None:
+            cutoff = time.monotonic() - seconds
+            samples = [s for s in samples if s[0] >= cutoff]
+        return samples
+
+    def provider_stats(self):
+        with self.lock:
+            return {name: s.as_dict() for name, s in self.stats.items()}
+
+
+def main():
+    engine = MetricsEngine().start()
+    try:
+        time.sleep(3)
+    finally:
+        engine.stop()
+    print("latest:", engine.latest())
+    for name, stats in engine.provider_stats().items():
+        print(f"{name:<6} {stats}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,92 @@
+#include "oled_view.h"
+#include "oled_pack.h"
+
+#ifdef OLED_ENABLE
+
+#define SCREEN_NONE 0xFF
+
+// Character last written to each cell; 0 where a bitmap covers the cell
+static char    shadow[OLED_VIEW_LINES][OLED_VIEW_COLS];
+static uint8_t source_gen[VIEW_SRC_COUNT];
+static uint8_t drawn_gen[VIEW_SRC_COUNT];
+static uint8_t drawn_screen = SCREEN_NONE;
+static bool    drawn_bitmap = false;
+
+void oled_view_touch(view_source_t src) {
+    source_gen[src]++;
+}
+
+void oled_view_invalidate(void) {
+    oled_clear();
+    memset(shadow, ' ', sizeof(shadow));  // A cleared cell looks like a space
+    drawn_screen = SCREEN_NONE;
+    drawn_bitmap = false;
+}
+
+bool oled_view_begin(uint8_t screen, uint8_t source_mask) {
+    bool redraw = screen != drawn_screen;
+    for (uint8_t i = 0; i < VIEW_SRC_COUNT; i++) {
+        if ((source_mask & VIEW_SRC_BIT(i)) && source_gen[i] != drawn_gen[i]) {
+            redraw = true;
+        }
+    }
+    if (!redraw) {
+        return false;
+    }
+    memcpy(drawn_gen, source_gen, sizeof(drawn_gen));
+    drawn_screen = screen;
+    return true;
+}
+
+void oled_view_packed_P(const char *data_P) {
+    // The bitmap rewrites the whole buffer, no clear needed
+    oled_write_packed_P(data_P);
+    memset(shadow, 0, sizeof(shadow));
+    drawn_bitmap = true;
+}
+
+static void write_line(uint8_t line, const char *text, bool progmem) {
+    if (drawn_bitmap) {
+        // Text only covers the cells it writes, wipe the bitmap first
+        oled_clear();
+        memset(shadow, ' ', sizeof(shadow));
+        drawn_bitmap = false;
+    }
+
+    char row[OLED_VIEW_COLS];
+    bool ended = false;
+    for (uint8_t col = 0; col < OLED_VIEW_COLS; col++) {
+        char c = ended ? 0 : (progmem ? pgm_read_byte(text + col) : text[col]);
+        if (!c) {
+            ended = true;
+            c     = ' ';
+        }
+        row[col] = c;
+    }
+
+    // Send only the span between the first and last changed cell
+    char   *seen  = shadow[line];
+    uint8_t first = 0;
+    uint8_t last  = OLED_VIEW_COLS;
+    while (first < OLED_VIEW_COLS && row[first] == seen[first]) first++;
+    if (first == OLED_VIEW_COLS) {
+        return;
+    }
+    while (row[last - 1] == seen[last - 1]) last--;
+
+    oled_set_cursor(first, line);
+    for (uint8_t col = first; col < last; col++) {
+        oled_write_char(row[col], false);
+    }
+    memcpy(&seen[first], &row[first], last - first);
+}
+
+void oled_view_line(uint8_t line, const char *text) {
+    write_line(line, text, false);
+}
+
+void oled_view_line_P(uint8_t line, const char *text_P) {
+    write_line(line, text_P, true);
+}
+
+#endif
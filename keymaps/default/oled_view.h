@@ -0,0 +1,44 @@
+#pragma once
+
+#include "quantum.h"
+
+// Retained-mode layer over the QMK OLED driver.
+//
+// Data sources bump a generation counter when their content changes, and
+// oled_task_user() asks oled_view_begin() whether the screen it is about to
+// draw differs from the last one drawn. Text lines go through a shadow copy
+// of the 4x21 character grid so only the cells that changed are written.
+
+#define OLED_VIEW_LINES 4
+#define OLED_VIEW_COLS  21
+
+typedef enum {
+    VIEW_SRC_MONITOR = 0,  // cpu/gpu/mem/ping values
+    VIEW_SRC_DISCORD,      // selected user and roster count
+    VIEW_SRC_MESSAGE,      // temporary message text
+    VIEW_SRC_APP,          // last_app logo/banner
+    VIEW_SRC_COUNT
+} view_source_t;
+
+#define VIEW_SRC_BIT(src) (1 << (src))
+
+#ifdef OLED_ENABLE
+void oled_view_touch(view_source_t src);
+
+// Returns true when the caller must draw `screen`: the screen changed since
+// the last call, or one of the sources in `source_mask` was touched.
+bool oled_view_begin(uint8_t screen, uint8_t source_mask);
+
+// Clear the display and the shadow, forcing the next oled_view_begin() to redraw
+void oled_view_invalidate(void);
+
+// Write a full-screen bitmap packed by logo_pack.py. The next text line
+// clears it first.
+void oled_view_packed_P(const char *data_P);
+
+// Write a text line padded to 21 columns, sending only the changed cells
+void oled_view_line(uint8_t line, const char *text);
+void oled_view_line_P(uint8_t line, const char *text_P);
+#else
+#    define oled_view_touch(src)
+#endif
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+Timing counters of the TIDBIT firmware, read over raw HID
+
+The firmware times matrix_scan_kb, the period between scans, oled_task_kb,
+raw_hid_receive and encoder_update_user (perf_stats.c) and answers
+HID_OP_PERF queries with the counters. This polls them through the HID
+broker and prints, per probe, the calls per second and the histogram of
+the last interval, next to the min/mean/max since the counters were reset
+(the mean over at most the last 65535 calls, min and max capped at 65535 us).
+
+    python perf_stats.py                  # every 2 s until Ctrl+C
+    python perf_stats.py --reset --once   # zero the counters, wait, print once
+    python perf_stats.py --interval 10
+"""
+
+import argparse
+import sys
+import time
+
+from hid_client import HidClient
+from hid_protocol import (HID_REPORT_SIZE, HID_OP_PERF, HID_PERF_INFO, HID_PERF_PROBE, HID_PERF_RESET, HID_PERF_PROBE_ID,
+                          HID_PERF_SCAN, HID_PERF_GAP, HID_PERF_OLED, HID_PERF_HID, HID_PERF_ENCODER,
+                          check_version, perf_query_report, decode_perf_info, decode_perf_probe)
+
+INTERVAL = 2.0      # Seconds between polls
+TIMEOUT_MS = 500    # Wait for each reply
+
+PROBE_NAMES = {
+    HID_PERF_SCAN: "matrix_scan_kb",
+    HID_PERF_GAP: "scan period",
+    HID_PERF_OLED: "oled_task_kb",
+    HID_PERF_HID: "raw_hid_receive",
+    HID_PERF_ENCODER: "encoder_update",
+}
+
+
+def query(keyboard, command, probe=0, timeout_ms=TIMEOUT_MS):
+    """Send a HID_OP_PERF query and return the keyboard's reply, None if it did not answer"""
+    keyboard.write(perf_query_report(command, probe))
+    deadline = time.monotonic() + timeout_ms / 1000
+    while time.monotonic() < deadline:
+        data = keyboard.read(HID_REPORT_SIZE, timeout_ms=50)
+        if (data and data[0] == HID_OP_PERF and data[1] == command
+                and (command != HID_PERF_PROBE or data[HID_PERF_PROBE_ID] == probe)):
+            return data
+    return None
+
+
+def snapshot(keyboard, reset=False):
+    """(info dict, [probe dict, ...]) read from the keyboard, None if it did not answer"""
+    data = query(keyboard, HID_PERF_RESET if reset else HID_PERF_INFO)
+    if data is None:
+        return None
+    info = decode_perf_info(data)
+    probes = []
+    for probe in range(info['probes']):
+        data = query(keyboard, HID_PERF_PROBE, probe)
+        if data is None:
+            return None
+        probes.append(decode_perf_probe(data))
+    return info, probes
+
+
+def bucket_labels(bounds):
+    """Column heading of each histogram bucket, e.g. <50 ... >=10k"""
+    def us(value):
+        return f"{value // 1000}k" if value >= 1000 and value % 1000 == 0 else str(value)
+    return [f"<{us(b)}" for b in bounds] + [f">={us(bounds[-1])}"]
+
+
+def format_table(info, probes, previous=None):
+    """Lines of a snapshot; calls/s and the histogram cover the time since previous"""
+    if previous and previous[0]['elapsed_ms'] > info['elapsed_ms']:
+        previous = None  # Reset in between
+    seconds = info['elapsed_ms'] / 1000
+    if previous:
+        seconds -= previous[0]['elapsed_ms'] / 1000
+    labels = bucket_labels(info['bounds_us'])
+    lines = [f"{'probe':<16} {'calls/s':>8} {'min us':>7} {'mean us':>7} {'max us':>7}  "
+             + " ".join(f"{label:>6}" for label in labels)]
+    for stats in probes:
+        old = previous[1][stats['probe']] if previous else None
+        calls = stats['calls'] - (old['calls'] if old else 0)
+        hist = [(new - (old['hist'][i] if old else 0)) & 0xFFFF for i, new in enumerate(stats['hist'])]
+        total = sum(hist)
+        rate = f"{calls / seconds:8.1f}" if seconds > 0 else f"{'-':>8}"
+        shares = " ".join(f"{100 * count / total:5.1f}%" if total else f"{'-':>6}" for count in hist)
+        name = PROBE_NAMES.get(stats['probe'], f"probe {stats['probe']}")
+        lines.append(f"{name:<16} {rate} {stats['min_us']:7d} {stats['mean_us']:7d} {stats['max_us']:7d}  {shares}")
+    lines.append(f"since reset {info['elapsed_ms'] / 1000:.1f} s, clock {info['resolution_us']} us, "
+                 f"{info['dropped']} raw HID reports dropped")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--interval", type=float, default=INTERVAL, help="seconds between polls")
+    parser.add_argument("--once", action="store_true", help="print one interval and exit")
+    parser.add_argument("--reset", action="store_true", help="zero the counters first")
+    args = parser.parse_args()
+
+    try:
+        keyboard = HidClient([HID_OP_PERF])
+    except OSError as e:
+        sys.exit(f"ERROR: Could not connect to HID broker: {e}")
+    try:
+        check_version(keyboard)
+        previous = snapshot(keyboard, reset=args.reset)
+        if previous is None:
+            sys.exit("ERROR: keyboard did not answer the diagnostics query - reflash the firmware")
+        while True:
+            time.sleep(args.interval)
+            current = snapshot(keyboard)
+            if current is None:
+                print("keyboard did not answer, retrying")
+                continue
+            print("\n".join(format_table(*current, previous=previous)) + "\n")
+            previous = current
+            if args.once:
+                break
+    except KeyboardInterrupt:
+        pass
+    except ConnectionError as e:
+        sys.exit(f"ERROR: {e}")
+    finally:
+        keyboard.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,132 @@
+#include "reliable.h"
+#include "raw_hid.h"
+#include "deadline.h"
+
+#define CHANNEL_BIT(opcode) (1 << ((opcode) - HID_OP_VOLUME))
+
+// The fields of a report the resends need, not the whole 32 bytes
+typedef struct {
+    uint8_t  head[HID_TRACE_SEQ];  // Opcode, command and its payload
+    uint16_t seq;
+    uint32_t event_at;
+    uint8_t  tries;     // Sends so far, 0 = free slot
+    uint16_t delay;     // Until the next send
+    uint32_t sent_at;
+} pending_t;
+
+static pending_t pending[RELIABLE_WINDOW];
+static uint8_t   acking;  // CHANNEL_BIT of the channels whose script acks
+
+static bool is_channel(uint8_t opcode) {
+    return opcode >= HID_OP_VOLUME && opcode <= HID_OP_LIFX;
+}
+
+static void put_u32(uint8_t *dst, uint32_t value) {
+    dst[0] = value >> 24;
+    dst[1] = value >> 16;
+    dst[2] = value >> 8;
+    dst[3] = value;
+}
+
+static void transmit(pending_t *p) {
+    uint32_t now                    = timer_read32();
+    uint8_t  report[HID_REPORT_SIZE] = {0};
+    memcpy(report, p->head, sizeof(p->head));
+    report[HID_TRACE_SEQ]     = p->seq >> 8;
+    report[HID_TRACE_SEQ + 1] = p->seq;
+    put_u32(report + HID_TRACE_EVENT, p->event_at);
+    put_u32(report + HID_TRACE_SENT, now);  // Each copy carries its own send time
+    raw_hid_send(report, HID_REPORT_SIZE);
+    p->tries++;
+    p->sent_at = now;
+}
+
+static void resend(deadline_id_t id);
+
+// Wake up for the earliest resend, if anything awaits an ack
+static void arm(void) {
+    bool     any  = false;
+    uint32_t left = 0;
+    for (uint8_t i = 0; i < RELIABLE_WINDOW; i++) {
+        pending_t *p = &pending[i];
+        if (!p->tries) {
+            continue;
+        }
+        uint32_t elapsed = timer_elapsed32(p->sent_at);
+        uint32_t wait    = elapsed < p->delay ? p->delay - elapsed : 0;
+        if (!any || wait < left) {
+            left = wait;
+            any  = true;
+        }
+    }
+    if (any) {
+        deadline_set(DEADLINE_RELIABLE, left, resend);
+    } else {
+        deadline_cancel(DEADLINE_RELIABLE);
+    }
+}
+
+static void give_up(pending_t *p) {
+    p->tries = 0;
+    reliable_lost_user(p->head[0]);
+}
+
+void reliable_send(const uint8_t *report) {
+    if (!is_channel(report[0]) || !(acking & CHANNEL_BIT(report[0]))) {
+        raw_hid_send((uint8_t *)report, HID_REPORT_SIZE);
+        return;
+    }
+
+    pending_t *slot = NULL;
+    for (uint8_t i = 0; i < RELIABLE_WINDOW; i++) {
+        pending_t *p = &pending[i];
+        if (!p->tries) {
+            slot = p;
+            break;
+        }
+        if (!slot || (uint16_t)(p->seq - slot->seq) > 0x8000) {
+            slot = p;  // Oldest so far, sequence numbers wrap
+        }
+    }
+    if (slot->tries) {
+        give_up(slot);  // Window full
+    }
+
+    const uint8_t *event = report + HID_TRACE_EVENT;
+    memcpy(slot->head, report, sizeof(slot->head));
+    slot->seq      = (uint16_t)report[HID_TRACE_SEQ] << 8 | report[HID_TRACE_SEQ + 1];
+    slot->event_at = (uint32_t)event[0] << 24 | (uint32_t)event[1] << 16 | (uint16_t)event[2] << 8 | event[3];
+    slot->delay    = RELIABLE_RETRY_MS;
+    transmit(slot);
+    arm();
+}
+
+void reliable_ack(uint8_t opcode, uint16_t seq) {
+    if (!is_channel(opcode)) {
+        return;
+    }
+    acking |= CHANNEL_BIT(opcode);
+    for (uint8_t i = 0; seq && i < RELIABLE_WINDOW; i++) {
+        pending_t *p = &pending[i];
+        if (p->tries && p->head[0] == opcode && p->seq == seq) {
+            p->tries = 0;
+        }
+    }
+    arm();
+}
+
+static void resend(deadline_id_t id) {
+    for (uint8_t i = 0; i < RELIABLE_WINDOW; i++) {
+        pending_t *p = &pending[i];
+        if (!p->tries || timer_elapsed32(p->sent_at) < p->delay) {
+            continue;
+        }
+        if (p->tries >= RELIABLE_TRIES) {
+            give_up(p);
+        } else {
+            p->delay *= 2;
+            transmit(p);
+        }
+    }
+    arm();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "quantum.h"
+#include "hid_protocol.h"
+
+// Acknowledged delivery of the button reports of HID_OP_VOLUME..HID_OP_LIFX.
+//
+// A channel turns reliable once its host script has sent a HID_CMD_ACK:
+// the hello (sequence 0) a script sends when it connects, or the ack of a
+// report. From then on each report given to reliable_send() is kept until
+// the script acks its HID_TRACE_SEQ, and sent again RELIABLE_RETRY_MS
+// later, then twice that, and so on for RELIABLE_TRIES sends in all. The
+// script drops the copies it has already handled, so a press acts once.
+// A report that runs out of tries, or is pushed out of the window by
+// newer ones, is handed to reliable_lost_user(). Channels never acked get
+// each report once, as before. Resends wait on DEADLINE_RELIABLE.
+
+#define RELIABLE_WINDOW   4    // Reports awaiting an ack
+#define RELIABLE_RETRY_MS 100  // Before the first resend, doubled for each next one
+#define RELIABLE_TRIES    4    // Sends of a report before it counts as lost
+
+// Send a stamped HID_REPORT_SIZE-byte report, and again until it is acked.
+// Only the command, its payload and the trace stamp are kept for resends:
+// bytes from HID_TRACE_LEN on are sent as zeros.
+void reliable_send(const uint8_t *report);
+
+// The script on opcode acked seq (0: its hello)
+void reliable_ack(uint8_t opcode, uint16_t seq);
+
+// Called with the opcode of a report the host never acked
+void reliable_lost_user(uint8_t opcode);
@@ -1,6 +1,14 @@
 ENCODER_MAP_ENABLE = no
 PIN_COMPATIBLE = promicro
 SRC += stubs.c
+SRC += macro_queue.c
+SRC += oled_view.c
+SRC += telemetry.c
+SRC += encoder_batch.c
+SRC += reliable.c
+SRC += toast.c
+SRC += deadline.c
+SRC += fmt.c
 OLED_ENABLE = yes
 OLED_DRIVER = ssd1306
 RAW_ENABLE = yes
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Host actions over raw HID vs typed into Win+R
+
+Runs action_agent.ActionAgent against fake_hid's FakeKeyboard with portable
+commands (this Python with -c) standing in for the bat files:
+
+    ok       exits 0 at once                  -> STARTED, DONE
+    fail     exits 1                          -> STARTED, FAILED
+    long     still running after the wait     -> STARTED, DONE
+    missing  no command on this platform      -> UNKNOWN
+
+For each it checks the results the keyboard receives and times the
+STARTED answer (the keyboard stops waiting then) and the final one. It
+then prints what the same actions cost the firmware without an agent: the
+keyboard reports Win+R typing needs for the command in apps.txt, and the
+shortest time they take at one report per scan plus the dialog delays.
+
+    python3 sim/action_bench.py [--runs N]
+"""
+
+import argparse
+import os
+import statistics
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+from action_agent import ActionAgent, APPS_FILE                      # noqa: E402
+from app_table import read_table, table_crc                          # noqa: E402
+from fake_hid import fake_pair                                       # noqa: E402
+from hid_protocol import (HID_REPORT_SIZE, HID_OP_ACTION, HID_ACTION_RUN, HID_ACTION_RESULT,  # noqa: E402
+                          HID_ACTION_HELLO, HID_ACTION_HELLO_COUNT, HID_ACTION_HELLO_CRC,
+                          HID_ACTION_ID, HID_ACTION_TAG, HID_ACTION_STATUS,
+                          HID_ACTION_STARTED, HID_ACTION_DONE, HID_ACTION_FAILED, HID_ACTION_UNKNOWN)
+
+# The bat file path execute_bat_file() types in front of every bat command
+BAT_DIR = "C:\\Users\\Renobatio\\qmk_firmware\\keyboards\\nullbitsco\\tidbit\\keymaps\\default\\"
+DIALOG_DELAY_MS = 150 + 50 + 50  # run_dialog_command(): after Win+R, Ctrl+A and before Enter
+SCAN_MS = 1                      # macro_queue_task() sends one report per matrix scan
+STATUS_NAMES = {HID_ACTION_STARTED: "STARTED", HID_ACTION_DONE: "DONE",
+                HID_ACTION_FAILED: "FAILED", HID_ACTION_UNKNOWN: "UNKNOWN"}
+
+# case: (action to borrow, command, results the keyboard must see)
+CASES = {
+    "ok":      ("VOLUME_START", "{python} -c pass", [HID_ACTION_STARTED, HID_ACTION_DONE]),
+    "fail":    ("VOLUME_KILL", "{python} -c \"raise SystemExit(1)\"", [HID_ACTION_STARTED, HID_ACTION_FAILED]),
+    "long":    ("LIFX_START", "{python} -c \"import time; time.sleep(3)\"", [HID_ACTION_STARTED, HID_ACTION_DONE]),
+    "missing": ("SHUTDOWN", None, [HID_ACTION_UNKNOWN]),
+}
+COMMAND_WAIT = 0.5  # Agent's wait before a running command counts as started
+
+
+def typed_reports(text):
+    """Keyboard reports send_string() needs: press and release, shift around capitals"""
+    return sum(4 if c.isupper() or c in ':"_' else 2 for c in text)
+
+
+def run_case(keyboard, agent, actions, case, tag):
+    ident, _, expected = CASES[case]
+    action_id = next(i for i, a in enumerate(actions) if a.ident == ident)
+    run = bytearray(HID_REPORT_SIZE)
+    run[0], run[1], run[HID_ACTION_ID], run[HID_ACTION_TAG] = HID_OP_ACTION, HID_ACTION_RUN, action_id, tag
+
+    started = time.perf_counter()
+    keyboard.send(run)
+    seen, times = [], []
+    while len(seen) < len(expected):
+        packet = keyboard.receive(timeout=COMMAND_WAIT * 4)
+        if packet is None:
+            break
+        if packet[0] != HID_OP_ACTION or packet[1] != HID_ACTION_RESULT:
+            continue  # A periodic hello
+        if packet[HID_ACTION_ID] != action_id or packet[HID_ACTION_TAG] != tag:
+            raise SystemExit(f"{case}: result for action {packet[HID_ACTION_ID]} tag {packet[HID_ACTION_TAG]}")
+        seen.append(packet[HID_ACTION_STATUS])
+        times.append((time.perf_counter() - started) * 1000)
+    if seen != expected:
+        names = lambda statuses: " ".join(STATUS_NAMES.get(s, str(s)) for s in statuses)  # noqa: E731
+        raise SystemExit(f"{case}: keyboard got [{names(seen)}], expected [{names(expected)}]")
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--runs", type=int, default=5, help="runs of each case")
+    args = parser.parse_args()
+
+    _, actions = read_table(APPS_FILE)
+    python = f'"{sys.executable}"'
+    commands = {ident: command.format(python=python) for ident, command, _ in CASES.values() if command}
+
+    host, keyboard = fake_pair()
+    agent = ActionAgent(host, actions, commands, hello_interval=60, command_wait=COMMAND_WAIT,
+                        log=lambda message: None).start()
+    hello = keyboard.receive()
+    if (not hello or hello[1] != HID_ACTION_HELLO or hello[HID_ACTION_HELLO_COUNT] != len(actions)
+            or hello[HID_ACTION_HELLO_CRC] != table_crc(actions)):
+        raise SystemExit("agent did not announce the apps.txt table")
+
+    # The agent reads nothing itself here: hand it each report like main() does
+    reader_stop = []
+
+    def pump():
+        while not reader_stop:
+            data = host.read(HID_REPORT_SIZE, timeout_ms=100)
+            if data:
+                agent.handle(data)
+
+    reader = threading.Thread(target=pump, daemon=True)
+    reader.start()
+
+    print(f"{len(actions)} actions, table CRC 0x{table_crc(actions):02X}, {args.runs} runs per case\n")
+    print(f"{'case':<8} {'results':<16} {'answer ms':>10} {'final ms':>9}")
+    tag = 0
+    for case in CASES:
+        first, last = [], []
+        for _ in range(args.runs):
+            tag = (tag + 1) & 0xFF
+            times = run_case(keyboard, agent, actions, case, tag)
+            first.append(times[0])
+            last.append(times[-1])
+        results = "+".join(STATUS_NAMES[s] for s in CASES[case][2])
+        print(f"{case:<8} {results:<16} {statistics.median(first):>10.2f} {statistics.median(last):>9.2f}")
+
+    reader_stop.append(True)
+    reader.join()
+    agent.stop()
+
+    print("\nper action: 1 HID report with the agent; typed into Win+R without it:\n")
+    print(f"{'action':<20} {'reports':>8} {'min ms':>7}")
+    total = 0
+    for action in actions:
+        text = (BAT_DIR if action.bat else "") + action.command
+        reports = 3 * 2 + typed_reports(text)  # Win+R, Ctrl+A and Enter taps, then the text
+        total += reports
+        print(f"{action.ident:<20} {reports:>8} {reports * SCAN_MS + DIALOG_DELAY_MS:>7}")
+    print(f"{'mean':<20} {total / len(actions):>8.0f} {total / len(actions) * SCAN_MS + DIALOG_DELAY_MS:>7.0f}")
+    keyboard.close()
+    host.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+HID broker routing and counters, through an in-process broker on a fake keyboard
+
+Three clients subscribe to overlapping opcodes and a fourth stalls: its
+socket send blocks, as if the script stopped reading, so its reports pile
+up in the broker's queue until it disconnects. The fake keyboard then sends
+volume, Discord and action reports (nobody subscribes to the last), and the
+bench checks:
+
+    demux    every client gets the reports of its opcodes, in order, and
+             no others
+    fan-out  a report subscribed twice is delivered twice
+    stats    routed, delivered, dropped and queue depth of every channel,
+             with the stalled client's lost reports each counted on its
+             own opcode when it goes, and clients that hang up as soon
+             as they connect dropped too
+
+It prints the channel counters and fails on any difference.
+
+    python3 sim/broker_bench.py [-n REPORTS]
+"""
+
+import argparse
+import os
+import socket
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+import hid_broker                                                  # noqa: E402
+from fake_hid import fake_pair                                     # noqa: E402
+from hid_client import HidClient, MSG_SUBSCRIBE, send_msg          # noqa: E402
+from hid_protocol import HID_OP_VOLUME, HID_OP_DISCORD, HID_OP_LIFX, HID_OP_ACTION  # noqa: E402
+
+TIMEOUT = 5.0  # Seconds to wait for anything to arrive
+FLEETING = 20  # Clients that disconnect as soon as they connect
+CLIENTS = (      # Name, subscribed opcodes
+    ("volume", {HID_OP_VOLUME}),
+    ("volume+discord", {HID_OP_VOLUME, HID_OP_DISCORD}),
+    ("lifx", {HID_OP_LIFX}),
+)
+
+
+class StalledSends:
+    """Stands in for hid_broker.send_msg; sends to the stalled sockets block until release()"""
+
+    def __init__(self):
+        self.send_msg = hid_broker.send_msg
+        self.socks = set()
+        self.gate = threading.Event()
+        self.blocked = threading.Event()  # A sender is stuck on the gate
+
+    def __call__(self, sock, kind, payload=b''):
+        if sock in self.socks:
+            self.blocked.set()
+            self.gate.wait()
+        self.send_msg(sock, kind, payload)
+
+    def release(self):
+        self.gate.set()
+
+
+def wait_for(condition, what):
+    deadline = time.monotonic() + TIMEOUT
+    while not condition():
+        if time.monotonic() > deadline:
+            raise SystemExit(f"timed out waiting for {what}")
+        time.sleep(0.005)
+
+
+def peer(subscriber):
+    """Address of a subscriber's client, None once the broker closed its socket"""
+    try:
+        return subscriber.sock.getpeername()
+    except OSError:
+        return None
+
+
+def read_all(client, count):
+    """count reports from a client, then check that no more come"""
+    reports = []
+    while len(reports) < count:
+        data = client.read(timeout_ms=int(TIMEOUT * 1000))
+        if not data:
+            break
+        reports.append(bytes(data[:2]))
+    extra = client.read(timeout_ms=100)
+    if extra:
+        reports.append(bytes(extra[:2]))
+    return reports
+
+
+def run(count):
+    """Send count reports of each opcode; returns (sent, received per client, stats)"""
+    stalled = StalledSends()
+    hid_broker.send_msg = stalled
+    device, keyboard = fake_pair()
+    broker = hid_broker.Broker(lambda: device, port=0).start()
+    try:
+        broker.connected.wait(2)
+        clients = {name: HidClient(opcodes, port=broker.port, start_broker=False) for name, opcodes in CLIENTS}
+
+        # The stalled client speaks the protocol by hand, so nothing reads its socket
+        stuck = socket.create_connection(("127.0.0.1", broker.port))
+        send_msg(stuck, MSG_SUBSCRIBE, bytes([HID_OP_VOLUME, HID_OP_DISCORD]))
+        wait_for(lambda: len(broker.subscribers) == 4 and all(s.opcodes for s in broker.subscribers),
+                 "the clients to subscribe")
+        stalled.socks.update(s.sock for s in broker.subscribers if s.sock.getpeername() == stuck.getsockname())
+
+        sent = []
+        for i in range(count):
+            for opcode in (HID_OP_VOLUME, HID_OP_DISCORD, HID_OP_ACTION):
+                keyboard.send([opcode, i])
+                sent.append(bytes([opcode, i]))
+        received = {name: read_all(clients[name], len(expected(sent, opcodes))) for name, opcodes in CLIENTS}
+        wait_for(lambda: broker.stats()['channels'].get(f"0x{HID_OP_ACTION:02X}", {}).get('routed') == count,
+                 "the keyboard's reports")
+
+        # The stalled client goes away with one report in its sender and the rest queued
+        stalled.blocked.wait(TIMEOUT)
+        stuck.close()
+        wait_for(lambda: all(sock.fileno() == -1 for sock in stalled.socks), "the stalled client to be dropped")
+        stalled.release()
+        wait_for(lambda: all(c['queue_depth'] == 0 for c in broker.stats()['channels'].values()),
+                 "the queues to empty")
+
+        # Clients that hang up as soon as they connect must not stay listed.
+        # Connections are accepted in order: once a last one that stays is
+        # listed, every one before it has been through accept.
+        for _ in range(FLEETING):
+            socket.create_connection(("127.0.0.1", broker.port)).close()
+        last = socket.create_connection(("127.0.0.1", broker.port))
+        wait_for(lambda: any(peer(s) == last.getsockname() for s in list(broker.subscribers)),
+                 "the last client to be accepted")
+        last.close()
+        wait_for(lambda: len(broker.subscribers) == len(CLIENTS), "the clients that hung up to be dropped")
+        stats = clients["volume"].stats()
+        for client in clients.values():
+            client.close()
+    finally:
+        hid_broker.send_msg = stalled.send_msg
+        broker.stop()
+        keyboard.close()
+    return sent, received, stats
+
+
+def expected(sent, opcodes):
+    return [report for report in sent if report[0] in opcodes]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("-n", "--reports", type=int, default=20,
+                        help=f"reports of each opcode, at most {hid_broker.SUBSCRIBER_QUEUE // 2}")
+    args = parser.parse_args()
+    count = min(args.reports, hid_broker.SUBSCRIBER_QUEUE // 2)  # The stalled queue must not overflow
+
+    sent, received, stats = run(count)
+    failures = []
+
+    print(f"{count} reports each of 0x{HID_OP_VOLUME:02X}, 0x{HID_OP_DISCORD:02X} and 0x{HID_OP_ACTION:02X}\n")
+    print(f"{'client':<16} {'opcodes':<12} {'received':>8}")
+    for name, opcodes in CLIENTS:
+        print(f"{name:<16} {' '.join(f'0x{op:02X}' for op in sorted(opcodes)):<12} {len(received[name]):>8}")
+        if received[name] != expected(sent, opcodes):
+            failures.append(f"{name} received the wrong reports or order")
+
+    # Delivered to each subscriber that kept reading; the stalled one loses
+    # every volume and Discord report, each on its own channel
+    want = {
+        HID_OP_VOLUME: dict(routed=count, delivered=2 * count, dropped=count),
+        HID_OP_DISCORD: dict(routed=count, delivered=count, dropped=count),
+        HID_OP_ACTION: dict(routed=count, delivered=0, dropped=count),
+    }
+    print(f"\n{'channel':<8} {'routed':>7} {'delivered':>10} {'dropped':>8} {'depth':>6} {'depth max':>10}")
+    for opcode, counts in want.items():
+        channel = stats['channels'].get(f"0x{opcode:02X}", {})
+        print(f"0x{opcode:02X}     {channel.get('routed', 0):>7} {channel.get('delivered', 0):>10} "
+              f"{channel.get('dropped', 0):>8} {channel.get('queue_depth', 0):>6} {channel.get('queue_depth_max', 0):>10}")
+        for key, value in counts.items():
+            if channel.get(key) != value:
+                failures.append(f"0x{opcode:02X} {key} is {channel.get(key)}, expected {value}")
+        if channel.get('queue_depth') != 0:
+            failures.append(f"0x{opcode:02X} queue depth is {channel.get('queue_depth')} with nothing queued")
+    if stats['clients'] != 3:
+        failures.append(f"{stats['clients']} clients connected, expected the 3 that kept reading")
+
+    if failures:
+        raise SystemExit("\n" + "\n".join(failures))
+    print("\nbroker routing and counters as expected")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+OLED update traffic from the host scripts, direct writes vs DisplayChannel
+
+Replays bursts of display updates on a simulated clock and counts the
+reports written to the keyboard:
+
+    scroll  the Discord roster scrolled one user every 8 ms (v2 firmware or
+            a fast hand), 60 users
+    raid    25 people joining voice within 150 ms, each changing the count
+    status  LIFX status messages while the lamp is found and toggled
+    mixed   all three at once, sharing one script's frame budget
+
+    direct  every update written at once (discord_voice_control.py and
+            lifx_control.py before the display channel)
+    channel DisplayChannel at --fps, last value wins per display slot
+
+"settle ms" is how long after the last update its frame was written, i.e.
+how late the OLED shows the final state.
+
+Then a replug: after reset(), as on the version reply the broker asks for
+when the keyboard connects, each slot's last frame must be written again
+with its next sequence number, and nothing else. It fails on any difference.
+
+    python3 sim/display_bench.py [--fps N]
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+from display_channel import DisplayChannel                                   # noqa: E402
+from hid_protocol import (HID_DISPLAY_SEQ, discord_user_report,              # noqa: E402
+                          lifx_status_report, display_slot)
+
+
+class RecordingKeyboard:
+    def __init__(self):
+        self.now = 0.0
+        self.frames = []   # (time, report)
+
+    def write(self, data):
+        self.frames.append((self.now, bytes(data)))
+        return len(data)
+
+
+def scroll(start=0.0):
+    return [(start + i * 0.008, discord_user_report(i % 60, 60, f"user{i % 60}")) for i in range(60)]
+
+
+def raid(start=0.0):
+    return [(start + i * 0.006, discord_user_report(0, 5 + i, "alice")) for i in range(25)]
+
+
+def status(start=0.0):
+    messages = ["Searching...", "Found: Desk Light", "Lamp on", "Lamp off", "Lamp on"]
+    return [(start + i * 0.03, lifx_status_report(m)) for i, m in enumerate(messages)]
+
+
+WORKLOADS = {
+    "scroll": scroll(),
+    "raid": raid(),
+    "status": status(),
+    "mixed": sorted(scroll() + raid(0.1) + status(0.05), key=lambda e: e[0]),
+}
+
+
+def run_direct(updates):
+    keyboard = RecordingKeyboard()
+    for at, report in updates:
+        keyboard.now = at
+        keyboard.write(report)
+    return keyboard.frames, 0
+
+
+def run_channel(updates, fps):
+    keyboard = RecordingKeyboard()
+    channel = DisplayChannel(keyboard, max_fps=fps, clock=lambda: keyboard.now)
+    wake = None
+    events = list(updates)
+    while events or wake is not None:
+        if events and (wake is None or events[0][0] <= wake):
+            keyboard.now, report = events.pop(0)
+            channel.post(report)
+        else:
+            keyboard.now = wake
+        wait = channel.pump()
+        wake = None if wait is None else keyboard.now + wait
+    return keyboard.frames, channel.stats()['superseded']
+
+
+def drain(channel, keyboard):
+    """Pump until nothing is pending; returns the reports written"""
+    start = len(keyboard.frames)
+    while (wait := channel.pump()) is not None:
+        keyboard.now += wait
+    return [report for _, report in keyboard.frames[start:]]
+
+
+def replug(fps):
+    """Frames written by reset() after a user, a status and a repeated user; failures"""
+    keyboard = RecordingKeyboard()
+    channel = DisplayChannel(keyboard, max_fps=fps, clock=lambda: keyboard.now)
+    user, lamp = discord_user_report(1, 3, "alice"), lifx_status_report("Lamp on")
+    for report in (user, lamp, user):
+        channel.post(report)
+        drain(channel, keyboard)
+    before = [report for _, report in keyboard.frames]
+    channel.reset()
+    frames = drain(channel, keyboard)
+    channel.post(user)  # The script showing the same user again after the replug
+    frames += drain(channel, keyboard)
+
+    print(f"\nreplug: {len(before)} frames before, {len(frames)} after reset()")
+    failures = []
+    resent = {display_slot(f): f for f in frames}
+    for report, last in ((user, before[0]), (lamp, before[1])):
+        frame = resent.get(display_slot(report))
+        if len(frames) != 2 or frame is None or frame[1:1 + HID_DISPLAY_SEQ] != report[1:1 + HID_DISPLAY_SEQ]:
+            failures.append(f"reset() wrote {[f[1:3].hex() for f in frames]}, expected the user and the status once each")
+            break
+        if frame[1 + HID_DISPLAY_SEQ] != last[1 + HID_DISPLAY_SEQ] + 1:
+            failures.append(f"slot {display_slot(report)} resent with sequence {frame[1 + HID_DISPLAY_SEQ]}, "
+                            f"expected {last[1 + HID_DISPLAY_SEQ] + 1}")
+    return failures
+
+
+def settle(updates, frames):
+    """Worst delay between a slot's last update and the frame that showed it"""
+    worst = 0.0
+    last = {}
+    for at, report in updates:
+        last[display_slot(report)] = (at, report)
+    for slot, (at, report) in last.items():
+        shown = [t for t, f in frames if display_slot(f) == slot and f[1:1 + HID_DISPLAY_SEQ] == report[1:1 + HID_DISPLAY_SEQ]]
+        worst = max(worst, shown[-1] - at)
+    return worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--fps", type=float, default=20)
+    args = parser.parse_args()
+
+    print(f"{'burst':<7} {'updates':>7}   {'direct':>6}   {'channel':>7} {'superseded':>10} {'settle ms':>9}")
+    for name, updates in WORKLOADS.items():
+        direct, _ = run_direct(updates)
+        frames, superseded = run_channel(updates, args.fps)
+        print(f"{name:<7} {len(updates):>7}   {len(direct):>6}   {len(frames):>7} {superseded:>10} "
+              f"{1000 * settle(updates, frames):>9.1f}")
+    print(f"\nchannel capped at {args.fps:g} frames/s; direct settles at 0 ms by definition")
+
+    failures = replug(args.fps)
+    if failures:
+        raise SystemExit("\n" + "\n".join(failures))
+    print("display channel redraws as expected")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Replays a fast encoder spin through the firmware and a model of the host
+
+A 50-detent spin of the LIFX encoder is run through ./tidbit_sim, and the
+raw HID reports it logs are fed to the host side one at a time, as
+lifx_control.py handles them: each report with steps costs one get_color
+plus one set_color round trip to the lamp, and the next report waits for
+the previous one to finish. The same spin sent the v2 way (one HID_CMD_CW
+report per detent) is replayed for comparison.
+
+    python3 sim/encoder_replay.py [-n DETENTS] [--rtt MS]
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, ".."))
+
+from hid_protocol import HID_OP_LIFX, HID_CMD_CW, encoder_steps  # noqa: E402
+
+SIM = os.path.join(HERE, "tidbit_sim")
+LIFX_ENCODER = 3
+START_MS = 100
+INTERVALS_MS = (4, 8, 15, 30, 60)  # Spin speeds, ms per detent
+
+
+def firmware_reports(detents, interval_ms):
+    """(ms, report) pairs the firmware sends for the spin"""
+    end = START_MS + detents * interval_ms + 500
+    with tempfile.TemporaryDirectory() as tmp:
+        scenario = os.path.join(tmp, "spin.txt")
+        log = os.path.join(tmp, "hid.log")
+        with open(scenario, "w") as f:
+            f.write(f"@{START_MS} encoder {LIFX_ENCODER} cw {detents} {interval_ms}\n@{end} end\n")
+        subprocess.run([SIM, "-n", "-l", log, scenario], check=True, stdout=subprocess.DEVNULL)
+        reports = []
+        with open(log) as f:
+            for line in f:
+                fields = line.split()
+                reports.append((int(fields[0]), [int(b, 16) for b in fields[1:]]))
+    return [(ms, r) for ms, r in reports if r[0] == HID_OP_LIFX]
+
+
+def legacy_reports(detents, interval_ms):
+    """What v2 firmware sent: one report per detent"""
+    return [(START_MS + i * interval_ms, [HID_OP_LIFX, HID_CMD_CW]) for i in range(detents)]
+
+
+def replay(reports, call_ms):
+    """Host calls, steps applied and the time the host caught up"""
+    calls = steps = 0
+    busy_until = 0
+    for ms, report in reports:
+        delta = encoder_steps(report)
+        if delta:
+            busy_until = max(ms, busy_until) + call_ms
+            calls += 1
+            steps += delta
+    return calls, steps, busy_until
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("-n", "--detents", type=int, default=50)
+    parser.add_argument("--rtt", type=float, default=25, help="LIFX LAN round trip, ms")
+    args = parser.parse_args()
+
+    if not os.path.exists(SIM):
+        subprocess.run(["make", "-s", "-C", HERE, "tidbit_sim"], check=True)
+
+    call_ms = 2 * args.rtt  # get_color + set_color
+    print(f"{args.detents}-detent spin of encoder {LIFX_ENCODER}, host call = 2 x {args.rtt:g} ms round trip\n")
+    print(f"{'ms/detent':>9} {'reports':>13} {'host calls':>13} {'lamp lag ms':>15} {'steps':>11}")
+    print(f"{'':>9} {'v2':>6} {'v3':>6} {'v2':>6} {'v3':>6} {'v2':>7} {'v3':>7} {'v2':>5} {'v3':>5}")
+    for interval in INTERVALS_MS:
+        old, new = legacy_reports(args.detents, interval), firmware_reports(args.detents, interval)
+        spin_end = START_MS + (args.detents - 1) * interval
+        old_calls, old_steps, old_done = replay(old, call_ms)
+        new_calls, new_steps, new_done = replay(new, call_ms)
+        print(f"{interval:>9} {len(old):>6} {len(new):>6} {old_calls:>6} {new_calls:>6} "
+              f"{old_done - spin_end:>7.0f} {new_done - spin_end:>7.0f} {old_steps:>5} {new_steps:>5}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,108 @@
+// Time of the OLED text formatting, snprintf vs fmt.c.
+//
+// Formats the monitor screen's four lines and the Discord "[i/n]" line the
+// way oled_task_user() does, once with the snprintf calls it used to make
+// and once with fmt.c, over a sweep of values. Checks that both give the
+// same text, then prints host nanoseconds per frame. The flash side is
+// printed by "make fmt-bench": fmt.c's code size and the firmware sources
+// that still call a printf.
+//
+// usage: fmt_bench [frames]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "quantum.h"
+#include "fmt.h"
+
+#define LINES     5
+#define LINE_SIZE 22
+
+typedef struct {
+    uint16_t cpu, gpu, mem, ping;
+    uint8_t  index, total;
+} frame_t;
+
+static void frame_snprintf(const frame_t *f, char out[LINES][LINE_SIZE]) {
+    snprintf(out[0], LINE_SIZE, "CPU: %3u%%", f->cpu);
+    snprintf(out[1], LINE_SIZE, "GPU: %3u%%", f->gpu);
+    snprintf(out[2], LINE_SIZE, "MEM: %3u%%", f->mem);
+    snprintf(out[3], LINE_SIZE, "MS : %3ums", f->ping);
+    snprintf(out[4], LINE_SIZE, "[%d/%d]", f->index + 1, f->total);
+}
+
+static void metric(char *buf, const char *label_P, uint16_t value, const char *unit_P) {
+    char *p = fmt_P(buf, label_P);
+    p = fmt_uint(p, value, 3);
+    fmt_P(p, unit_P);
+}
+
+static void frame_fmt(const frame_t *f, char out[LINES][LINE_SIZE]) {
+    metric(out[0], PSTR("CPU: "), f->cpu, PSTR("%"));
+    metric(out[1], PSTR("GPU: "), f->gpu, PSTR("%"));
+    metric(out[2], PSTR("MEM: "), f->mem, PSTR("%"));
+    metric(out[3], PSTR("MS : "), f->ping, PSTR("ms"));
+    char *p = fmt_P(out[4], PSTR("["));
+    p = fmt_uint(p, f->index + 1, 0);
+    p = fmt_P(p, PSTR("/"));
+    p = fmt_uint(p, f->total, 0);
+    fmt_P(p, PSTR("]"));
+}
+
+// Values from 0 to beyond the 3-column field, pings up to the u16 maximum
+static frame_t frame_at(unsigned i) {
+    frame_t f = {
+        .cpu   = i % 101,
+        .gpu   = (i * 7) % 101,
+        .mem   = (i * 13) % 1200,
+        .ping  = (uint16_t)(i * 2654435761u >> 16),
+        .index = (uint8_t)(i % 250),
+        .total = 250,
+    };
+    return f;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static volatile char sink;
+
+static double time_frames(void (*format)(const frame_t *, char[LINES][LINE_SIZE]), unsigned frames) {
+    char     out[LINES][LINE_SIZE];
+    uint64_t t0 = now_ns();
+    for (unsigned i = 0; i < frames; i++) {
+        frame_t f = frame_at(i);
+        format(&f, out);
+        sink = out[i % LINES][0];
+    }
+    return (double)(now_ns() - t0) / frames;
+}
+
+int main(int argc, char **argv) {
+    unsigned frames = argc > 1 ? (unsigned)atoi(argv[1]) : 200000;
+    if (!frames) frames = 1;
+
+    for (unsigned i = 0; i < 70000; i++) {
+        char    a[LINES][LINE_SIZE], b[LINES][LINE_SIZE];
+        frame_t f = frame_at(i);
+        frame_snprintf(&f, a);
+        frame_fmt(&f, b);
+        for (int line = 0; line < LINES; line++) {
+            if (strcmp(a[line], b[line])) {
+                fprintf(stderr, "frame %u line %d: snprintf \"%s\", fmt \"%s\"\n", i, line, a[line], b[line]);
+                return 1;
+            }
+        }
+    }
+
+    double printf_ns = time_frames(frame_snprintf, frames);
+    double fmt_ns    = time_frames(frame_fmt, frames);
+    printf("%u frames of the monitor and Discord count lines, host ns per frame\n\n", frames);
+    printf("%-10s %9.0f\n%-10s %9.0f\n", "snprintf", printf_ns, "fmt.c", fmt_ns);
+    printf("\nfmt.c is %.1fx faster on this host\n", printf_ns / fmt_ns);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+Encoder-to-handler latency of the host HID listeners, against a fake keyboard
+
+Replays the same encoder reports through three listener styles and reports
+how long each report took from raw_hid_send() (FakeKeyboard.send) to the
+handler, plus the CPU the listener burns while the keyboard is idle:
+
+    poll     the old loop: read(timeout_ms=100) then sleep(0.01), on the device
+    thread   HidClient.read() blocking, through an in-process hid_broker
+    asyncio  await HidClient.read_async(), through an in-process hid_broker
+
+Each style runs in its own process so idle CPU is not mixed up.
+
+    python3 sim/hid_latency.py [-n EVENTS] [--idle SECONDS]
+"""
+
+import argparse
+import asyncio
+import json
+import os
+import random
+import subprocess
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+from fake_hid import fake_pair                   # noqa: E402
+from hid_protocol import HID_OP_VOLUME, HID_CMD_CW  # noqa: E402
+
+MODES = ("poll", "thread", "asyncio")
+GAP_MS = (2, 40)  # Random spacing between encoder detents
+
+
+class Listener:
+    """Common bookkeeping: send times in, handler times out"""
+
+    def __init__(self):
+        self.keyboard = None
+        self.sent = {}
+        self.latencies = []
+        self.done = threading.Event()
+        self.expected = 0
+        self.wakeups = 0
+
+    def handle(self, data):
+        now = time.perf_counter()
+        if data and data[0] == HID_OP_VOLUME:
+            seq = data[2] | data[3] << 8
+            self.latencies.append(now - self.sent.pop(seq))
+            if len(self.latencies) == self.expected:
+                self.done.set()
+
+    def inject(self, events):
+        self.expected = events
+        for seq in range(events):
+            time.sleep(random.uniform(*GAP_MS) / 1000)
+            self.sent[seq] = time.perf_counter()
+            self.keyboard.send([HID_OP_VOLUME, HID_CMD_CW, seq & 0xFF, seq >> 8])
+        self.done.wait(10)
+
+
+def start_poll(listener):
+    device, listener.keyboard = fake_pair()
+
+    def loop():
+        while True:
+            listener.wakeups += 1
+            data = device.read(33, timeout_ms=100)
+            listener.handle(data)
+            time.sleep(0.01)
+
+    threading.Thread(target=loop, daemon=True).start()
+
+
+def _broker_client(listener):
+    from hid_broker import Broker
+    from hid_client import HidClient
+    device, listener.keyboard = fake_pair()
+    broker = Broker(lambda: device, port=0).start()
+    broker.connected.wait(2)
+    return HidClient([HID_OP_VOLUME], port=broker.port, start_broker=False)
+
+
+def start_thread(listener):
+    client = _broker_client(listener)
+
+    def loop():
+        while True:
+            listener.wakeups += 1
+            listener.handle(client.read(33))
+
+    threading.Thread(target=loop, daemon=True).start()
+
+
+def start_asyncio(listener):
+    client = _broker_client(listener)
+
+    async def loop():
+        while True:
+            listener.wakeups += 1
+            listener.handle(await client.read_async(33))
+
+    threading.Thread(target=lambda: asyncio.run(loop()), daemon=True).start()
+
+
+def run_mode(mode, events, idle):
+    random.seed(1)
+    listener = Listener()
+    globals()["start_" + mode](listener)
+    time.sleep(0.2)  # Let the listener and broker settle
+
+    wakeups = listener.wakeups
+    cpu = time.process_time()
+    time.sleep(idle)
+    idle_cpu = time.process_time() - cpu
+    idle_wakeups = listener.wakeups - wakeups
+
+    listener.inject(events)
+    lat = sorted(listener.latencies)
+    return {
+        'mode': mode,
+        'events': len(lat),
+        'avg_ms': 1000 * sum(lat) / len(lat) if lat else 0,
+        'p50_ms': 1000 * lat[len(lat) // 2] if lat else 0,
+        'p99_ms': 1000 * lat[min(len(lat) - 1, len(lat) * 99 // 100)] if lat else 0,
+        'max_ms': 1000 * lat[-1] if lat else 0,
+        'idle_cpu_pct': 100 * idle_cpu / idle,
+        'idle_wakeups_s': idle_wakeups / idle,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("-n", "--events", type=int, default=300)
+    parser.add_argument("--idle", type=float, default=2.0, help="seconds of idle CPU sampling")
+    parser.add_argument("--mode", choices=MODES, help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.mode:
+        print(json.dumps(run_mode(args.mode, args.events, args.idle)))
+        return
+
+    print(f"{args.events} encoder reports, {GAP_MS[0]}-{GAP_MS[1]} ms apart; idle sampled for {args.idle:g} s\n")
+    print(f"{'listener':<9} {'avg ms':>8} {'p50 ms':>8} {'p99 ms':>8} {'max ms':>8} {'idle cpu':>9} {'wakeups/s':>10}")
+    for mode in MODES:
+        out = subprocess.run([sys.executable, __file__, "--mode", mode, "-n", str(args.events),
+                              "--idle", str(args.idle)], capture_output=True, text=True, check=True)
+        r = json.loads(out.stdout.strip().splitlines()[-1])
+        print(f"{mode:<9} {r['avg_ms']:8.3f} {r['p50_ms']:8.3f} {r['p99_ms']:8.3f} {r['max_ms']:8.3f} "
+              f"{r['idle_cpu_pct']:8.2f}% {r['idle_wakeups_s']:10.1f}")
+
+
+if __name__ == "__main__":
+    main()
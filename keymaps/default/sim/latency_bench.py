@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+PingProvider and latency_probe.py against local targets, through MetricsEngine
+
+    answering  a listener on 127.0.0.1 that accepts and drops connections
+    refused    a free port with nothing listening: the reset is a reply
+    timeout    a listener whose accept queue is full, so handshakes hang
+               until the probe's timeout
+
+Each runs a MetricsEngine with only the ping provider, probing every
+INTERVAL, and checks the HID_METRIC_PING value the engine holds against the
+probe's window: the last probe's RTT rounded, and at least 1 ms, when the
+target answers, with no loss and a loopback-sized RTT; 0 and 100% loss when
+every probe times out, each probe taking the timeout. The provider's own
+samples must stay fast throughout, the probing runs on a thread of its own.
+It fails on any difference.
+
+    python3 sim/latency_bench.py [--seconds S]
+"""
+
+import argparse
+import os
+import socket
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+from hid_protocol import HID_METRIC_PING           # noqa: E402
+from latency_probe import _local_listener          # noqa: E402
+from metrics import MetricsEngine, PingProvider    # noqa: E402
+
+INTERVAL = 0.1      # Seconds between probes, and their timeout
+LOOPBACK_MS = 20.0  # Slowest RTT believable on 127.0.0.1
+SAMPLE_MS = 20.0    # Slowest provider sample accepted
+
+
+class BenchPing(PingProvider):
+    interval = INTERVAL
+
+
+def refused_target():
+    """A port on 127.0.0.1 that nothing listens on"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.bind(('127.0.0.1', 0))
+    target = sock.getsockname()
+    sock.close()
+    return target
+
+
+def full_listener():
+    """(listener, connection filling its accept queue); further connects hang"""
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.bind(('127.0.0.1', 0))
+    listener.listen(0)
+    filler = socket.create_connection(listener.getsockname())
+    return listener, filler
+
+
+def measure(target, seconds):
+    """(engine ping value, probe snapshot, provider stats, seconds per probe)"""
+    provider = BenchPing(target)
+    engine = MetricsEngine([provider]).start()
+    started = time.monotonic()
+    try:
+        time.sleep(seconds)
+    finally:
+        engine.stop()
+    snapshot = provider.probe.snapshot()
+    return (engine.latest().get(HID_METRIC_PING), snapshot, engine.provider_stats()["ping"],
+            (time.monotonic() - started) / max(1, snapshot.sent))
+
+
+def check(name, value, snapshot, stats, per_probe, answers):
+    failures = []
+    if snapshot.sent < 3:
+        failures.append(f"{name}: only {snapshot.sent} probes sent")
+    if stats['sample_max_ms'] > SAMPLE_MS:
+        failures.append(f"{name}: a provider sample took {stats['sample_max_ms']} ms")
+    if answers:
+        if snapshot.loss != 0.0 or snapshot.last is None:
+            failures.append(f"{name}: {snapshot.loss}% loss from a target that answers")
+        elif value != max(1, int(round(snapshot.last))):
+            failures.append(f"{name}: engine holds {value}, the last probe took {snapshot.last:.3f} ms")
+        elif not 0 <= snapshot.min <= snapshot.avg <= snapshot.p95 <= LOOPBACK_MS:
+            failures.append(f"{name}: RTT min {snapshot.min} avg {snapshot.avg} p95 {snapshot.p95} ms")
+    else:
+        if value != 0:
+            failures.append(f"{name}: engine holds {value} for a target that does not answer")
+        if snapshot.loss != 100.0 or snapshot.last is not None or snapshot.avg is not None:
+            failures.append(f"{name}: loss {snapshot.loss}%, last {snapshot.last}, avg {snapshot.avg}")
+        if per_probe < INTERVAL * 0.9:
+            failures.append(f"{name}: probes gave up after {per_probe * 1000:.0f} ms, before the timeout")
+    return failures
+
+
+def _fmt(value):
+    return "     -" if value is None else f"{value:6.3f}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--seconds", type=float, default=0.6, help="seconds to probe each target")
+    args = parser.parse_args()
+
+    answering = _local_listener()
+    full, filler = full_listener()
+    cases = (
+        ("answering", answering.getsockname(), True),
+        ("refused", refused_target(), True),
+        ("timeout", full.getsockname(), False),
+    )
+
+    failures = []
+    print(f"probing every {INTERVAL * 1000:.0f} ms for {args.seconds:g} s\n")
+    print(f"{'target':<10} {'sent':>4} {'last ms':>8} {'avg ms':>7} {'p95 ms':>7} {'loss':>6} "
+          f"{'engine':>6} {'sample max ms':>14}")
+    for name, target, answers in cases:
+        value, snapshot, stats, per_probe = measure(target, args.seconds)
+        print(f"{name:<10} {snapshot.sent:>4} {_fmt(snapshot.last):>8} {_fmt(snapshot.avg):>7} "
+              f"{_fmt(snapshot.p95):>7} {snapshot.loss:5.1f}% {value!s:>6} {stats['sample_max_ms']:>14.3f}")
+        failures += check(name, value, snapshot, stats, per_probe, answers)
+
+    for sock in (answering, full, filler):
+        sock.close()
+    if failures:
+        raise SystemExit("\n" + "\n".join(failures))
+    print("\nping values as expected")
+
+
+if __name__ == "__main__":
+    main()
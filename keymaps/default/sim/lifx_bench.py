@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+LIFX brightness control over a simulated Wi-Fi link, round trips vs local model
+
+Runs lifx_lan.FakeBulb on 127.0.0.1 with a delay standing in for the Wi-Fi
+round trip (and optional packet loss), then turns the brightness by
+--detents reports --gap ms apart, as the HID loop of lifx_control.py
+receives them:
+
+    lifxlan  before the local model: get_color() then set_color() per
+             report, each waiting for the bulb's answer (retried on loss)
+    model    lifx_lan.Lamp: the step is applied locally and the newest
+             target sent by the background thread, without an answer
+
+It prints how long the HID loop was busy, the datagrams sent, the reads
+(LightGet) the bulb answered, how long after the last detent the bulb
+showed the final brightness and whether it did; then the startup cost of
+broadcast discovery vs the cached address. The model must not read the
+bulb during the turn: its resync runs every RESYNC_INTERVAL, not per
+detent.
+
+    python3 sim/lifx_bench.py [--detents N] [--gap MS] [--rtt MS] [--loss PCT]
+"""
+
+import argparse
+import os
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+import lifx_lan                                                      # noqa: E402
+from lifx_lan import (FakeBulb, Lamp, Transport, BulbState, find_lamp,  # noqa: E402
+                      LIGHT_GET, LIGHT_SET_COLOR, LIGHT_STATE)
+
+STEP = 6553  # BRIGHTNESS_STEP of lifx_control.py
+
+
+def old_adjust(transport, bulb, direction):
+    """adjust_brightness() on lifxlan: a read and an acknowledged write"""
+    reply = transport.request(bulb.address, LIGHT_GET, LIGHT_STATE, mac=bulb.mac)
+    if reply is None:
+        return
+    state = BulbState.from_payload(reply[2])
+    brightness = max(STEP, min(65535, state.brightness + STEP * direction))
+    payload = lifx_lan._SET_COLOR.pack(0, state.hue, state.saturation, brightness, state.kelvin, 100)
+    transport.request(bulb.address, LIGHT_SET_COLOR, LIGHT_STATE, payload, mac=bulb.mac)
+
+
+def run(kind, detents, gap, rtt, loss):
+    bulb = FakeBulb(delay=rtt, loss=loss, state=BulbState(brightness=STEP))
+    transport = Transport(('127.0.0.1', 0))
+    lamp = None
+    if kind == "model":
+        reply = transport.request(bulb.address, LIGHT_GET, LIGHT_STATE, mac=bulb.mac)
+        lamp = Lamp(transport, bulb.mac, bulb.address, BulbState.from_payload(reply[2])).start()
+    bulb.received.clear()
+    sent = transport.sent
+    target = min(65535, STEP * (1 + detents))
+
+    busy = 0.0
+    for _ in range(detents):
+        time.sleep(gap)
+        started = time.perf_counter()
+        if lamp:
+            lamp.adjust_brightness(STEP, STEP, 65535)
+        else:
+            old_adjust(transport, bulb, 1)
+        busy += time.perf_counter() - started
+
+    # Wait for the bulb to show the final brightness (repeats included),
+    # timed from the last detent
+    deadline = started + 10
+    while bulb.state.brightness != target and time.perf_counter() < deadline:
+        time.sleep(0.001)
+    settled = time.perf_counter() - started
+    if lamp:
+        time.sleep(lifx_lan.REPEAT_DELAY + 0.05)
+        lamp.stop()
+    reached = bulb.state.brightness == target
+    datagrams = transport.sent - sent
+    reads = bulb.received.get(LIGHT_GET, 0)
+    bulb.close()
+    transport.close()
+    return busy, datagrams, reads, settled, reached
+
+
+def startup(rtt):
+    bulb = FakeBulb(delay=rtt)
+    with tempfile.TemporaryDirectory() as tmp:
+        cache = os.path.join(tmp, "lifx_cache.json")
+        times = {}
+        for kind in ("discovery", "cache"):
+            transport = Transport(('127.0.0.1', 0))
+            started = time.perf_counter()
+            lamp = find_lamp(transport, bulb.label, cache, broadcast=bulb.address)
+            times[lamp.found_by] = time.perf_counter() - started
+            transport.close()
+    bulb.close()
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--detents", type=int, default=12, help="brightness reports (one detent each)")
+    parser.add_argument("--gap", type=float, default=20, help="time between detents, ms")
+    parser.add_argument("--rtt", type=float, default=30, help="Wi-Fi round trip, ms")
+    parser.add_argument("--loss", type=float, default=0, help="datagrams lost, percent")
+    args = parser.parse_args()
+
+    gap, rtt, loss = args.gap / 1000, args.rtt / 1000, args.loss / 100
+    print(f"{args.detents} detents {args.gap:g} ms apart, {args.rtt:g} ms round trip, {args.loss:g}% loss\n")
+    print(f"{'control':<8} {'HID loop busy ms':>16} {'datagrams':>10} {'reads':>6} {'bulb final ms':>14} {'reached':>8}")
+    for kind in ("lifxlan", "model"):
+        busy, datagrams, reads, settled, reached = run(kind, args.detents, gap, rtt, loss)
+        print(f"{kind:<8} {1000 * busy:>16.1f} {datagrams:>10} {reads:>6} {1000 * settled:>14.1f} "
+              f"{'yes' if reached else 'no':>8}")
+        if kind == "model" and reads:
+            raise SystemExit(f"the model read the bulb {reads} times during {args.detents} detents")
+
+    times = startup(rtt)
+    print(f"\nstartup  broadcast discovery {1000 * times['discovery']:7.1f} ms"
+          f"\n         cached address      {1000 * times['cache']:7.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,120 @@
+// Decode time and flash size of the OLED logos, raw vs packed.
+//
+// Draws every logo into the simulated OLED buffer the way render_large_text()
+// and render_logo() do, once from the 512-byte bitmap in logos/*.txt with
+// oled_write_raw_P() and once from the packed array with
+// oled_write_packed_P(), after an oled_clear() each time so every byte is
+// really written. Checks that both give the same frame, then prints host
+// nanoseconds per frame and the PROGMEM bytes of each form.
+//
+// usage: logo_bench [frames]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "quantum.h"
+#include "oled_pack.h"
+#include "sim.h"
+
+#include "logos.h"
+#include "tidbit_logo.h"
+
+typedef struct {
+    const char *name;
+    const char *path;      // Unpacked bitmap, relative to sim/
+    const char *packed_P;
+    uint16_t    packed_size;
+    uint8_t     raw[OLED_MATRIX_SIZE];
+} logo_t;
+
+#define LOGO(dir, name) {#name, dir "/logos/" #name ".txt", name, sizeof(name)}
+
+static logo_t logos[] = {
+    LOGO("..", logo_steam),
+    LOGO("..", logo_discord),
+    LOGO("..", logo_desktop_wp),
+    LOGO("..", logo_nordvpn),
+    LOGO("..", my_logo),
+    LOGO("../../..", tidbit_oled),
+};
+
+#define LOGO_COUNT (sizeof(logos) / sizeof(logos[0]))
+
+// Hex bytes after "0x", '#' to end of line is a comment; short files are padded
+static bool load_bitmap(logo_t *logo) {
+    FILE *f = fopen(logo->path, "r");
+    if (!f) {
+        perror(logo->path);
+        return false;
+    }
+    char     line[256];
+    uint16_t n = 0;
+    memset(logo->raw, 0, sizeof(logo->raw));
+    while (fgets(line, sizeof(line), f)) {
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        for (char *p = strstr(line, "0x"); p && n < OLED_MATRIX_SIZE; p = strstr(p + 2, "0x")) {
+            logo->raw[n++] = (uint8_t)strtoul(p + 2, NULL, 16);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Mean ns per frame; the clear before each frame is not counted
+static double time_frames(const logo_t *logo, bool packed, unsigned frames) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < frames; i++) {
+        oled_clear();
+        uint64_t t0 = now_ns();
+        if (packed) {
+            oled_write_packed_P(logo->packed_P);
+        } else {
+            oled_write_raw_P((const char *)logo->raw, OLED_MATRIX_SIZE);
+        }
+        total += now_ns() - t0;
+    }
+    return (double)total / frames;
+}
+
+int main(int argc, char **argv) {
+    unsigned frames = argc > 1 ? (unsigned)atoi(argv[1]) : 20000;
+    if (!frames) frames = 1;
+
+    sim_oled_init();
+    for (size_t i = 0; i < LOGO_COUNT; i++) {
+        logo_t *logo = &logos[i];
+        if (!load_bitmap(logo)) return 2;
+        oled_clear();
+        oled_write_packed_P(logo->packed_P);
+        if (memcmp(sim_oled_buffer(), logo->raw, OLED_MATRIX_SIZE)) {
+            fprintf(stderr, "%s: packed bitmap does not match %s, run logo_pack.py\n", logo->name, logo->path);
+            return 1;
+        }
+    }
+
+    printf("%u frames per logo, host ns per frame\n\n", frames);
+    printf("%-16s %8s %8s   %9s %9s\n", "logo", "raw B", "packed B", "raw ns", "packed ns");
+    unsigned raw_total = 0, packed_total = 0;
+    double   raw_ns = 0, packed_ns = 0;
+    for (size_t i = 0; i < LOGO_COUNT; i++) {
+        const logo_t *logo = &logos[i];
+        double        r    = time_frames(logo, false, frames);
+        double        p    = time_frames(logo, true, frames);
+        printf("%-16s %8u %8u   %9.0f %9.0f\n", logo->name, OLED_MATRIX_SIZE, logo->packed_size, r, p);
+        raw_total += OLED_MATRIX_SIZE;
+        packed_total += logo->packed_size;
+        raw_ns += r;
+        packed_ns += p;
+    }
+    printf("%-16s %8u %8u   %9.0f %9.0f\n", "total/mean", raw_total, packed_total, raw_ns / LOGO_COUNT, packed_ns / LOGO_COUNT);
+    printf("\nflash: %u bytes of bitmaps become %u (%u saved, before the decoder's code)\n", raw_total, packed_total, raw_total - packed_total);
+    return 0;
+}
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+games.txt matching with a large Steam library
+
+Builds a games.txt the way `volume_balance.py --scan` writes it from a
+synthetic library (2,000 games by default), then times:
+
+    startup  parsing games.txt and compiling the matcher, vs loading the
+             compiled automaton from its cache
+    match    finding the best game among the running processes: the old
+             nested loop (each fragment against each process name), and
+             GameMatcher.best() in one pass
+
+    python3 sim/matcher_bench.py [--games N] [--processes N]
+"""
+
+import argparse
+import os
+import random
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+from game_matcher import GameLibrary, GameMatcher, parse_games  # noqa: E402
+
+WORDS = ["dark", "star", "war", "craft", "souls", "city", "sky", "line", "field", "doom", "space",
+         "quest", "land", "age", "fall", "rise", "zero", "nova", "rim", "core", "iron", "hollow",
+         "knight", "dead", "cell", "path", "exile", "forza", "hori", "zon", "sea", "thieves"]
+
+
+def write_library(path, count, rng):
+    """games.txt as scan_steam_games() writes it, from made-up folder names"""
+    folders = set()
+    while len(folders) < count:
+        folders.add(" ".join(w.capitalize() for w in rng.sample(WORDS, rng.randint(2, 4))))
+    names = sorted({f.lower().replace(' ', '')[:15] for f in folders})
+    with open(path, 'w', encoding='utf-8') as f:
+        f.write("# Steam Games List - Edit this file to add/remove games\n\n")
+        for name in names:
+            f.write(f"{name}\n")
+        f.write("\n# Other apps\ndiscord\nchrome\nspotify\n")
+    return names
+
+
+def old_best(fragments, processes):
+    """volume_balance.py before the matcher: first fragment found in any process"""
+    for fragment in fragments:
+        if fragment == "discord":
+            continue
+        for process in processes:
+            if fragment in process and process != "discord":
+                return process, fragment
+    return None
+
+
+def timed(fn, repeat):
+    started = time.perf_counter()
+    for _ in range(repeat):
+        result = fn()
+    return (time.perf_counter() - started) / repeat, result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--games", type=int, default=2000)
+    parser.add_argument("--processes", type=int, default=30, help="processes with audio sessions")
+    args = parser.parse_args()
+
+    rng = random.Random(5)
+    with tempfile.TemporaryDirectory() as tmp:
+        games_file = os.path.join(tmp, "games.txt")
+        names = write_library(games_file, args.games, rng)
+        fragments = parse_games(games_file)
+
+        build, _ = timed(lambda: GameMatcher(parse_games(games_file)), 5)
+        GameLibrary(games_file).current()  # Writes the cache
+        cached, _ = timed(lambda: GameLibrary(games_file).current(), 5)
+        library = GameLibrary(games_file)
+        matcher = library.current()
+        assert library.from_cache
+        unchanged, _ = timed(library.current, 1000)
+        cache_kb = os.path.getsize(library.cache_path) / 1024
+
+    processes = [f"helper{i}" for i in range(args.processes - 3)] + ["discord", "chrome"]
+    game = rng.choice(names[len(names) // 2:])  # A game late in the list
+    processes.insert(rng.randrange(len(processes)), f"{game}-win64-shipping")
+
+    old_time, old_result = timed(lambda: old_best(fragments, processes), 20)
+    new_time, new_result = timed(lambda: matcher.best(processes), 200)
+    no_game = [p for p in processes if not p.startswith(game)]
+    old_idle, _ = timed(lambda: old_best(fragments, no_game), 20)
+    idle_time, _ = timed(lambda: matcher.best(no_game), 200)
+
+    print(f"{len(fragments)} games.txt entries ({len(matcher.goto)} automaton states), "
+          f"{len(processes)} processes\n")
+    print(f"startup   parse + compile       {1000 * build:8.2f} ms")
+    print(f"          load cache ({cache_kb:.0f} KB)  {1000 * cached:8.2f} ms")
+    print(f"          unchanged (stat only) {1000 * unchanged:8.3f} ms\n")
+    print(f"match     nested loop           {1000 * old_time:8.3f} ms  -> {old_result}")
+    print(f"          GameMatcher.best()    {1000 * new_time:8.3f} ms  -> {new_result[0], new_result[2]}")
+    print(f"no game   nested loop           {1000 * old_idle:8.3f} ms")
+    print(f"          GameMatcher.best()    {1000 * idle_time:8.3f} ms")
+    assert old_result == (new_result[0], new_result[2]), "matchers disagree"
+
+
+if __name__ == "__main__":
+    main()
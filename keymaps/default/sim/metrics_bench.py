@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+MetricsEngine with stub providers: latest values, ring buffers, and readers
+that do not wait on a slow provider
+
+    fast     a counter sampled every 10 ms, into a ring buffer of HISTORY
+    failing  one good sample, then an exception on every call
+    slow     a sample that hangs until the bench lets it finish
+    nvml     the real NvmlProvider with pynvml made unimportable
+
+While the slow provider hangs, latest(), get() and recent() are called in a
+loop and timed. Then the bench checks that the NVML provider was left out,
+that the ring buffer holds the newest HISTORY samples in order and agrees
+with latest(), that the failing provider kept its last good value, and that
+the slow value showed up once released. It fails on any difference.
+
+    python3 sim/metrics_bench.py [--read SECONDS]
+"""
+
+import argparse
+import os
+import statistics
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+sys.modules["pynvml"] = None  # import pynvml raises ImportError, as without NVIDIA's library
+
+from hid_protocol import HID_METRIC_CPU, HID_METRIC_CPU_CLOCK, HID_METRIC_PING, HID_METRIC_GPU  # noqa: E402
+from metrics import MetricsEngine, NvmlProvider, Provider                                        # noqa: E402
+
+HISTORY = 8
+READ_LIMIT_MS = 20.0  # Slowest reader call accepted; the slow provider hangs for seconds
+SLOW_HANG = 5.0       # Longest the slow provider waits to be released
+
+
+class Counter(Provider):
+    name = "fast"
+    interval = 0.01
+
+    def __init__(self):
+        self.count = 0
+
+    def sample(self):
+        self.count += 1
+        return {HID_METRIC_CPU: self.count}
+
+
+class Failing(Provider):
+    name = "failing"
+    interval = 0.01
+
+    def __init__(self):
+        self.calls = 0
+
+    def sample(self):
+        self.calls += 1
+        if self.calls > 1:
+            raise OSError("sensor gone")
+        return {HID_METRIC_PING: 7}
+
+
+class Hanging(Provider):
+    name = "slow"
+    interval = 0.01
+
+    def __init__(self):
+        self.release = threading.Event()
+        self.entered = threading.Event()
+
+    def sample(self):
+        self.entered.set()
+        self.release.wait(SLOW_HANG)
+        return {HID_METRIC_CPU_CLOCK: 4200}
+
+
+def time_readers(engine, seconds):
+    """Milliseconds per latest(), get() and recent() call, for seconds"""
+    calls = {"latest()": engine.latest, "get()": lambda: engine.get(HID_METRIC_CPU),
+             "recent()": lambda: engine.recent(HID_METRIC_CPU)}
+    times = {name: [] for name in calls}
+    deadline = time.perf_counter() + seconds
+    while time.perf_counter() < deadline:
+        for name, call in calls.items():
+            started = time.perf_counter()
+            call()
+            times[name].append((time.perf_counter() - started) * 1000)
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--read", type=float, default=0.3, help="seconds of reader calls to time")
+    args = parser.parse_args()
+
+    fast, failing, slow = Counter(), Failing(), Hanging()
+    engine = MetricsEngine([fast, failing, slow, NvmlProvider()], history=HISTORY).start()
+    failures = []
+    try:
+        if not slow.entered.wait(2):
+            raise SystemExit("the slow provider was never sampled")
+        times = time_readers(engine, args.read)
+        hung = engine.latest()
+        slow.release.set()
+        time.sleep(0.1)
+        released = engine.latest()
+    finally:
+        slow.release.set()
+        engine.stop()
+
+    print(f"\nreader calls while a provider hangs, {args.read:.1f} s:")
+    print(f"{'call':<10} {'calls':>7} {'p50 us':>8} {'max ms':>8}")
+    for name, samples in times.items():
+        print(f"{name:<10} {len(samples):>7} {statistics.median(samples) * 1000:>8.1f} {max(samples):>8.3f}")
+        if max(samples) > READ_LIMIT_MS:
+            failures.append(f"{name} took {max(samples):.1f} ms while a provider hung")
+    if HID_METRIC_CPU_CLOCK in hung:
+        failures.append("the slow provider's value came before it returned")
+    if released.get(HID_METRIC_CPU_CLOCK) != 4200:
+        failures.append("the slow provider's value did not come once released")
+
+    stats = engine.provider_stats()
+    print("\nproviders: " + ", ".join(f"{name} {s['samples']} samples, {s['errors']} errors"
+                                      for name, s in stats.items()))
+    if "nvml" in stats or HID_METRIC_GPU in engine.latest():
+        failures.append("the NVML provider ran without pynvml")
+    if set(stats) != {"fast", "failing", "slow"}:
+        failures.append(f"providers {sorted(stats)}, expected fast, failing and slow")
+
+    # After stop() nothing samples, so the ring and latest() can be compared
+    ring = engine.recent(HID_METRIC_CPU)
+    values = [value for _, value in ring]
+    stamps = [when for when, _ in ring]
+    print(f"ring of {HISTORY}: {values}, latest {engine.get(HID_METRIC_CPU)} of {fast.count} samples")
+    if values != list(range(fast.count - HISTORY + 1, fast.count + 1)):
+        failures.append(f"ring holds {values}, expected the last {HISTORY} of {fast.count}")
+    if stamps != sorted(stamps):
+        failures.append("ring samples are out of order")
+    if engine.get(HID_METRIC_CPU) != values[-1]:
+        failures.append("latest() disagrees with the newest ring sample")
+    if engine.recent(HID_METRIC_CPU, seconds=0) not in ([], ring[-1:]):
+        failures.append("recent(seconds=0) returned old samples")
+
+    if engine.get(HID_METRIC_PING) != 7:
+        failures.append("the failing provider lost its last good value")
+    if stats["failing"]["errors"] != stats["failing"]["samples"] - 1:
+        failures.append(f"failing provider counted {stats['failing']['errors']} errors "
+                        f"in {stats['failing']['samples']} samples")
+
+    if failures:
+        raise SystemExit("\n" + "\n".join(failures))
+    print("\nmetrics engine as expected")
+
+
+if __name__ == "__main__":
+    main()
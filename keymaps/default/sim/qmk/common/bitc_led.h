@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdint.h>
+
+#define LED_ON  2
+#define LED_DIM 1
+#define LED_OFF 0
+
+void set_bitc_LED(uint8_t mode);
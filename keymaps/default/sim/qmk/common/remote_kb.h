@@ -0,0 +1,7 @@
+#pragma once
+
+#include "quantum.h"
+
+void matrix_init_remote_kb(void);
+void matrix_scan_remote_kb(void);
+bool process_record_remote_kb(uint16_t keycode, keyrecord_t *record);
@@ -0,0 +1,27 @@
+#pragma once
+
+// Stand-in for the QMK-generated default_keyboard.h: matrix size and the
+// LAYOUT macro as described by keyboard.json.
+
+#include "quantum.h"
+
+#define MATRIX_ROWS 5
+#define MATRIX_COLS 6
+
+// clang-format off
+#define LAYOUT( \
+              k03, k04, k05, \
+         k12, k13, k14, k15, \
+         k22, k23, k24, k25, \
+         k32, k33, k34, k35, \
+         k42, k43, k44, k45  \
+) { \
+    { KC_NO, KC_NO, KC_NO, k03,   k04,   k05 }, \
+    { KC_NO, KC_NO, k12,   k13,   k14,   k15 }, \
+    { KC_NO, KC_NO, k22,   k23,   k24,   k25 }, \
+    { KC_NO, KC_NO, k32,   k33,   k34,   k35 }, \
+    { KC_NO, KC_NO, k42,   k43,   k44,   k45 }  \
+}
+// clang-format on
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
@@ -0,0 +1,173 @@
+#pragma once
+
+// Host simulation shim of the QMK core API used by tidbit.c and the
+// default keymap. Only what the firmware actually calls is declared here;
+// behaviour lives in sim_qmk.c.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+// --- AVR program memory (flat address space on the host) ---
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+
+// --- Keycodes (values match QMK's keycodes.h) ---
+#define KC_NO           0x0000
+#define KC_TRNS         0x0001
+#define _______         KC_TRNS
+#define XXXXXXX         KC_NO
+#define KC_A            0x0004
+#define KC_R            0x0015
+#define KC_ENT          0x0028
+#define KC_ENTER        KC_ENT
+#define KC_NUM_LOCK     0x0053
+#define KC_PSLS         0x0054
+#define KC_PAST         0x0055
+#define KC_PMNS         0x0056
+#define KC_PPLS         0x0057
+#define KC_PENT         0x0058
+#define KC_P1           0x0059
+#define KC_P2           0x005A
+#define KC_P3           0x005B
+#define KC_P4           0x005C
+#define KC_P5           0x005D
+#define KC_P6           0x005E
+#define KC_P7           0x005F
+#define KC_P8           0x0060
+#define KC_P9           0x0061
+#define KC_P0           0x0062
+#define KC_PDOT         0x0063
+#define KC_LCTL         0x00E0
+#define KC_LSFT         0x00E1
+#define KC_LALT         0x00E2
+#define KC_LGUI         0x00E3
+#define QK_LCTL         0x0100
+#define QK_LSFT         0x0200
+#define QK_LALT         0x0400
+#define QK_LGUI         0x0800
+#define LCTL(kc)        (QK_LCTL | (kc))
+#define LSFT(kc)        (QK_LSFT | (kc))
+#define LGUI(kc)        (QK_LGUI | (kc))
+#define SAFE_RANGE      0x7E40
+
+// --- Matrix / records ---
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+typedef struct {
+    keypos_t key;
+    bool     pressed;
+    uint16_t time;
+} keyevent_t;
+
+typedef struct {
+    keyevent_t event;
+} keyrecord_t;
+
+typedef union {
+    uint8_t raw;
+    struct {
+        bool num_lock : 1;
+        bool caps_lock : 1;
+        bool scroll_lock : 1;
+        bool compose : 1;
+        bool kana : 1;
+        uint8_t reserved : 3;
+    };
+} led_t;
+
+// --- Timer ---
+uint16_t timer_read(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_read32(void);
+uint32_t timer_elapsed32(uint32_t last);
+void     wait_ms(uint16_t ms);
+
+// Microsecond clock for perf_stats.c, which times with the ChibiOS system
+// timer on the keyboard
+uint32_t timer_read_us(void);
+#define PERF_CLOCK_US() timer_read_us()
+
+// --- Host keyboard ---
+void  register_code(uint8_t code);
+void  unregister_code(uint8_t code);
+void  tap_code(uint8_t code);
+void  tap_code16(uint16_t code);
+void  send_char(char ascii_code);
+void  send_string(const char *str);
+led_t host_keyboard_led_state(void);
+
+// send_string.h lookup tables (US layout)
+extern const uint8_t ascii_to_keycode_lut[128];
+extern const uint8_t ascii_to_shift_lut[16];
+#define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
+
+// --- OLED (SSD1306, 128x32) ---
+#define OLED_DISPLAY_WIDTH  128
+#define OLED_DISPLAY_HEIGHT 32
+#define OLED_MATRIX_SIZE    (OLED_DISPLAY_HEIGHT / 8 * OLED_DISPLAY_WIDTH)
+#define OLED_FONT_WIDTH     6
+#define OLED_FONT_HEIGHT    8
+
+typedef enum {
+    OLED_ROTATION_0   = 0,
+    OLED_ROTATION_90  = 1,
+    OLED_ROTATION_180 = 2,
+    OLED_ROTATION_270 = 3,
+} oled_rotation_t;
+
+void oled_clear(void);
+void oled_set_cursor(uint8_t col, uint8_t line);
+void oled_write_char(const char data, bool invert);
+void oled_write(const char *data, bool invert);
+void oled_write_P(const char *data, bool invert);
+void oled_write_raw(const char *data, uint16_t size);
+void oled_write_raw_P(const char *data, uint16_t size);
+void oled_write_raw_byte(const char data, uint16_t index);
+
+typedef struct {
+    uint8_t *current_element;
+    uint16_t remaining_element_count;
+} oled_buffer_reader_t;
+
+oled_buffer_reader_t oled_read_raw(uint16_t start_index);
+bool oled_on(void);
+bool oled_off(void);
+
+// --- RGB light ---
+void    rgblight_enable(void);
+void    rgblight_disable_noeeprom(void);
+void    rgblight_step(void);
+uint8_t rgblight_get_mode(void);
+uint8_t rgblight_get_val(void);
+void    rgblight_sethsv(uint8_t hue, uint8_t sat, uint8_t val);
+
+// --- Keyboard / user callbacks ---
+void            keyboard_post_init_user(void);
+void            matrix_init_kb(void);
+void            matrix_init_user(void);
+void            matrix_scan_kb(void);
+void            matrix_scan_user(void);
+bool            process_record_kb(uint16_t keycode, keyrecord_t *record);
+bool            process_record_user(uint16_t keycode, keyrecord_t *record);
+bool            encoder_update_kb(uint8_t index, bool clockwise);
+bool            encoder_update_user(uint8_t index, bool clockwise);
+oled_rotation_t oled_init_kb(oled_rotation_t rotation);
+oled_rotation_t oled_init_user(oled_rotation_t rotation);
+bool            oled_task_kb(void);
+bool            oled_task_user(void);
+bool            shutdown_kb(bool jump_to_bootloader);
+bool            shutdown_user(bool jump_to_bootloader);
+void            led_update_ports(led_t led_state);
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdint.h>
+
+#define RAW_EPSIZE 32
+
+void raw_hid_receive(uint8_t *data, uint8_t length);
+void raw_hid_send(uint8_t *data, uint8_t length);
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Voice roster upkeep on a busy server, full rescan vs VoiceRoster
+
+Replays random voice activity (joins, leaves, moves, mute toggles) on a
+voice_roster.FakeGuild and keeps the Discord user list the two ways
+discord_voice_control.py has:
+
+    rescan  update_voice_users(): on every voice state update, walk every
+            voice channel and member, print each one, diff the names;
+            the selection is an index into the list
+    roster  VoiceRoster.apply() with the event's before/after states;
+            the selection follows the member ID, and the OLED is sent a
+            user report only when (index, total, name) changes
+
+After every event the roster is checked against a full scan of the guild.
+
+    python3 sim/roster_bench.py [--members N] [--events N] [--channels N]
+"""
+
+import argparse
+import os
+import random
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+from voice_roster import FakeGuild, FakeMember, VoiceRoster, voice_events  # noqa: E402
+
+
+def scan(guild):
+    """get_voice_users(): every non-bot member, in channel then join order"""
+    visited = 0
+    users = []
+    for channel in guild.voice_channels:
+        for member in channel.members:
+            visited += 1
+            if not member.bot:
+                users.append(member)
+    return users, visited
+
+
+def populate(guild, count, rng):
+    members = [FakeMember(10_000 + i, f"user{i}", bot=(i % 25 == 0)) for i in range(count)]
+    for member in members:
+        if rng.random() < 0.6:
+            guild.connect(member, rng.choice(guild.voice_channels))
+    return members
+
+
+def run_rescan(guild, members, events, rng):
+    users, _ = scan(guild)
+    index = 0
+    selected = users[0].id if users else None
+    visited = printed = jumps = 0
+    started = time.perf_counter()
+    for member, before, after in voice_events(guild, members, rng, events):
+        new_users, seen = scan(guild)
+        visited += seen
+        printed += seen + 2   # One line per member plus the channel headers, roughly
+        if len(new_users) != len(users) or any(a.id != b.id for a, b in zip(new_users, users)):
+            users = new_users
+            if index >= len(users):
+                index = 0
+        now = users[index].id if users else None
+        if selected is not None and now != selected and selected in guild.location:
+            jumps += 1        # Selection moved to someone else while they were still in voice
+        selected = now
+    return time.perf_counter() - started, visited, printed, jumps, None
+
+
+def run_roster(guild, members, events, rng):
+    roster = VoiceRoster()
+    roster.load(guild)
+    shown = roster.view()
+    selected = roster.selected_id
+    pushes = jumps = 0
+    elapsed = 0.0
+    for member, before, after in voice_events(guild, members, rng, events):
+        started = time.perf_counter()
+        if roster.apply(member, before, after):
+            view = roster.view()
+            if view != shown:
+                shown = view
+                pushes += 1
+        elapsed += time.perf_counter() - started
+        if selected is not None and roster.selected_id != selected and selected in guild.location:
+            jumps += 1
+        selected = roster.selected_id
+        expected, _ = scan(guild)
+        assert [m for m, _ in roster.users()] == expected, "roster differs from a full scan"
+    return elapsed, 0, 0, jumps, pushes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--members", type=int, default=2000, help="guild members who use voice")
+    parser.add_argument("--events", type=int, default=5000)
+    parser.add_argument("--channels", type=int, default=12)
+    args = parser.parse_args()
+
+    print(f"{args.members} members, {args.channels} voice channels, {args.events} voice state updates\n")
+    print(f"{'upkeep':<7} {'python ms':>10} {'us/event':>9} {'members walked':>15} "
+          f"{'lines printed':>14} {'selection jumps':>16} {'OLED pushes':>12}")
+    for kind, run in (("rescan", run_rescan), ("roster", run_roster)):
+        rng = random.Random(3)
+        guild = FakeGuild(channels=args.channels)
+        members = populate(guild, args.members, rng)
+        elapsed, visited, printed, jumps, pushes = run(guild, members, args.events, rng)
+        print(f"{kind:<7} {1000 * elapsed:>10.1f} {1e6 * elapsed / args.events:>9.1f} {visited:>15} "
+              f"{printed:>14} {jumps:>16} {'-' if pushes is None else pushes:>12}")
+    print("\nroster matched a full scan after every event")
+
+
+if __name__ == "__main__":
+    main()
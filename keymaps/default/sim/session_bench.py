@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+Cost of finding the Discord and game audio sessions, old scan vs SessionIndex
+
+Runs volume_balance.py's session lookup against audio_sessions'
+FakeSessionBackend for a simulated stretch of play (one refresh every
+5 s, with sessions coming and going) and counts the per-session work the
+real backend does through COM and psutil: enumerations of all sessions and
+process names read.
+
+    old    get_session_by_name() for "discord", then for each games.txt
+           entry until one matches, each call enumerating every session
+    index  SessionIndex.refresh(): one enumeration, new sessions matched once
+
+    python3 sim/session_bench.py [--games N] [--sessions N] [--refreshes N]
+"""
+
+import argparse
+import os
+import random
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+from audio_sessions import FakeSessionBackend, SessionIndex, normalize  # noqa: E402
+from game_matcher import GameMatcher                                       # noqa: E402
+
+LOOKUP_US = 150  # Rough cost of one session's Process.name() on Windows
+
+
+def make_library(count, rng):
+    """games.txt-like fragments, like scan_steam_games() writes"""
+    words = ["dark", "star", "war", "craft", "souls", "city", "sky", "line", "field", "doom",
+             "space", "quest", "land", "age", "fall", "rise", "zero", "nova", "rim", "core"]
+    names = set()
+    while len(names) < count:
+        names.add("".join(rng.sample(words, 3))[:15])
+    return sorted(names) + ["discord", "chrome", "spotify"]
+
+
+def old_get_session_by_name(backend, name_part):
+    for _key, name, session in backend.sessions():
+        if name_part in name.lower():
+            return session
+    return None
+
+
+def old_refresh(backend, games):
+    discord = old_get_session_by_name(backend, "discord")
+    game = None
+    for game_name in games:
+        if game_name == "discord":
+            continue
+        session = old_get_session_by_name(backend, game_name)
+        if session and session.name.lower() != "discord.exe":
+            game = session
+            break
+    return discord, game
+
+
+def workload(backend, games, sessions, refreshes, rng, refresh):
+    """Run refreshes with sessions starting and exiting between them"""
+    background = [f"app{i}.exe" for i in range(sessions - 2)]
+    live = [backend.add(name) for name in background + ["Discord.exe"]]
+    game = backend.add(f"{rng.choice(games[:-3])}.exe")
+    picks = []
+    for tick in range(refreshes):
+        if tick % 12 == 11:  # Once a minute: an app restarts, the game changes
+            backend.remove(live.pop(rng.randrange(len(live) - 1)))
+            live.insert(0, backend.add(f"app{sessions + tick}.exe"))
+            backend.remove(game)
+            game = backend.add(f"{rng.choice(games[:-3])}.exe")
+        picks.append(refresh())
+    return picks
+
+
+def run(kind, games, sessions, refreshes):
+    rng = random.Random(7)
+    backend = FakeSessionBackend()
+    if kind == "old":
+        refresh = lambda: old_refresh(backend, games)
+    else:
+        index = SessionIndex(backend, GameMatcher(games))
+
+        def refresh():
+            index.refresh()
+            return index.discord(), index.game()
+    started = time.perf_counter()
+    picks = workload(backend, games, sessions, refreshes, rng, refresh)
+    elapsed = time.perf_counter() - started
+    names = [(normalize(d.name) if d else None, normalize(g.name) if g else None) for d, g in picks]
+    return backend.enumerations, backend.name_lookups, elapsed, names
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--games", type=int, default=300)
+    parser.add_argument("--sessions", type=int, default=25)
+    parser.add_argument("--refreshes", type=int, default=120, help="5 s refreshes (default: 10 minutes)")
+    args = parser.parse_args()
+
+    games = make_library(args.games, random.Random(1))
+    print(f"{len(games)} games.txt entries, {args.sessions} audio sessions, {args.refreshes} refreshes\n")
+    print(f"{'lookup':<6} {'enumerations':>12} {'names read':>11} {'per refresh':>12} {'python ms':>10} {'est. COM ms':>12}")
+    results = {}
+    for kind in ("old", "index"):
+        enumerations, lookups, elapsed, names = run(kind, games, args.sessions, args.refreshes)
+        results[kind] = names
+        print(f"{kind:<6} {enumerations:>12} {lookups:>11} {lookups / args.refreshes:>12.0f} "
+              f"{1000 * elapsed:>10.1f} {lookups * LOOKUP_US / 1000:>12.0f}")
+    # The index must pick the same sessions as the scan it replaces
+    mismatches = sum(a != b for a, b in zip(results["old"], results["index"]))
+    print(f"\nsame Discord/game picks: {'yes' if not mismatches else f'no ({mismatches} differ)'}")
+
+
+if __name__ == "__main__":
+    main()
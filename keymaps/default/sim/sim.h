@@ -0,0 +1,43 @@
+#pragma once
+
+// Internal interface between the QMK shim (sim_qmk.c) and the scenario
+// driver (sim_main.c). Firmware sources never include this file.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Cost model for blocking calls, in virtual microseconds. The keyboard
+// endpoint holds one report until the host's next 1 ms poll; sending another
+// report before then blocks until the endpoint is free.
+#define SIM_HOST_REPORT_US 1000
+// Bytes of SSD1306 addressing commands sent ahead of every dirty block.
+#define SIM_OLED_BLOCK_OVERHEAD 7
+#define SIM_OLED_BLOCK_SIZE 32
+#define SIM_OLED_LINES 4
+#define SIM_OLED_COLS 21
+
+typedef struct {
+    uint32_t hid_reports_out;  // raw_hid_send() calls
+    uint32_t host_key_reports; // keyboard reports sent to the host
+    uint64_t oled_api_bytes;   // bytes pushed through oled_write*/oled_write_raw*
+    uint64_t oled_i2c_bytes;   // bytes flushed to the SSD1306 by oled_render
+    uint32_t oled_clears;      // oled_clear() calls
+    uint64_t blocked_us;       // virtual time spent inside wait_ms and key reports
+} sim_counters_t;
+
+extern sim_counters_t sim_counters;
+
+// Virtual clock. timer_read32() returns sim_now_us / 1000.
+extern uint64_t sim_now_us;
+void            sim_advance_us(uint64_t us);
+
+// Called for every raw_hid_send() so the driver can log outgoing reports.
+typedef void (*sim_hid_hook_t)(const uint8_t *data, uint8_t length);
+void sim_set_hid_hook(sim_hid_hook_t hook);
+
+// OLED model: QMK's 512-byte page buffer with 32-byte dirty blocks, plus a
+// text layer recording the character last written to each cell.
+void           sim_oled_init(void);
+void           sim_oled_render(void);
+const char    *sim_oled_text_line(uint8_t line);
+const uint8_t *sim_oled_buffer(void);
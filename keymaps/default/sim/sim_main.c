@@ -0,0 +1,591 @@
+// Scenario driver for the host simulation build.
+//
+// Replays a scripted timeline of key, encoder and raw HID events against
+// tidbit.c and the default keymap at a 1 kHz scan cadence, then reports the
+// host cycle cost of each callback, virtual-time stalls, HID/OLED traffic and
+// the framebuffer.
+//
+// usage: tidbit_sim [-n] [-v] [-l hid.log] scenario.txt
+//   -n  omit host cycle counts (deterministic output for diffing)
+//   -v  trace every delivered event and outgoing raw HID report
+//   -l  append outgoing raw HID reports to a log file ("<ms> <hex>...")
+//
+// Scenario lines are "[@abs_ms | +rel_ms] command", one per line; '#' starts
+// a comment. Commands:
+//   press|release|tap <key>          key is a KC_ name or "row,col"
+//   encoder <index> cw|ccw [n [ms]]  n detents, ms apart (default 1, 10 ms)
+//   hid [len=<n>] <hex bytes...>     raw_hid_receive() with a 32-byte report,
+//                                    or told its length is n (0-32)
+//   dump                             print the framebuffer
+//   expect line <n> "<text>"         OLED text line n must read <text>
+//   expect hid <hex bytes...>        last report sent must start with bytes
+//   expect executed <n>              the link's host has handled n button presses
+//   link <out%> <in%> [seed]         put the host model below between keyboard
+//                                    and scenario, losing reports both ways
+//   end                              stop the run at this time
+
+#include <stdlib.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "quantum.h"
+#include "default_keyboard.h"
+#include "raw_hid.h"
+#include "hid_protocol.h"
+#include "sim.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+static inline uint64_t cycles(void) {
+    return __rdtsc();
+}
+#else
+static inline uint64_t cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+// --- Per-callback probes ---
+
+typedef struct {
+    const char *name;
+    uint64_t    calls;
+    uint64_t    total;
+    uint64_t    max;
+    uint64_t    blocked_max_us; // worst virtual time spent inside one call
+} probe_t;
+
+enum { P_RECORD, P_ENCODER, P_HID, P_SCAN, P_OLED, P_COUNT };
+
+static probe_t probes[P_COUNT] = {
+    [P_RECORD]  = {"process_record_kb"},
+    [P_ENCODER] = {"encoder_update_kb"},
+    [P_HID]     = {"raw_hid_receive"},
+    [P_SCAN]    = {"matrix_scan_kb"},
+    [P_OLED]    = {"oled_task_kb"},
+};
+
+#define PROBE(p, call)                                   \
+    do {                                                 \
+        uint64_t vt0 = sim_now_us;                       \
+        uint64_t t0  = cycles();                         \
+        call;                                            \
+        probe_add(&probes[p], cycles() - t0, sim_now_us - vt0); \
+    } while (0)
+
+static void probe_add(probe_t *p, uint64_t c, uint64_t blocked_us) {
+    p->calls++;
+    p->total += c;
+    if (c > p->max) p->max = c;
+    if (blocked_us > p->blocked_max_us) p->blocked_max_us = blocked_us;
+}
+
+// --- Scenario events ---
+
+typedef enum { EV_PRESS, EV_RELEASE, EV_ENCODER, EV_HID, EV_DUMP, EV_EXPECT_LINE, EV_EXPECT_HID, EV_EXPECT_EXECUTED } ev_type_t;
+
+typedef struct {
+    uint32_t  due_ms;
+    uint32_t  order;
+    int       src_line;
+    ev_type_t type;
+    uint8_t   row, col;
+    uint8_t   index;
+    bool      cw;
+    uint8_t   data[RAW_EPSIZE];
+    uint8_t   len;
+    char      text[64];
+} event_t;
+
+static event_t *events;
+static size_t   event_count, event_cap;
+
+static event_t *event_add(uint32_t due_ms, int src_line, ev_type_t type) {
+    if (event_count == event_cap) {
+        event_cap = event_cap ? event_cap * 2 : 64;
+        events    = realloc(events, event_cap * sizeof(*events));
+        if (!events) exit(2);
+    }
+    event_t *e = &events[event_count];
+    memset(e, 0, sizeof(*e));
+    e->due_ms   = due_ms;
+    e->order    = (uint32_t)event_count++;
+    e->src_line = src_line;
+    e->type     = type;
+    return e;
+}
+
+static int event_cmp(const void *a, const void *b) {
+    const event_t *x = a, *y = b;
+    if (x->due_ms != y->due_ms) return x->due_ms < y->due_ms ? -1 : 1;
+    return x->order < y->order ? -1 : 1;
+}
+
+// --- Scenario parsing ---
+
+static const struct {
+    const char *name;
+    uint16_t    keycode;
+} key_names[] = {
+    {"KC_PSLS", KC_PSLS}, {"KC_PAST", KC_PAST}, {"KC_PMNS", KC_PMNS}, {"KC_PPLS", KC_PPLS},
+    {"KC_PENT", KC_PENT}, {"KC_PDOT", KC_PDOT}, {"KC_P0", KC_P0},     {"KC_P1", KC_P1},
+    {"KC_P2", KC_P2},     {"KC_P3", KC_P3},     {"KC_P4", KC_P4},     {"KC_P5", KC_P5},
+    {"KC_P6", KC_P6},     {"KC_P7", KC_P7},     {"KC_P8", KC_P8},     {"KC_P9", KC_P9},
+};
+
+static bool find_key(const char *name, uint8_t *row, uint8_t *col) {
+    unsigned r, c;
+    if (sscanf(name, "%u,%u", &r, &c) == 2 && r < MATRIX_ROWS && c < MATRIX_COLS) {
+        *row = r;
+        *col = c;
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(key_names) / sizeof(key_names[0]); i++) {
+        if (strcmp(name, key_names[i].name)) continue;
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                if (keymaps[0][r][c] == key_names[i].keycode) {
+                    *row = r;
+                    *col = c;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static uint8_t parse_hex(char *s, uint8_t *out, uint8_t max) {
+    uint8_t n = 0;
+    for (char *tok = strtok(s, " \t"); tok && n < max; tok = strtok(NULL, " \t")) {
+        out[n++] = (uint8_t)strtoul(tok, NULL, 16);
+    }
+    return n;
+}
+
+static bool parse_quoted(const char *s, char *out, size_t max) {
+    const char *open = strchr(s, '"');
+    const char *close = open ? strrchr(open + 1, '"') : NULL;
+    if (!close) return false;
+    size_t len = (size_t)(close - open - 1);
+    if (len >= max) len = max - 1;
+    memcpy(out, open + 1, len);
+    out[len] = '\0';
+    return true;
+}
+
+static bool   has_end;
+static uint32_t end_ms;
+
+// --- Simulated host link ---
+//
+// With a "link" line, the scripts on the far side of the USB cable are
+// modelled: each button report the keyboard sends is lost with probability
+// out_pct %; one that arrives is acked, and handled unless a copy with the
+// same sequence number and press time already was. Acks are lost with
+// probability in_pct % and the rest reach raw_hid_receive() LINK_DELAY_MS
+// later. The scripts say hello on every encoder channel before the first
+// scan, over a link that loses nothing.
+
+#define LINK_DELAY_MS 1
+#define LINK_ACKS     16  // Acks in flight
+#define LINK_SEEN     64  // Button reports remembered to spot copies
+
+typedef struct {
+    uint32_t due_ms;
+    uint8_t  data[RAW_EPSIZE];
+} link_ack_t;
+
+static struct {
+    bool       on;
+    unsigned   out_pct, in_pct;
+    uint32_t   rng;
+    uint32_t   lost_out, lost_in, executed, copies;
+    link_ack_t acks[LINK_ACKS];
+    uint8_t    ack_head, ack_count;
+    uint64_t   seen[LINK_SEEN];
+    uint8_t    seen_next;
+} link;
+
+static bool link_lose(unsigned pct) {
+    link.rng ^= link.rng << 13;  // xorshift32, so a seed replays the same losses
+    link.rng ^= link.rng >> 17;
+    link.rng ^= link.rng << 5;
+    return link.rng % 100 < pct;
+}
+
+static void link_queue_ack(uint8_t opcode, uint16_t seq) {
+    if (link.ack_count == LINK_ACKS) {
+        link.lost_in++;
+        return;
+    }
+    link_ack_t *a = &link.acks[(link.ack_head + link.ack_count++) % LINK_ACKS];
+    memset(a->data, 0, sizeof(a->data));
+    a->due_ms                = timer_read32() + LINK_DELAY_MS;
+    a->data[0]               = opcode;
+    a->data[1]               = HID_CMD_ACK;
+    a->data[HID_ACK_SEQ]     = seq >> 8;
+    a->data[HID_ACK_SEQ + 1] = seq;
+}
+
+static void link_receive(const uint8_t *data) {
+    if (data[0] < HID_OP_VOLUME || data[0] > HID_OP_LIFX || data[1] != HID_CMD_BUTTON) {
+        return;
+    }
+    if (link_lose(link.out_pct)) {
+        link.lost_out++;
+        return;
+    }
+    uint16_t seq   = data[HID_TRACE_SEQ] << 8 | data[HID_TRACE_SEQ + 1];
+    uint32_t event = (uint32_t)data[HID_TRACE_EVENT] << 24 | data[HID_TRACE_EVENT + 1] << 16 | data[HID_TRACE_EVENT + 2] << 8 | data[HID_TRACE_EVENT + 3];
+    uint64_t key   = (uint64_t)data[0] << 48 | (uint64_t)seq << 32 | event;
+    if (link_lose(link.in_pct)) {
+        link.lost_in++;
+    } else {
+        link_queue_ack(data[0], seq);  // Copies too, their ack may be what got lost
+    }
+    for (uint8_t i = 0; i < LINK_SEEN; i++) {
+        if (link.seen[i] == key) {
+            link.copies++;
+            return;
+        }
+    }
+    link.seen[link.seen_next++ % LINK_SEEN] = key;
+    link.executed++;
+}
+
+static bool load_scenario(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char     line[256];
+    int      lineno = 0;
+    uint32_t t      = 0;
+    bool     ok     = true;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (!*p || *p == '#') continue;
+        if (*p == '@' || *p == '+') {
+            char    *end;
+            uint32_t v = (uint32_t)strtoul(p + 1, &end, 10);
+            t          = *p == '@' ? v : t + v;
+            p          = end;
+            while (isspace((unsigned char)*p)) p++;
+        }
+        char cmd[16] = "", arg[32] = "";
+        int  consumed = 0;
+        sscanf(p, "%15s %31s %n", cmd, arg, &consumed);
+
+        uint8_t row, col;
+        if (!strcmp(cmd, "press") || !strcmp(cmd, "release") || !strcmp(cmd, "tap")) {
+            if (!find_key(arg, &row, &col)) {
+                fprintf(stderr, "%s:%d: unknown key '%s'\n", path, lineno, arg);
+                ok = false;
+                continue;
+            }
+            if (strcmp(cmd, "release")) {
+                event_t *e = event_add(t, lineno, EV_PRESS);
+                e->row     = row;
+                e->col     = col;
+            }
+            if (strcmp(cmd, "press")) {
+                event_t *e = event_add(!strcmp(cmd, "tap") ? t + 30 : t, lineno, EV_RELEASE);
+                e->row     = row;
+                e->col     = col;
+            }
+        } else if (!strcmp(cmd, "encoder")) {
+            unsigned index = 0, count = 1, interval = 10;
+            char     dir[8] = "";
+            sscanf(p, "%*s %u %7s %u %u", &index, dir, &count, &interval);
+            for (unsigned i = 0; i < count; i++) {
+                event_t *e = event_add(t + i * interval, lineno, EV_ENCODER);
+                e->index   = (uint8_t)index;
+                e->cw      = !strcmp(dir, "cw");
+            }
+        } else if (!strcmp(cmd, "hid")) {
+            event_t *e = event_add(t, lineno, EV_HID);
+            char     buf[256];
+            unsigned len = RAW_EPSIZE;
+            if (sscanf(arg, "len=%u", &len) == 1) {
+                if (len > RAW_EPSIZE) {
+                    fprintf(stderr, "%s:%d: hid len must be 0-%d\n", path, lineno, RAW_EPSIZE);
+                    ok = false;
+                }
+                snprintf(buf, sizeof(buf), "%s", p + consumed);
+            } else {
+                snprintf(buf, sizeof(buf), "%s", p + 3);
+            }
+            parse_hex(buf, e->data, RAW_EPSIZE);
+            e->len = len;
+        } else if (!strcmp(cmd, "dump")) {
+            event_add(t, lineno, EV_DUMP);
+        } else if (!strcmp(cmd, "expect") && !strcmp(arg, "line")) {
+            event_t *e = event_add(t, lineno, EV_EXPECT_LINE);
+            e->index   = (uint8_t)atoi(p + consumed);
+            if (!parse_quoted(p + consumed, e->text, sizeof(e->text))) {
+                fprintf(stderr, "%s:%d: expect line needs a quoted string\n", path, lineno);
+                ok = false;
+            }
+        } else if (!strcmp(cmd, "expect") && !strcmp(arg, "hid")) {
+            event_t *e = event_add(t, lineno, EV_EXPECT_HID);
+            char     buf[256];
+            snprintf(buf, sizeof(buf), "%s", p + consumed);
+            e->len = parse_hex(buf, e->data, RAW_EPSIZE);
+        } else if (!strcmp(cmd, "expect") && !strcmp(arg, "executed")) {
+            event_t *e = event_add(t, lineno, EV_EXPECT_EXECUTED);
+            e->index   = (uint8_t)atoi(p + consumed);
+        } else if (!strcmp(cmd, "link")) {
+            unsigned seed = 1;
+            if (sscanf(p, "%*s %u %u %u", &link.out_pct, &link.in_pct, &seed) < 2) {
+                fprintf(stderr, "%s:%d: link needs the out and in loss in percent\n", path, lineno);
+                ok = false;
+            }
+            link.on  = true;
+            link.rng = seed ? seed : 1;
+        } else if (!strcmp(cmd, "end")) {
+            has_end = true;
+            end_ms  = t;
+        } else {
+            fprintf(stderr, "%s:%d: unknown command '%s'\n", path, lineno, cmd);
+            ok = false;
+        }
+    }
+    fclose(f);
+    qsort(events, event_count, sizeof(*events), event_cmp);
+    return ok;
+}
+
+// --- Output ---
+
+static bool  opt_no_cycles;
+static bool  opt_verbose;
+static FILE *hid_log;
+
+static uint8_t last_hid[RAW_EPSIZE];
+
+static void print_hex(FILE *out, const uint8_t *data, uint8_t len) {
+    while (len > 0 && data[len - 1] == 0) len--;
+    for (uint8_t i = 0; i < len; i++) fprintf(out, "%s%02X", i ? " " : "", data[i]);
+}
+
+static void on_hid_send(const uint8_t *data, uint8_t length) {
+    memset(last_hid, 0, sizeof(last_hid));
+    memcpy(last_hid, data, length < RAW_EPSIZE ? length : RAW_EPSIZE);
+    if (link.on) link_receive(last_hid);
+    if (opt_verbose) {
+        printf("[%7u ms] hid> ", timer_read32());
+        print_hex(stdout, data, length);
+        printf("\n");
+    }
+    if (hid_log) {
+        fprintf(hid_log, "%u", timer_read32());
+        for (uint8_t i = 0; i < length; i++) fprintf(hid_log, " %02X", data[i]);
+        fprintf(hid_log, "\n");
+    }
+}
+
+static void dump_framebuffer(void) {
+    printf("[%7u ms] framebuffer\n+---------------------+\n", timer_read32());
+    for (uint8_t i = 0; i < SIM_OLED_LINES; i++) printf("|%s|\n", sim_oled_text_line(i));
+    printf("+---------------------+\n");
+    const uint8_t *fb = sim_oled_buffer();
+    for (uint8_t y = 0; y < OLED_DISPLAY_HEIGHT; y += 2) {
+        for (uint8_t x = 0; x < OLED_DISPLAY_WIDTH; x++) {
+            uint8_t byte = fb[(y / 8) * OLED_DISPLAY_WIDTH + x];
+            bool    top  = byte & (1 << (y % 8));
+            bool    bot  = byte & (1 << (y % 8 + 1));
+            putchar(top && bot ? ':' : top ? '\'' : bot ? '.' : ' ');
+        }
+        putchar('\n');
+    }
+}
+
+// --- Run loop ---
+
+typedef struct {
+    uint32_t delivered;
+    uint32_t late;
+    uint32_t max_latency_ms;
+    uint64_t total_latency_ms;
+    uint32_t failures;
+} event_stats_t;
+
+static event_stats_t ev_stats;
+
+static bool key_event(const event_t *e, bool pressed) {
+    keyrecord_t record = {.event = {.key = {.col = e->col, .row = e->row}, .pressed = pressed, .time = timer_read()}};
+    uint16_t    keycode = keymaps[0][e->row][e->col];
+    bool        result;
+    PROBE(P_RECORD, result = process_record_kb(keycode, &record));
+    return result;
+}
+
+static void deliver(const event_t *e, const char *path) {
+    uint32_t now = timer_read32();
+    if (e->type <= EV_HID) {
+        uint32_t latency = now - e->due_ms;
+        ev_stats.delivered++;
+        ev_stats.total_latency_ms += latency;
+        if (latency > 1) ev_stats.late++;
+        if (latency > ev_stats.max_latency_ms) ev_stats.max_latency_ms = latency;
+        if (opt_verbose) printf("[%7u ms] line %d delivered %u ms late\n", now, e->src_line, latency);
+    }
+    switch (e->type) {
+        case EV_PRESS:
+            key_event(e, true);
+            break;
+        case EV_RELEASE:
+            key_event(e, false);
+            break;
+        case EV_ENCODER:
+            PROBE(P_ENCODER, encoder_update_kb(e->index, e->cw));
+            break;
+        case EV_HID: {
+            uint8_t data[RAW_EPSIZE];
+            memcpy(data, e->data, sizeof(data));
+            PROBE(P_HID, raw_hid_receive(data, e->len));
+            break;
+        }
+        case EV_DUMP:
+            dump_framebuffer();
+            break;
+        case EV_EXPECT_LINE: {
+            char actual[SIM_OLED_COLS + 1];
+            snprintf(actual, sizeof(actual), "%s", sim_oled_text_line(e->index % SIM_OLED_LINES));
+            for (int i = (int)strlen(actual) - 1; i >= 0 && actual[i] == ' '; i--) actual[i] = '\0';
+            if (strcmp(actual, e->text)) {
+                printf("FAIL %s:%d: line %u is \"%s\", expected \"%s\"\n", path, e->src_line, e->index, actual, e->text);
+                ev_stats.failures++;
+            }
+            break;
+        }
+        case EV_EXPECT_HID:
+            if (memcmp(last_hid, e->data, e->len)) {
+                printf("FAIL %s:%d: last hid report is ", path, e->src_line);
+                print_hex(stdout, last_hid, RAW_EPSIZE);
+                printf("\n");
+                ev_stats.failures++;
+            }
+            break;
+        case EV_EXPECT_EXECUTED:
+            if (link.executed != e->index) {
+                printf("FAIL %s:%d: host executed %u button presses, expected %u\n", path, e->src_line, link.executed, e->index);
+                ev_stats.failures++;
+            }
+            break;
+    }
+}
+
+static void print_report(const char *path, uint32_t duration_ms, uint32_t scans, uint64_t worst_gap_us, uint32_t slow_scans) {
+    double secs = duration_ms / 1000.0;
+    printf("== %s: %u ms virtual, %u scans\n", path, duration_ms, scans);
+    if (opt_no_cycles) {
+        printf("%-18s %8s %14s\n", "callback", "calls", "max blocked ms");
+    } else {
+        printf("%-18s %8s %12s %12s %14s\n", "callback", "calls", "avg cycles", "max cycles", "max blocked ms");
+    }
+    for (int i = 0; i < P_COUNT; i++) {
+        const probe_t *p = &probes[i];
+        if (opt_no_cycles) {
+            printf("%-18s %8llu %14.1f\n", p->name, (unsigned long long)p->calls, p->blocked_max_us / 1000.0);
+        } else {
+            printf("%-18s %8llu %12llu %12llu %14.1f\n", p->name, (unsigned long long)p->calls, (unsigned long long)(p->calls ? p->total / p->calls : 0), (unsigned long long)p->max, p->blocked_max_us / 1000.0);
+        }
+    }
+    printf("scan loop : worst gap %.1f ms, %u gaps > 2 ms, %.1f ms blocked\n", worst_gap_us / 1000.0, slow_scans, sim_counters.blocked_us / 1000.0);
+    printf("events    : %u delivered, %u late, max latency %u ms, avg %.1f ms\n", ev_stats.delivered, ev_stats.late, ev_stats.max_latency_ms, ev_stats.delivered ? (double)ev_stats.total_latency_ms / ev_stats.delivered : 0.0);
+    printf("usb       : %u raw hid reports out, %u keyboard reports\n", sim_counters.hid_reports_out, sim_counters.host_key_reports);
+    if (link.on) {
+        printf("link      : %u%% out, %u%% in: %u reports lost, %u acks lost, %u presses executed, %u copies dropped\n", link.out_pct, link.in_pct, link.lost_out, link.lost_in, link.executed, link.copies);
+    }
+    printf("oled      : %llu api bytes (%.0f/s), %llu i2c bytes (%.0f/s), %u clears\n", (unsigned long long)sim_counters.oled_api_bytes, sim_counters.oled_api_bytes / secs, (unsigned long long)sim_counters.oled_i2c_bytes, sim_counters.oled_i2c_bytes / secs, sim_counters.oled_clears);
+}
+
+static int run(const char *path) {
+    if (!has_end) end_ms = (event_count ? events[event_count - 1].due_ms : 0) + 100;
+
+    sim_set_hid_hook(on_hid_send);
+    sim_oled_init();
+    matrix_init_kb();
+    keyboard_post_init_user();
+    oled_init_kb(OLED_ROTATION_0);
+    for (uint8_t op = HID_OP_VOLUME; link.on && op <= HID_OP_LIFX; op++) {
+        uint8_t hello[RAW_EPSIZE] = {op, HID_CMD_ACK};
+        raw_hid_receive(hello, sizeof(hello));
+    }
+
+    size_t   next       = 0;
+    uint32_t scans      = 0;
+    uint32_t slow_scans = 0;
+    uint64_t worst_gap  = 0;
+    uint64_t last_scan  = 0;
+
+    while (timer_read32() < end_ms) {
+        uint64_t tick_start = sim_now_us;
+        while (next < event_count && events[next].due_ms <= timer_read32()) {
+            deliver(&events[next++], path);
+        }
+        while (link.ack_count && link.acks[link.ack_head].due_ms <= timer_read32()) {
+            uint8_t data[RAW_EPSIZE];
+            memcpy(data, link.acks[link.ack_head].data, sizeof(data));
+            link.ack_head = (link.ack_head + 1) % LINK_ACKS;
+            link.ack_count--;
+            PROBE(P_HID, raw_hid_receive(data, sizeof(data)));
+        }
+
+        uint64_t scan_start = sim_now_us;
+        if (scans) {
+            uint64_t gap = scan_start - last_scan;
+            if (gap > worst_gap) worst_gap = gap;
+            if (gap > 2000) slow_scans++;
+        }
+        last_scan = scan_start;
+        scans++;
+        PROBE(P_SCAN, matrix_scan_kb());
+
+        oled_set_cursor(0, 0);
+        PROBE(P_OLED, oled_task_kb());
+        sim_oled_render();
+
+        if (sim_now_us < tick_start + 1000) sim_now_us = tick_start + 1000;
+    }
+    // Checks scheduled at the very end still run.
+    while (next < event_count) deliver(&events[next++], path);
+
+    print_report(path, timer_read32(), scans, worst_gap, slow_scans);
+    return ev_stats.failures ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    const char *scenario = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n")) {
+            opt_no_cycles = true;
+        } else if (!strcmp(argv[i], "-v")) {
+            opt_verbose = true;
+        } else if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+            hid_log = fopen(argv[++i], "a");
+            if (!hid_log) {
+                perror(argv[i]);
+                return 2;
+            }
+        } else {
+            scenario = argv[i];
+        }
+    }
+    if (!scenario) {
+        fprintf(stderr, "usage: %s [-n] [-v] [-l hid.log] scenario.txt\n", argv[0]);
+        return 2;
+    }
+    if (!load_scenario(scenario)) return 2;
+    int rc = run(scenario);
+    if (hid_log) fclose(hid_log);
+    return rc;
+}
@@ -0,0 +1,331 @@
+// QMK core shim for the host simulation build.
+//
+// Models the parts of QMK the tidbit firmware touches closely enough to
+// measure them: a virtual millisecond timer, blocking waits and keyboard
+// reports that cost virtual time, and the SSD1306 driver's page buffer with
+// its 32-byte dirty-block flushing.
+
+#include "quantum.h"
+#include "raw_hid.h"
+#include "sim.h"
+
+sim_counters_t sim_counters;
+uint64_t       sim_now_us;
+
+static sim_hid_hook_t hid_hook;
+
+void sim_advance_us(uint64_t us) {
+    sim_now_us += us;
+}
+
+void sim_set_hid_hook(sim_hid_hook_t hook) {
+    hid_hook = hook;
+}
+
+static void block_us(uint64_t us) {
+    sim_advance_us(us);
+    sim_counters.blocked_us += us;
+}
+
+// --- Timer ---
+
+uint16_t timer_read(void) {
+    return (uint16_t)(sim_now_us / 1000);
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return timer_read() - last;
+}
+
+uint32_t timer_read32(void) {
+    return (uint32_t)(sim_now_us / 1000);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return timer_read32() - last;
+}
+
+uint32_t timer_read_us(void) {
+    return (uint32_t)sim_now_us;
+}
+
+void wait_ms(uint16_t ms) {
+    block_us((uint64_t)ms * 1000);
+}
+
+// --- Host keyboard ---
+
+static led_t    host_leds;
+static uint64_t endpoint_busy_until;
+
+static void send_keyboard_report(void) {
+    sim_counters.host_key_reports++;
+    if (sim_now_us < endpoint_busy_until) block_us(endpoint_busy_until - sim_now_us);
+    endpoint_busy_until = sim_now_us + SIM_HOST_REPORT_US;
+}
+
+void register_code(uint8_t code) {
+    if (code == KC_NUM_LOCK) {
+        host_leds.num_lock = !host_leds.num_lock;
+    }
+    send_keyboard_report();
+}
+
+void unregister_code(uint8_t code) {
+    (void)code;
+    send_keyboard_report();
+}
+
+void tap_code(uint8_t code) {
+    register_code(code);
+    unregister_code(code);
+}
+
+void tap_code16(uint16_t code) {
+    bool mods = (code & 0xFF00) != 0;
+    if (mods) send_keyboard_report();
+    tap_code((uint8_t)code);
+    if (mods) send_keyboard_report();
+}
+
+void send_char(char ascii_code) {
+    uint8_t c       = (uint8_t)ascii_code & 0x7F;
+    bool    shifted = PGM_LOADBIT(ascii_to_shift_lut, c);
+    if (shifted) send_keyboard_report();
+    tap_code(pgm_read_byte(&ascii_to_keycode_lut[c]));
+    if (shifted) send_keyboard_report();
+}
+
+void send_string(const char *str) {
+    while (*str) {
+        send_char(*str++);
+    }
+}
+
+led_t host_keyboard_led_state(void) {
+    return host_leds;
+}
+
+// clang-format off
+const uint8_t ascii_to_keycode_lut[128] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2B, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2C, 0x1E, 0x34, 0x20, 0x21, 0x22, 0x24, 0x34, 0x26, 0x27, 0x25, 0x2E, 0x36, 0x2D, 0x37, 0x38,
+    0x27, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x33, 0x33, 0x36, 0x2E, 0x37, 0x38,
+    0x1F, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x2F, 0x31, 0x30, 0x23, 0x2D,
+    0x35, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x2F, 0x31, 0x30, 0x35, 0x00,
+};
+
+const uint8_t ascii_to_shift_lut[16] = {
+    0x00, 0x00, 0x00, 0x00, 0x7E, 0x0F, 0x00, 0xD4, 0xFF, 0xFF, 0xFF, 0xC7, 0x00, 0x00, 0x00, 0x78,
+};
+// clang-format on
+
+// --- Raw HID ---
+
+void raw_hid_send(uint8_t *data, uint8_t length) {
+    sim_counters.hid_reports_out++;
+    if (hid_hook) hid_hook(data, length);
+}
+
+// --- OLED ---
+
+#define OLED_BLOCK_COUNT (OLED_MATRIX_SIZE / SIM_OLED_BLOCK_SIZE)
+
+static uint8_t  oled_buffer[OLED_MATRIX_SIZE];
+static uint16_t oled_cursor;
+static uint16_t oled_dirty;
+static bool     oled_active = true;
+static char     oled_text[SIM_OLED_LINES][SIM_OLED_COLS + 1];
+
+void sim_oled_init(void) {
+    memset(oled_buffer, 0, sizeof(oled_buffer));
+    memset(oled_text, ' ', sizeof(oled_text));
+    for (uint8_t i = 0; i < SIM_OLED_LINES; i++) oled_text[i][SIM_OLED_COLS] = '\0';
+    oled_cursor = 0;
+    oled_dirty  = 0xFFFF;
+}
+
+const uint8_t *sim_oled_buffer(void) {
+    return oled_buffer;
+}
+
+const char *sim_oled_text_line(uint8_t line) {
+    return oled_text[line];
+}
+
+static void mark_dirty(uint16_t start, uint16_t len) {
+    for (uint16_t b = start / SIM_OLED_BLOCK_SIZE; b <= (start + len - 1) / SIM_OLED_BLOCK_SIZE && b < OLED_BLOCK_COUNT; b++) {
+        oled_dirty |= (uint16_t)1 << b;
+    }
+}
+
+static void text_cell_set(uint16_t index, char c) {
+    uint8_t line = index / OLED_DISPLAY_WIDTH;
+    uint8_t x    = index % OLED_DISPLAY_WIDTH;
+    if (x % OLED_FONT_WIDTH == 0 && x / OLED_FONT_WIDTH < SIM_OLED_COLS) {
+        oled_text[line][x / OLED_FONT_WIDTH] = c;
+    }
+}
+
+// Stand-in font: a blank space glyph and a distinct, non-blank pattern for
+// every other character, so dirty tracking sees the same changes it would
+// with glcdfont.
+static void glyph(char c, bool invert, uint8_t out[OLED_FONT_WIDTH]) {
+    for (uint8_t i = 0; i < OLED_FONT_WIDTH; i++) {
+        uint8_t col = (c == ' ' || i == OLED_FONT_WIDTH - 1) ? 0 : (uint8_t)(c + i * 40);
+        out[i]      = invert ? (uint8_t)~col : col;
+    }
+}
+
+void oled_clear(void) {
+    memset(oled_buffer, 0, sizeof(oled_buffer));
+    memset(oled_text, ' ', sizeof(oled_text));
+    for (uint8_t i = 0; i < SIM_OLED_LINES; i++) oled_text[i][SIM_OLED_COLS] = '\0';
+    oled_cursor = 0;
+    oled_dirty  = 0xFFFF;
+    sim_counters.oled_clears++;
+}
+
+void oled_set_cursor(uint8_t col, uint8_t line) {
+    uint16_t index = line * OLED_DISPLAY_WIDTH + col * OLED_FONT_WIDTH;
+    oled_cursor    = index >= OLED_MATRIX_SIZE ? 0 : index;
+}
+
+static void advance_char(void) {
+    uint16_t next      = oled_cursor + OLED_FONT_WIDTH;
+    uint8_t  remaining = OLED_DISPLAY_WIDTH - (next % OLED_DISPLAY_WIDTH);
+    if (remaining < OLED_FONT_WIDTH) next += remaining;
+    if (next >= OLED_MATRIX_SIZE) next = 0;
+    oled_cursor = next;
+}
+
+void oled_write_char(const char data, bool invert) {
+    if (data == '\n') {
+        uint8_t remaining = (OLED_DISPLAY_WIDTH - (oled_cursor % OLED_DISPLAY_WIDTH)) / OLED_FONT_WIDTH;
+        while (remaining--) oled_write_char(' ', false);
+        return;
+    }
+    uint8_t g[OLED_FONT_WIDTH];
+    glyph(data, invert, g);
+    sim_counters.oled_api_bytes += OLED_FONT_WIDTH;
+    if (memcmp(&oled_buffer[oled_cursor], g, OLED_FONT_WIDTH)) {
+        memcpy(&oled_buffer[oled_cursor], g, OLED_FONT_WIDTH);
+        mark_dirty(oled_cursor, OLED_FONT_WIDTH);
+    }
+    text_cell_set(oled_cursor, data);
+    advance_char();
+}
+
+void oled_write(const char *data, bool invert) {
+    while (*data) {
+        oled_write_char(*data++, invert);
+    }
+}
+
+void oled_write_P(const char *data, bool invert) {
+    oled_write(data, invert);
+}
+
+void oled_write_raw_byte(const char data, uint16_t index) {
+    if (index >= OLED_MATRIX_SIZE) return;
+    sim_counters.oled_api_bytes++;
+    text_cell_set(index, ' ');
+    if (oled_buffer[index] == (uint8_t)data) return;
+    oled_buffer[index] = (uint8_t)data;
+    mark_dirty(index, 1);
+}
+
+void oled_write_raw(const char *data, uint16_t size) {
+    if (size > OLED_MATRIX_SIZE) size = OLED_MATRIX_SIZE;
+    for (uint16_t i = 0; i < size; i++) {
+        oled_write_raw_byte(data[i], i);
+    }
+}
+
+void oled_write_raw_P(const char *data, uint16_t size) {
+    oled_write_raw(data, size);
+}
+
+oled_buffer_reader_t oled_read_raw(uint16_t start_index) {
+    if (start_index > OLED_MATRIX_SIZE) start_index = OLED_MATRIX_SIZE;
+    oled_buffer_reader_t reader = {&oled_buffer[start_index], OLED_MATRIX_SIZE - start_index};
+    return reader;
+}
+
+bool oled_on(void) {
+    oled_active = true;
+    return oled_active;
+}
+
+bool oled_off(void) {
+    oled_active = false;
+    return !oled_active;
+}
+
+// QMK's oled_render() sends at most one dirty block per call
+// (OLED_UPDATE_PROCESS_LIMIT defaults to 1).
+void sim_oled_render(void) {
+    if (!oled_dirty || !oled_active) return;
+    uint8_t block = __builtin_ctz(oled_dirty);
+    oled_dirty &= ~((uint16_t)1 << block);
+    sim_counters.oled_i2c_bytes += SIM_OLED_BLOCK_SIZE + SIM_OLED_BLOCK_OVERHEAD;
+}
+
+// --- RGB light ---
+
+// Mode numbers follow rgblight's enumeration for the animations enabled in
+// keyboard.json: static, breathing x4, rainbow mood x3, christmas, rgb test,
+// alternating.
+#define RGBLIGHT_MODES 11
+
+static uint8_t rgb_mode = 1;
+static uint8_t rgb_hsv[3];
+
+void rgblight_enable(void) {}
+void rgblight_disable_noeeprom(void) {}
+
+void rgblight_step(void) {
+    rgb_mode = rgb_mode >= RGBLIGHT_MODES ? 1 : rgb_mode + 1;
+}
+
+uint8_t rgblight_get_mode(void) {
+    return rgb_mode;
+}
+
+uint8_t rgblight_get_val(void) {
+    return rgb_hsv[2];
+}
+
+void rgblight_sethsv(uint8_t hue, uint8_t sat, uint8_t val) {
+    rgb_hsv[0] = hue;
+    rgb_hsv[1] = sat;
+    rgb_hsv[2] = val;
+}
+
+// --- Weak defaults for optional callbacks ---
+
+__attribute__((weak)) void matrix_init_user(void) {}
+__attribute__((weak)) void matrix_scan_user(void) {}
+__attribute__((weak)) void keyboard_post_init_user(void) {}
+__attribute__((weak)) bool shutdown_user(bool jump_to_bootloader) {
+    return true;
+}
+__attribute__((weak)) bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+__attribute__((weak)) bool encoder_update_user(uint8_t index, bool clockwise) {
+    return true;
+}
+__attribute__((weak)) bool encoder_update_kb(uint8_t index, bool clockwise) {
+    return encoder_update_user(index, clockwise);
+}
+__attribute__((weak)) oled_rotation_t oled_init_user(oled_rotation_t rotation) {
+    return rotation;
+}
+__attribute__((weak)) bool oled_task_user(void) {
+    return true;
+}
+__attribute__((weak)) void raw_hid_receive(uint8_t *data, uint8_t length) {}
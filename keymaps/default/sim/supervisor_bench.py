@@ -0,0 +1,254 @@
+#!/usr/bin/env python3
+"""
+Integration toggles: a Python process per start vs supervisor.py's warm modules
+
+    process     what start_*.bat costs before the script does anything: a
+                fresh interpreter importing the integration (timed for the
+                ones whose dependencies are installed here)
+    supervisor  Supervisor.enable() until the module's serve() runs, and
+                disable() until it has returned, with stand-in modules
+    hid         a run report for VOLUME_START from fake_hid's keyboard
+                until SupervisorAgent's result and the module bits that
+                show it running
+
+Then one stand-in crashes on every start, to show the restart delays
+doubling up to the cap while the keyboard sees it enabled but not running,
+and one needs per-thread setup like pycaw's COM: it must come up on the
+first start, and every integration that uses COM must have a thread_init().
+
+    python3 sim/supervisor_bench.py [--runs N]
+"""
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import threading
+import time
+
+HERE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+sys.path.insert(0, HERE)
+
+from app_table import read_table                                     # noqa: E402
+from fake_hid import fake_pair                                       # noqa: E402
+from hid_protocol import (HID_REPORT_SIZE, HID_OP_ACTION, HID_ACTION_RUN, HID_ACTION_RESULT,  # noqa: E402
+                          HID_ACTION_MODULES, HID_ACTION_ID, HID_ACTION_TAG, HID_ACTION_STATUS,
+                          HID_ACTION_MODULES_ENABLED, HID_ACTION_MODULES_RUNNING,
+                          HID_ACTION_DONE, HID_MODULE_VOLUME)
+from supervisor import MODULES, Supervisor, SupervisorAgent          # noqa: E402
+
+
+class StandIn:
+    """Module with a serve(stop) like the integrations, for timing"""
+
+    def __init__(self, crash=False):
+        self.crash = crash
+        self.serving = threading.Event()
+        self.starts = []
+
+    def serve(self, stop):
+        self.starts.append(time.perf_counter())
+        if self.crash:
+            raise RuntimeError("stand-in crash")
+        self.serving.set()
+        stop.wait()
+        self.serving.clear()
+
+
+class NeedsThreadInit(StandIn):
+    """Stand-in whose backend, like pycaw, works only on threads set up by thread_init()"""
+
+    def __init__(self):
+        super().__init__()
+        self.ready = threading.local()
+        self.cleanups = 0
+
+    def thread_init(self):
+        self.ready.done = True
+        return self.cleanup
+
+    def cleanup(self):
+        self.ready.done = False
+        self.cleanups += 1
+
+    def serve(self, stop):
+        if not getattr(self.ready, "done", False):
+            self.starts.append(time.perf_counter())
+            raise OSError("CoInitialize has not been called")
+        super().serve(stop)
+
+
+def thread_init_check():
+    """(came up, cleanups after one start and stop, modules using COM without thread_init())"""
+    stand_ins = {spec.module: StandIn() for spec in MODULES}
+    volume = stand_ins["volume_balance"] = NeedsThreadInit()
+    supervisor = Supervisor(importer=stand_ins.get, backoff_base=10, log=lambda message: None).preload().start()
+    supervisor.enable("volume")
+    came_up = volume.serving.wait(2)
+    thread = supervisor.states["volume"].thread
+    supervisor.disable("volume")
+    if thread:
+        thread.join(2)
+    supervisor.stop()
+
+    missing = []
+    for spec in MODULES:
+        with open(os.path.join(HERE, spec.module + ".py"), encoding="utf-8") as f:
+            source = f.read()
+        if ("comtypes" in source or "pycaw" in source) and "def thread_init(" not in source:
+            missing.append(spec.module)
+    return came_up, volume.cleanups, missing
+
+
+def process_start(module, runs):
+    """Median seconds for a new interpreter to import module, None if it cannot"""
+    times = []
+    for _ in range(runs):
+        started = time.perf_counter()
+        result = subprocess.run([sys.executable, "-c", f"import {module}"], cwd=HERE,
+                                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        if result.returncode:
+            return None
+        times.append(time.perf_counter() - started)
+    return statistics.median(times)
+
+
+def warm_toggle(runs):
+    """Median seconds from enable() to serve() running and from disable() to its return"""
+    stand_ins = {spec.module: StandIn() for spec in MODULES}
+    supervisor = Supervisor(importer=stand_ins.get, log=lambda message: None).preload().start()
+    volume = stand_ins["volume_balance"]
+    on, off = [], []
+    for _ in range(runs):
+        started = time.perf_counter()
+        supervisor.enable("volume")
+        volume.serving.wait()
+        on.append(time.perf_counter() - started)
+
+        started = time.perf_counter()
+        thread = supervisor.states["volume"].thread
+        supervisor.disable("volume")
+        thread.join()
+        off.append(time.perf_counter() - started)
+    supervisor.stop()
+    return statistics.median(on), statistics.median(off)
+
+
+def hid_toggle(runs):
+    """Median seconds from a VOLUME_START run report to its result and running bit"""
+    _, actions = read_table(os.path.join(HERE, "apps.txt"))
+    start_id = next(i for i, a in enumerate(actions) if a.ident == "VOLUME_START")
+    kill_id = next(i for i, a in enumerate(actions) if a.ident == "VOLUME_KILL")
+    stand_ins = {spec.module: StandIn() for spec in MODULES}
+    supervisor = Supervisor(importer=stand_ins.get, log=lambda message: None).preload().start()
+    host, keyboard = fake_pair()
+    agent = SupervisorAgent(host, actions, {}, supervisor, hello_interval=60, log=lambda message: None).start()
+
+    done = threading.Event()
+
+    def pump():
+        while not done.is_set():
+            data = host.read(HID_REPORT_SIZE, timeout_ms=100)
+            if data:
+                agent.handle(data)
+
+    reader = threading.Thread(target=pump, daemon=True)
+    reader.start()
+
+    def run(action_id, tag, running):
+        """Seconds to the DONE result, and to bits with volume running (or stopped)"""
+        report = bytearray(HID_REPORT_SIZE)
+        report[0], report[1], report[HID_ACTION_ID], report[HID_ACTION_TAG] = HID_OP_ACTION, HID_ACTION_RUN, action_id, tag
+        started = time.perf_counter()
+        keyboard.send(report)
+        result = bits = None
+        while result is None or bits is None:
+            packet = keyboard.receive(timeout=2.0)
+            if packet is None:
+                raise SystemExit(f"no answer to action {action_id}")
+            now = time.perf_counter() - started
+            if packet[1] == HID_ACTION_RESULT and packet[HID_ACTION_TAG] == tag:
+                if packet[HID_ACTION_STATUS] != HID_ACTION_DONE:
+                    raise SystemExit(f"action {action_id} status {packet[HID_ACTION_STATUS]}")
+                result = now
+            elif (packet[1] == HID_ACTION_MODULES
+                    and bool(packet[HID_ACTION_MODULES_RUNNING] & HID_MODULE_VOLUME) == running
+                    and bool(packet[HID_ACTION_MODULES_ENABLED] & HID_MODULE_VOLUME) == running):
+                bits = now
+        return result, bits
+
+    keyboard.receive()  # Hello
+    keyboard.receive()  # Module bits
+    results, bits = [], []
+    for i in range(runs):
+        r, b = run(start_id, (2 * i + 1) & 0xFF, True)
+        results.append(r)
+        bits.append(b)
+        run(kill_id, (2 * i + 2) & 0xFF, False)
+        while stand_ins["volume_balance"].serving.is_set():
+            time.sleep(0.001)
+
+    done.set()
+    reader.join()
+    agent.stop()
+    supervisor.stop()
+    keyboard.close()
+    host.close()
+    return statistics.median(results), statistics.median(bits)
+
+
+def crash_loop(base, cap, restarts):
+    """Start times of a module that crashes at once, and the bits seen meanwhile"""
+    stand_ins = {spec.module: StandIn(crash=spec.module == "lifx_control") for spec in MODULES}
+    supervisor = Supervisor(importer=stand_ins.get, backoff_base=base, backoff_max=cap,
+                            log=lambda message: None).preload().start()
+    seen = set()
+    supervisor.on_change = lambda: seen.add(supervisor.bits())
+    supervisor.enable("lifx")
+    lifx = stand_ins["lifx_control"]
+    while len(lifx.starts) < restarts + 1:
+        time.sleep(base / 10)
+    supervisor.stop()
+    return lifx.starts, seen
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--runs", type=int, default=5, help="runs of each measurement")
+    args = parser.parse_args()
+
+    print(f"median of {args.runs} runs\n")
+    print(f"{'toggle':<46} {'ms':>9}")
+    for spec in MODULES:
+        seconds = process_start(spec.module, args.runs)
+        value = f"{seconds * 1000:9.1f}" if seconds is not None else "  missing"
+        print(f"{'process: python -c import ' + spec.module:<46} {value}")
+    on, off = warm_toggle(args.runs)
+    print(f"{'supervisor: enable() to serve()':<46} {on * 1000:9.3f}")
+    print(f"{'supervisor: disable() to return':<46} {off * 1000:9.3f}")
+    result, bits = hid_toggle(args.runs)
+    print(f"{'hid: VOLUME_START run to result':<46} {result * 1000:9.3f}")
+    print(f"{'hid: VOLUME_START run to running bit':<46} {bits * 1000:9.3f}")
+
+    base, cap = 0.05, 0.4
+    starts, seen = crash_loop(base, cap, restarts=6)
+    delays = [b - a for a, b in zip(starts, starts[1:])]
+    print(f"\ncrashing module, backoff {base * 1000:.0f} ms doubling to {cap * 1000:.0f} ms:")
+    print("  restart delays ms: " + " ".join(f"{d * 1000:.0f}" for d in delays))
+    print("  bits seen (enabled, running): " + " ".join(f"({e:#04x},{r:#04x})" for e, r in sorted(seen)))
+    expected = [min(cap, base * 2 ** i) for i in range(len(delays))]
+    if any(d < e * 0.9 for d, e in zip(delays, expected)):
+        raise SystemExit("restarts came sooner than the backoff")
+
+    came_up, cleanups, missing = thread_init_check()
+    print(f"\nmodule needing per-thread init: {'up on first start' if came_up else 'FAILED to start'}, "
+          f"{cleanups} cleanup(s) after stop")
+    if not came_up or cleanups != 1:
+        raise SystemExit("thread_init() was not run on the module's thread")
+    if missing:
+        raise SystemExit("use COM without a thread_init(): " + ", ".join(missing))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+End-to-end encoder tracing against a fake keyboard, on any OS
+
+Runs the real path of encoder 3 with tracing on: a FakeKeyboard that
+batches and stamps reports like encoder_batch.c, an in-process hid_broker,
+lifx_control.serve() with a lifx_lan.FakeBulb, and trace_log.py writing to
+a temporary directory. Then it prints trace_report.py's stage tables and
+checks that every report sent was traced exactly once.
+
+    python3 sim/trace_bench.py [--turns N] [--seed S]
+"""
+
+import argparse
+import os
+import random
+import sys
+import tempfile
+import threading
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+import hid_client                                                    # noqa: E402
+import lifx_control                                                  # noqa: E402
+from fake_hid import fake_pair, uptime_ms, version_responder        # noqa: E402
+from hid_broker import Broker                                        # noqa: E402
+from hid_protocol import (HID_PROTOCOL_VERSION, HID_OP_COUNT, HID_OP_LIFX,  # noqa: E402
+                          HID_CMD_DELTA, HID_CMD_BUTTON, HID_VELOCITY_SLOW, HID_VELOCITY_MEDIUM,
+                          HID_VELOCITY_FAST)
+from lifx_lan import FakeBulb                                        # noqa: E402
+from trace_log import TRACE_ENV, KIND_EVENT, read_trace             # noqa: E402
+from trace_report import collect, format_report, trace_files        # noqa: E402
+
+WINDOW_MS = 50          # ENCODER_BATCH_WINDOW_MS
+DETENT_MS = (6, 20)     # Spacing of the detents in a turn
+TURN_GAP_MS = (80, 200) # Quiet time between turns
+
+
+def delta(steps, velocity):
+    return [HID_OP_LIFX, HID_CMD_DELTA, steps & 0xFF, velocity]
+
+
+def turn(keyboard, detents, rng):
+    """One turn of the encoder, reported like encoder_batch.c; returns the reports sent
+
+    The first detent goes out at once; the rest that fall within the window
+    are summed into one report when it closes, stamped with the time of the
+    first of them.
+    """
+    keyboard.send_encoder(delta(1, HID_VELOCITY_SLOW))
+    window_end = time.monotonic() + WINDOW_MS / 1000
+    first, pending = None, 0
+    for _ in range(detents - 1):
+        time.sleep(rng.uniform(*DETENT_MS) / 1000)
+        if time.monotonic() >= window_end:
+            break
+        first = uptime_ms() if first is None else first
+        pending += 1
+    if not pending:
+        return 1
+    time.sleep(max(0, window_end - time.monotonic()))
+    keyboard.send_encoder(delta(pending, HID_VELOCITY_MEDIUM if pending < 4 else HID_VELOCITY_FAST), event_ms=first)
+    return 2
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--turns", type=int, default=60, help="encoder turns (every tenth is a button press)")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+    rng = random.Random(args.seed)
+
+    with tempfile.TemporaryDirectory() as traces:
+        os.environ[TRACE_ENV] = traces
+        device, keyboard = fake_pair(version_responder(HID_PROTOCOL_VERSION, HID_OP_COUNT))
+        broker = Broker(open_device=lambda: device, port=0).start()
+        hid_client.BROKER_PORT = broker.port
+        bulb = FakeBulb(lifx_control.LAMP_LABEL)
+
+        stop = threading.Event()
+        daemon = threading.Thread(target=lifx_control.serve, args=(stop, bulb.address, None), daemon=True)
+        daemon.start()
+        deadline = time.monotonic() + 5
+        while lifx_control.lamp is None:
+            if time.monotonic() > deadline:
+                raise SystemExit("lifx_control did not find the fake lamp")
+            time.sleep(0.01)
+        time.sleep(0.1)  # Let its status reports go out first
+
+        sent = 0
+        for i in range(args.turns):
+            if i % 10 == 9:
+                keyboard.send_encoder([HID_OP_LIFX, HID_CMD_BUTTON])
+                sent += 1
+            else:
+                sent += turn(keyboard, rng.randint(1, 6), rng)
+            time.sleep(rng.uniform(*TURN_GAP_MS) / 1000)
+
+        time.sleep(0.2)
+        stop.set()
+        daemon.join(2)
+        broker.stop()
+
+        files = trace_files([traces])
+        events = [r for path in files for r in read_trace(path) if r[0] == KIND_EVENT]
+        print(f"\n{sent} reports sent, {len(events)} traced in {len(files)} file(s)\n")
+        print("\n".join(format_report(*collect(files))))
+        if sorted(r[4] for r in events) != list(range(1, sent + 1)):
+            raise SystemExit("traced sequence numbers do not match the reports sent")
+
+
+if __name__ == "__main__":
+    main()
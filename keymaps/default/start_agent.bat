@@ -0,0 +1,4 @@
+@echo off
+cd /d "C:\Users\Renobatio\qmk_firmware\keyboards\nullbitsco\tidbit" >nul 2>&1
+start "" /min ".venv\Scripts\python.exe" "keymaps\default\action_agent.py"
+exit
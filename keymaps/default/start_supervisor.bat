@@ -0,0 +1,5 @@
+@echo off
+cd /d "C:\Users\Renobatio\qmk_firmware\keyboards\nullbitsco\tidbit" >nul 2>&1
+REM Hosts the monitor, volume balancer, Discord bot and LIFX control, and the action agent
+start "" /min ".venv\Scripts\python.exe" "keymaps\default\supervisor.py"
+exit
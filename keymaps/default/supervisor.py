@@ -0,0 +1,328 @@
+#!/usr/bin/env python3
+"""
+Supervisor for the TIDBIT integrations: one warm process instead of bat files
+
+The system monitor, volume balancer, Discord bot and LIFX control used to
+be started by start_*.bat as a Python process each, and stopped by
+kill_*.bat, some of which end every pythonw.exe at once. Each start paid
+for the interpreter and the imports (pynvml, discord.py, pycaw) again, and
+the keyboard's idea of what was running drifted from the truth.
+
+The supervisor imports every integration once at startup and runs each
+module's serve(stop) on a thread of its own while it is enabled. Switching
+one on or off is a thread start or a stop event, not a process. A module
+whose libraries need per-thread setup (COM for pycaw) has a thread_init(),
+called on that thread before serve(); it returns the matching cleanup. A module
+that crashes, or returns while enabled, is started again after 1, 2, 4 ...
+up to BACKOFF_MAX seconds; the delay resets once it has run STABLE_TIME
+seconds.
+
+It also is the action agent (see action_agent.py): the start and kill
+actions of the supervised modules (the apps.txt actions that run their
+start_*.bat and kill_*.bat) are handled in process, every other action runs
+its command. With its hello and whenever a module changes, it sends the
+keyboard the enabled and running HID_MODULE_* bits, and the firmware takes
+its toggle states from them.
+
+    python supervisor.py                      # or start_supervisor.bat on Windows
+    python supervisor.py --enable monitor,lifx
+    python supervisor.py --list               # modules, their actions and imports
+"""
+
+import argparse
+import importlib
+import sys
+import threading
+import time
+
+from action_agent import APPS_FILE, COMMANDS_FILE, ActionAgent, load_commands, run_agent
+from app_table import read_table
+from hid_protocol import (HID_ACTION_DONE, HID_ACTION_FAILED, HID_MODULE_MONITOR, HID_MODULE_VOLUME,
+                          HID_MODULE_DISCORD, HID_MODULE_LIFX, action_modules_report)
+
+BACKOFF_BASE = 1.0   # Seconds before the first restart of a crashed module
+BACKOFF_MAX = 60.0   # Longest delay between restarts
+STABLE_TIME = 30.0   # Seconds of running after which a crash counts as the first again
+STOP_TIMEOUT = 5.0   # Seconds to wait for a module to stop when the supervisor exits
+
+
+class ModuleSpec:
+    """An integration the supervisor hosts
+
+    Args:
+        name: name on the command line and in the log
+        bit: HID_MODULE_* bit reported to the keyboard
+        module: Python module with a serve(stop) function, and optionally a
+            thread_init() run on the serving thread first, returning a cleanup
+        start_bat, kill_bat: bat files of apps.txt whose actions switch it
+    """
+
+    def __init__(self, name, bit, module, start_bat, kill_bat):
+        self.name = name
+        self.bit = bit
+        self.module = module
+        self.start_bat = start_bat
+        self.kill_bat = kill_bat
+
+
+MODULES = (
+    ModuleSpec("monitor", HID_MODULE_MONITOR, "system_monitor_hid", "start_monitor.bat", "kill_monitor.bat"),
+    ModuleSpec("volume", HID_MODULE_VOLUME, "volume_balance", "start_volume.bat", "kill_volume.bat"),
+    ModuleSpec("discord", HID_MODULE_DISCORD, "discord_voice_control", "start_discord.bat", "kill_discord.bat"),
+    ModuleSpec("lifx", HID_MODULE_LIFX, "lifx_control", "start_lifx.bat", "kill_lifx.bat"),
+)
+
+
+class ModuleState:
+    def __init__(self, spec):
+        self.spec = spec
+        self.code = None        # Imported module
+        self.error = None       # Why it could not be imported
+        self.import_time = 0.0
+        self.enabled = False
+        self.thread = None      # Serving thread, None when not running
+        self.stop = None        # Its stop event
+        self.started_at = 0.0
+        self.failures = 0       # Crashes since it last ran STABLE_TIME
+        self.restarts = 0
+        self.retry_at = 0.0
+        self.last_error = None
+
+
+class Supervisor:
+    """Runs the enabled modules, restarting them with backoff
+
+    Args:
+        specs: ModuleSpec list
+        importer: callable(module name) -> module, importlib's by default
+        backoff_base, backoff_max, stable_time: restart timing, seconds
+        log: callable(message)
+    """
+
+    def __init__(self, specs=MODULES, importer=importlib.import_module, backoff_base=BACKOFF_BASE,
+                 backoff_max=BACKOFF_MAX, stable_time=STABLE_TIME, log=print):
+        self.states = {spec.name: ModuleState(spec) for spec in specs}
+        self.importer = importer
+        self.backoff_base = backoff_base
+        self.backoff_max = backoff_max
+        self.stable_time = stable_time
+        self.log = log
+        self.on_change = None   # callable(), run whenever bits() may have changed
+        self._lock = threading.RLock()
+        self._stop = threading.Event()
+        self._wake = threading.Event()  # A restart was scheduled
+        self._thread = None
+
+    def preload(self):
+        """Import every module now, so enabling one later costs no imports"""
+        for state in self.states.values():
+            started = time.perf_counter()
+            try:
+                state.code = self.importer(state.spec.module)
+            except (ImportError, SystemExit) as e:
+                # volume_balance.py exits when pycaw is missing
+                state.error = f"{type(e).__name__}: {e}"
+            state.import_time = time.perf_counter() - started
+        return self
+
+    def start(self):
+        self._thread = threading.Thread(target=self._watch, name="supervisor", daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self, timeout=STOP_TIMEOUT):
+        """Stop the restart thread and every module"""
+        self._stop.set()
+        self._wake.set()
+        if self._thread:
+            self._thread.join()
+        with self._lock:
+            threads = [s.thread for s in self.states.values() if s.thread]
+            for state in self.states.values():
+                state.enabled = False
+                if state.stop:
+                    state.stop.set()
+        deadline = time.monotonic() + timeout
+        for thread in threads:
+            thread.join(max(0, deadline - time.monotonic()))
+
+    def enable(self, name):
+        """Switch a module on; False if it could not be imported"""
+        with self._lock:
+            state = self.states[name]
+            if state.code is None:
+                self.log(f"{name}: cannot run, {state.error}")
+                return False
+            if not state.enabled:
+                state.enabled = True
+                state.failures = 0
+                if not state.thread:
+                    self._launch(state)
+        self._changed()
+        return True
+
+    def disable(self, name):
+        """Switch a module off; it stops in the background"""
+        with self._lock:
+            state = self.states[name]
+            state.enabled = False
+            if state.stop:
+                state.stop.set()
+        self._changed()
+        return True
+
+    def bits(self):
+        """(enabled, running) HID_MODULE_* bits"""
+        with self._lock:
+            enabled = sum(s.spec.bit for s in self.states.values() if s.enabled)
+            running = sum(s.spec.bit for s in self.states.values() if s.thread and s.enabled)
+        return enabled, running
+
+    def status(self):
+        """{name: (enabled, running, restarts, last error)}"""
+        with self._lock:
+            return {name: (s.enabled, s.thread is not None, s.restarts, s.last_error)
+                    for name, s in self.states.items()}
+
+    def action_handlers(self, actions):
+        """{action ident: handler} for ActionAgent, from the modules' bat files"""
+        def handler(switch, name, label):
+            return lambda: (HID_ACTION_DONE, label) if switch(name) else (HID_ACTION_FAILED, f"{name} not installed")
+
+        handlers = {}
+        for state in self.states.values():
+            for action in actions:
+                if action.command == state.spec.start_bat:
+                    handlers[action.ident] = handler(self.enable, state.spec.name, action.label)
+                elif action.command == state.spec.kill_bat:
+                    handlers[action.ident] = handler(self.disable, state.spec.name, action.label)
+        return handlers
+
+    def _changed(self):
+        if self.on_change:
+            self.on_change()
+
+    def _launch(self, state):
+        state.stop = threading.Event()
+        state.started_at = time.monotonic()
+        state.thread = threading.Thread(target=self._serve, args=(state, state.stop),
+                                        name=f"module-{state.spec.name}", daemon=True)
+        state.thread.start()
+
+    def _serve(self, state, stop):
+        error = None
+        cleanup = None
+        try:
+            thread_init = getattr(state.code, "thread_init", None)
+            if thread_init:
+                cleanup = thread_init()
+            state.code.serve(stop)
+            if not stop.is_set():
+                error = "stopped by itself"
+        except BaseException as e:  # SystemExit from a config check as well
+            error = f"{type(e).__name__}: {e}"
+        finally:
+            if cleanup:
+                cleanup()
+
+        with self._lock:
+            state.thread = None
+            state.stop = None
+            if error and state.enabled:
+                ran = time.monotonic() - state.started_at
+                state.failures = 1 if ran >= self.stable_time else state.failures + 1
+                delay = min(self.backoff_max, self.backoff_base * 2 ** (state.failures - 1))
+                state.retry_at = time.monotonic() + delay
+                state.last_error = error
+                self.log(f"{state.spec.name}: {error}, restarting in {delay:.1f} s")
+                self._wake.set()
+            elif state.enabled:
+                self._launch(state)  # Disabled and enabled again while it was stopping
+        self._changed()
+
+    def _watch(self):
+        """Restart crashed modules when their backoff runs out"""
+        while not self._stop.is_set():
+            self._wake.clear()
+            restarted = False
+            with self._lock:
+                now = time.monotonic()
+                waiting = [s for s in self.states.values() if s.enabled and not s.thread]
+                for state in waiting:
+                    if now >= state.retry_at:
+                        state.restarts += 1
+                        self._launch(state)
+                        restarted = True
+                retry_at = [s.retry_at for s in waiting if not s.thread]
+            if restarted:
+                self._changed()
+            self._wake.wait(min(retry_at) - time.monotonic() if retry_at else None)
+
+
+class SupervisorAgent(ActionAgent):
+    """Action agent that switches the supervisor's modules in process
+
+    Every hello is followed by the module bits, and so is every change.
+    """
+
+    def __init__(self, keyboard, actions, commands, supervisor, **kwargs):
+        super().__init__(keyboard, actions, commands, handlers=supervisor.action_handlers(actions), **kwargs)
+        self.supervisor = supervisor
+        supervisor.on_change = self.send_modules
+
+    def hello(self):
+        super().hello()
+        self.send_modules()
+
+    def send_modules(self):
+        try:
+            self.send(action_modules_report(*self.supervisor.bits()))
+        except OSError:
+            pass  # Sent again with the next hello
+
+
+def print_modules(supervisor, actions):
+    handlers = supervisor.action_handlers(actions)
+    for state in supervisor.states.values():
+        spec = state.spec
+        idents = [a.ident for a in actions if a.ident in handlers and a.command in (spec.start_bat, spec.kill_bat)]
+        loaded = f"imported in {state.import_time * 1000:.0f} ms" if state.code else state.error
+        print(f"  {spec.name:<8} {spec.module + '.py':<26} {', '.join(idents) or '-':<38} {loaded}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--apps", default=APPS_FILE, help="apps.txt the firmware was built from")
+    parser.add_argument("--commands", default=COMMANDS_FILE, help="per-platform commands")
+    parser.add_argument("--enable", default="", help="modules to start with, comma separated")
+    parser.add_argument("--list", action="store_true", help="print the modules and exit")
+    args = parser.parse_args()
+
+    try:
+        _, actions = read_table(args.apps)
+        commands = load_commands(args.commands, actions)
+    except (OSError, ValueError) as e:
+        sys.exit(f"ERROR: {e}")
+    supervisor = Supervisor()
+    enable = [name for name in args.enable.split(",") if name]
+    for name in enable:
+        if name not in supervisor.states:
+            sys.exit(f"ERROR: no module {name}, choose from {', '.join(supervisor.states)}")
+
+    print("Supervisor started, importing the integrations...")
+    supervisor.preload()
+    print_modules(supervisor, actions)
+    if args.list:
+        return
+
+    supervisor.start()
+    for name in enable:
+        supervisor.enable(name)
+    run_agent(lambda keyboard: SupervisorAgent(keyboard, actions, commands, supervisor))
+    print("\nStopping the integrations...")
+    supervisor.stop()
+    print("Supervisor stopped")
+
+
+if __name__ == "__main__":
+    main()
@@ -10,6 +10,8 @@ import os
 import struct
 import mmap
 
+from latency_probe import LatencyProbe
+
 try:
     import pynvml
     NVIDIA_AVAILABLE = True
@@ -98,42 +100,20 @@ def get_fps():
         print(f"FPS reading error: {e}")
         return 0
 
-def get_ping():
-    """
-    Get network latency (ping in milliseconds)
-    Pings Google DNS (8.8.8.8) to measure internet latency
-    """
-    import subprocess
-    try:
-        # Ping Google DNS once with 1 second timeout
-        result = subprocess.run(
-            ['ping', '-n', '1', '-w', '1000', '8.8.8.8'],
-            capture_output=True,
-            text=True,
-            timeout=2
-        )
-
-        # Parse ping time from output
-        # Example output: "Reply from 8.8.8.8: bytes=32 time=15ms TTL=118"
-        if 'time=' in result.stdout:
-            time_str = result.stdout.split('time=')[1].split('ms')[0]
-            return int(time_str.strip())
-        return 0
-    except Exception as e:
-        print(f"Ping error: {e}")
-        return 0
-
 def main():
     """Main monitoring loop"""
     print("System Monitor started...")
     print(f"Writing to: {OUTPUT_FILE}")
 
+    # Probes in the background; the loop only reads the latest result
+    latency = LatencyProbe().start()
+
     while True:
         try:
             cpu_load = get_cpu_load()
             gpu_load = get_gpu_load()
             fps = get_fps()
-            ping = get_ping()
+            ping = int(round(latency.snapshot().last or 0))
 
             # Write stats to file in format: CPU:XX GPU:YY FPS:ZZZ PING:AA
             with open(OUTPUT_FILE, 'w') as f:
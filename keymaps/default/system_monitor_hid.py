@@ -1,151 +1,93 @@
 #!/usr/bin/env python3
 """
 System Monitor for QMK TIDBIT Keyboard - HID RAW Version
-Sends CPU%, GPU%, GPU Memory%, and PING data directly to keyboard via USB HID RAW
+Sends CPU%, GPU%, GPU Memory%, PING, GPU temperature and clocks directly to
+keyboard via USB HID RAW. Metrics are sampled in the background by
+metrics.MetricsEngine; 10 times a second the ones that changed are sent,
+packed into one telemetry frame.
+
+supervisor.py runs serve() on a thread of its own instead of main().
 """
 
-import psutil
+import threading
 import time
-import sys
-import subprocess
 
-try:
-    import pynvml
-    NVIDIA_AVAILABLE = True
-except ImportError:
-    NVIDIA_AVAILABLE = False
-    print("pynvml not available - GPU monitoring disabled")
+from hid_client import HidClient
+from hid_protocol import (monitor_report, check_version, TelemetryEncoder,
+                          HID_METRIC_CPU, HID_METRIC_GPU, HID_METRIC_GPU_MEM, HID_METRIC_PING)
+from metrics import MetricsEngine
 
-try:
-    import hid
-    HID_AVAILABLE = True
-except ImportError:
-    HID_AVAILABLE = False
-    print("ERROR: hidapi not available - install with: pip install hidapi")
-    print("This is REQUIRED for sending data to the keyboard!")
-    exit(1)
+UPDATE_HZ = 10        # Telemetry frames per second (unchanged metrics are not sent)
+TELEMETRY_VERSION = 2 # First firmware protocol version with telemetry frames
 
-# QMK HID RAW settings
-VID = 0x6E61  # OffReno keyboard vendor ID
-PID = 0x6064  # OffReno keyboard product ID
-USAGE_PAGE = 0xFF60
-USAGE = 0x61
+def serve(stop, verbose=False):
+    """Send metrics to the keyboard until stop (a threading.Event) is set
 
-def get_gpu_load():
-    if not NVIDIA_AVAILABLE:
-        return 0
-    try:
-        pynvml.nvmlInit()
-        handle = pynvml.nvmlDeviceGetHandleByIndex(0)
-        utilization = pynvml.nvmlDeviceGetUtilizationRates(handle)
-        return utilization.gpu
-    except:
-        return 0
+    Raises OSError if the HID broker cannot be reached at the start.
+    """
+    # Write-only client, the broker owns the keyboard
+    keyboard = HidClient()
+    print("Connected to HID broker")
+    version = check_version(keyboard)
 
-def get_cpu_load():
-    return int(psutil.cpu_percent(interval=0.1))
+    # Older firmware only understands the fixed 0xF0 packet, sent once a second
+    use_telemetry = version is not None and version >= TELEMETRY_VERSION
+    interval = 1.0 / UPDATE_HZ if use_telemetry else 1.0
+    encoder = TelemetryEncoder()
+    frames = 0
 
-def get_gpu_memory():
-    """Get GPU memory usage percentage using pynvml"""
-    if not NVIDIA_AVAILABLE:
-        return 0
-    try:
-        pynvml.nvmlInit()
-        handle = pynvml.nvmlDeviceGetHandleByIndex(0)
-        mem_info = pynvml.nvmlDeviceGetMemoryInfo(handle)
-        # Return percentage of memory used
-        return int((mem_info.used / mem_info.total) * 100)
-    except:
-        return 0
+    # Providers are opened once and sampled on their own threads
+    engine = MetricsEngine().start()
 
-def get_ping():
+    next_tick = time.monotonic()
     try:
-        # On Windows, prevent console window flash
-        if sys.platform == 'win32':
-            startupinfo = subprocess.STARTUPINFO()
-            startupinfo.dwFlags |= subprocess.STARTF_USESHOWWINDOW
-            creationflags = subprocess.CREATE_NO_WINDOW
-        else:
-            startupinfo = None
-            creationflags = 0
-
-        result = subprocess.run(['ping', '-n', '1', '-w', '1000', '8.8.8.8'],
-                              capture_output=True, text=True, timeout=2,
-                              startupinfo=startupinfo, creationflags=creationflags)
-        if 'time=' in result.stdout:
-            time_str = result.stdout.split('time=')[1].split('ms')[0]
-            return int(time_str.strip())
-        return 0
-    except:
-        return 0
-
-def find_keyboard():
-    print("Searching for keyboard...")
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            if device['usage_page'] == USAGE_PAGE and device['usage'] == USAGE:
-                print(f"Found keyboard: {device['product_string']}")
-                return device['path']
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            print(f"Found possible keyboard: {device['product_string']}")
-            return device['path']
-    return None
+        while not stop.is_set():
+            try:
+                values = engine.latest()
+                cpu_load = values.get(HID_METRIC_CPU, 0)
+                gpu_load = values.get(HID_METRIC_GPU, 0)
+                gpu_mem = values.get(HID_METRIC_GPU_MEM, 0)
+                ping = values.get(HID_METRIC_PING, 0)
+
+                if use_telemetry:
+                    reports = encoder.encode(values)
+                    for report in reports:
+                        keyboard.write(report)
+                    frames += len(reports)
+                else:
+                    keyboard.write(monitor_report(cpu_load, gpu_load, gpu_mem, ping))
+                    frames += 1
+                if verbose:
+                    print(f"CPU:{cpu_load:3d}% GPU:{gpu_load:3d}% VRAM:{gpu_mem:3d}% PING:{ping:3d}ms  reports:{frames}", end='\r')
+
+                next_tick += interval
+                stop.wait(max(0, next_tick - time.monotonic()))
+
+            except Exception as e:
+                print(f"\nError: {e}")
+                stop.wait(1)
+                if isinstance(e, OSError):
+                    # Broker went away - reconnect, starting a new one if needed
+                    try:
+                        keyboard.close()
+                        keyboard = HidClient()
+                    except OSError:
+                        pass
+                encoder.reset()  # Resend everything once the keyboard is back
+                next_tick = time.monotonic()
+    finally:
+        keyboard.close()
+        engine.stop()
 
 def main():
     print("System Monitor with HID RAW started...")
-    keyboard_path = find_keyboard()
-    if not keyboard_path:
-        print("ERROR: Could not find keyboard!")
-        print(f"Looking for VID: 0x{VID:04X}, PID: 0x{PID:04X}")
-        return
-
+    print("Press Ctrl+C to stop.\n")
     try:
-        # Fixed: Use correct hidapi syntax
-        keyboard = hid.device()
-        keyboard.open_path(keyboard_path)
-        print("Connected to keyboard successfully!")
-    except Exception as e:
-        print(f"ERROR: Could not open keyboard: {e}")
-        return
-
-    print("\nMonitoring started. Press Ctrl+C to stop.\n")
-
-    while True:
-        try:
-            cpu_load = get_cpu_load()
-            gpu_load = get_gpu_load()
-            gpu_mem = get_gpu_memory()
-            ping = get_ping()
-
-            # On Windows, HID requires a report ID as the first byte (0x00 for QMK RAW)
-            data = bytearray(33)  # 1 byte report ID + 32 bytes data
-            data[0] = 0x00  # Report ID
-            data[1] = 0xF0  # Data packet identifier
-            data[2] = min(cpu_load, 255)
-            data[3] = min(gpu_load, 255)
-            data[4] = (gpu_mem >> 8) & 0xFF
-            data[5] = gpu_mem & 0xFF
-            data[6] = (ping >> 8) & 0xFF
-            data[7] = ping & 0xFF
-
-            keyboard.write(data)
-            print(f"CPU:{cpu_load:3d}% GPU:{gpu_load:3d}% VRAM:{gpu_mem:3d}% PING:{ping:3d}ms", end='\r')
-            time.sleep(1.0)
-
-        except KeyboardInterrupt:
-            print("\n\nMonitoring stopped")
-            break
-        except Exception as e:
-            print(f"\nError: {e}")
-            time.sleep(1)
-
-    keyboard.close()
-    if NVIDIA_AVAILABLE:
-        try:
-            pynvml.nvmlShutdown()
-        except:
-            pass
+        serve(threading.Event(), verbose=True)
+    except KeyboardInterrupt:
+        print("\n\nMonitoring stopped")
+    except OSError as e:
+        print(f"ERROR: Could not connect to HID broker: {e}")
 
 if __name__ == "__main__":
-    main()
\ No newline at end of file
+    main()
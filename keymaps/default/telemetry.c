@@ -0,0 +1,61 @@
+#include "telemetry.h"
+
+static uint16_t metrics[HID_METRIC_COUNT];
+
+uint16_t telemetry_get(uint8_t id) {
+    return id < HID_METRIC_COUNT ? metrics[id] : 0;
+}
+
+void telemetry_set(uint8_t id, uint16_t value) {
+    if (id < HID_METRIC_COUNT) {
+        metrics[id] = value;
+    }
+}
+
+void telemetry_reset(void) {
+    memset(metrics, 0, sizeof(metrics));
+}
+
+bool telemetry_receive(const uint8_t *data, uint8_t length) {
+    // Decode into a copy so a truncated frame leaves the table untouched
+    uint16_t next[HID_METRIC_COUNT];
+    memcpy(next, metrics, sizeof(next));
+
+    uint8_t count = data[HID_TELEMETRY_COUNT];
+    uint8_t pos   = HID_TELEMETRY_ENTRIES;
+    while (count--) {
+        if (pos >= length) {
+            return false;
+        }
+        uint8_t tag = data[pos++];
+
+        uint32_t raw   = 0;
+        uint8_t  shift = 0;
+        uint8_t  byte;
+        do {
+            if (pos >= length || shift > 14) {  // 3 bytes cover any 16-bit delta
+                return false;
+            }
+            byte = data[pos++];
+            raw |= (uint32_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        uint8_t id = tag & ~HID_TELEMETRY_DELTA;
+        if (id >= HID_METRIC_COUNT) {
+            continue;  // Metric from a newer host script
+        }
+        int32_t value = raw;
+        if (tag & HID_TELEMETRY_DELTA) {
+            // Zigzag: even = positive, odd = negative
+            value = next[id] + ((raw & 1) ? -(int32_t)((raw + 1) >> 1) : (int32_t)(raw >> 1));
+        }
+        next[id] = value < 0 ? 0 : value > 0xFFFF ? 0xFFFF : value;
+    }
+
+    if (!memcmp(next, metrics, sizeof(next))) {
+        return false;
+    }
+    memcpy(metrics, next, sizeof(metrics));
+    return true;
+}
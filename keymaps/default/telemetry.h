@@ -0,0 +1,16 @@
+#pragma once
+
+#include "quantum.h"
+#include "hid_protocol.h"
+
+// Host metrics (CPU/GPU load, VRAM, ping, temperatures, clocks) indexed by
+// the HID_METRIC_* IDs of hid_protocol.h. Filled from HID_OP_TELEMETRY
+// frames, or from the fixed HID_OP_MONITOR packet of older scripts.
+
+uint16_t telemetry_get(uint8_t id);
+void     telemetry_set(uint8_t id, uint16_t value);
+void     telemetry_reset(void);
+
+// Apply a HID_OP_TELEMETRY report. A truncated frame is dropped whole.
+// Returns true if any known metric changed.
+bool telemetry_receive(const uint8_t *data, uint8_t length);
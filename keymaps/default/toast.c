@@ -0,0 +1,121 @@
+#include "toast.h"
+#include "oled_view.h"
+#include "deadline.h"
+
+static toast_t queue[TOAST_QUEUE_SIZE];  // Highest priority first
+static uint8_t count;
+static uint8_t visible = TOAST_ALL;       // Sources the screen mode shows, from toast_task()
+static char    dropped[TOAST_TEXT_SIZE];  // Filled and ignored when a toast cannot be queued
+
+// The shown toast: the one whose clock runs, at most one
+static toast_t *shown(void) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (queue[i].started) {
+            return &queue[i];
+        }
+    }
+    return NULL;
+}
+
+static void remove_at(uint8_t i) {
+    if (queue[i].started) {
+        deadline_cancel(DEADLINE_TOAST);  // The next one's clock starts in toast_task()
+    }
+    memmove(&queue[i], &queue[i + 1], (count - i - 1) * sizeof(toast_t));
+    count--;
+}
+
+static void show_first_visible(void);
+
+static void expire_shown(deadline_id_t id) {
+    toast_t *toast = shown();
+    if (toast) {
+        remove_at(toast - queue);
+    }
+    show_first_visible();
+    oled_view_touch(VIEW_SRC_MESSAGE);
+}
+
+static void show_first_visible(void) {
+    toast_t *next = NULL;
+    for (uint8_t i = 0; i < count && !next; i++) {
+        if (visible & TOAST_BIT(queue[i].source)) {
+            next = &queue[i];
+        }
+    }
+    toast_t *current = shown();
+    if (current == next) {
+        return;
+    }
+    if (current) {
+        current->started = false;  // Outranked or hidden: shown in full when it is back
+        deadline_cancel(DEADLINE_TOAST);
+    }
+    if (next) {
+        next->started = true;
+        if (next->duration_ms != TOAST_STICKY) {
+            deadline_set(DEADLINE_TOAST, next->duration_ms, expire_shown);
+        }
+    }
+    oled_view_touch(VIEW_SRC_MESSAGE);
+}
+
+// Insert a blank toast in priority order; NULL if every queued toast outranks it
+static toast_t *push(toast_source_t source, uint16_t duration_ms) {
+    toast_dismiss(source);
+
+    uint8_t pos = 0;
+    while (pos < count && queue[pos].source < source) {
+        pos++;
+    }
+    if (pos == TOAST_QUEUE_SIZE) {
+        return NULL;
+    }
+    if (count == TOAST_QUEUE_SIZE) {
+        remove_at(count - 1);  // Drop the lowest-priority toast
+    }
+    memmove(&queue[pos + 1], &queue[pos], (count - pos) * sizeof(toast_t));
+    count++;
+
+    toast_t *toast     = &queue[pos];
+    toast->source      = source;
+    toast->started     = false;
+    toast->duration_ms = duration_ms;
+    toast->detail_P    = NULL;
+    toast->text[0]     = '\0';
+    oled_view_touch(VIEW_SRC_MESSAGE);
+    return toast;
+}
+
+char *toast_post(toast_source_t source, uint16_t duration_ms) {
+    toast_t *toast = push(source, duration_ms);
+    return toast ? toast->text : dropped;
+}
+
+void toast_post_P(toast_source_t source, const char *text_P, const char *detail_P, uint16_t duration_ms) {
+    toast_t *toast = push(source, duration_ms);
+    if (toast) {
+        strncpy_P(toast->text, text_P, TOAST_TEXT_SIZE - 1);
+        toast->text[TOAST_TEXT_SIZE - 1] = '\0';
+        toast->detail_P = detail_P;
+    }
+}
+
+void toast_dismiss(toast_source_t source) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (queue[i].source == source) {
+            remove_at(i);
+            oled_view_touch(VIEW_SRC_MESSAGE);
+            return;
+        }
+    }
+}
+
+const toast_t *toast_top(void) {
+    return shown();
+}
+
+void toast_task(uint8_t mode_visible) {
+    visible = mode_visible;
+    show_first_visible();
+}
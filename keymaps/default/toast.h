@@ -0,0 +1,59 @@
+#pragma once
+
+#include "quantum.h"
+
+// Temporary OLED messages ("toasts") from every source in one small queue.
+//
+// Each source has at most one toast queued; posting again replaces it. The
+// queue is kept in priority order (the order of toast_source_t). The
+// screen mode decides which sources can be seen (the Discord screen only
+// gives way to power and Discord toasts), and only the first queued toast
+// of those is shown and runs its clock. Its duration starts when it is
+// shown, so a toast behind a higher-priority one, or one the current mode
+// hides, is shown in full later instead of timing out unseen.
+// toast_task() picks that toast and starts its clock, and must run before
+// the OLED is drawn; the expiry itself is DEADLINE_TOAST in deadline.h.
+//
+// When the queue is full the lowest-priority toast is dropped. Adding a
+// source is one line in toast_source_t.
+
+#define TOAST_QUEUE_SIZE 3
+#define TOAST_TEXT_SIZE  22  // One OLED line plus NUL
+#define TOAST_STICKY     0   // Duration: shown until toast_dismiss()
+#define TOAST_BIT(source) (1 << (source))
+#define TOAST_ALL        0xFF
+
+// Highest priority first
+typedef enum {
+    TOAST_POWER = 0,  // Shutdown/hibernate/restart confirmation
+    TOAST_ACTION,     // Result of a host action (action_agent.py)
+    TOAST_DISCORD,    // Discord bot start/stop, mute status
+    TOAST_LIFX,       // LIFX script status
+    TOAST_VOLUME,     // Volume balancer start/stop
+    TOAST_RGB,        // RGB mode and color
+    TOAST_SOURCE_COUNT
+} toast_source_t;
+
+typedef struct {
+    uint8_t     source;
+    bool        started;      // Shown; its clock (DEADLINE_TOAST) runs
+    uint16_t    duration_ms;
+    const char *detail_P;     // Optional second line, PROGMEM
+    char        text[TOAST_TEXT_SIZE];
+} toast_t;
+
+// Queue a toast and return its text buffer (TOAST_TEXT_SIZE bytes, empty)
+// for the caller to fill
+char *toast_post(toast_source_t source, uint16_t duration_ms);
+
+// Queue a toast with PROGMEM text and an optional PROGMEM second line
+void toast_post_P(toast_source_t source, const char *text_P, const char *detail_P, uint16_t duration_ms);
+
+void toast_dismiss(toast_source_t source);
+
+// The toast to show, or NULL if the mode shows none of the queued ones
+const toast_t *toast_top(void);
+
+// Show the first queued toast of the TOAST_BIT() sources in visible,
+// pausing the one shown before if that is another
+void toast_task(uint8_t visible);
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Trace records of encoder reports, from the keyboard to the host's handler
+
+The firmware stamps every encoder report (HID_OP_VOLUME, HID_OP_DISCORD,
+HID_OP_LIFX) with a sequence number, the keyboard time of the detent or
+button press and the time it was sent (HID_TRACE_* in hid_protocol.h).
+A daemon that handles a report writes one record with that stamp and its
+own receive, dispatch and completion times; trace_report.py turns the
+records into latencies per stage.
+
+Tracing is off unless the TIDBIT_TRACE environment variable names a
+directory. Each daemon then writes <source>-<pid>.trace there:
+
+    TIDBIT_TRACE=traces python supervisor.py
+    python trace_report.py traces
+
+Host times are time.monotonic_ns() // 1000, which all processes share;
+keyboard times are its timer_read32() milliseconds. check_version() with a
+trace records a clock sample (host time before the query, the keyboard's
+uptime, host time after the reply), from which trace_report.py maps the
+keyboard's times onto the host's.
+
+A file is a MAGIC header followed by RECORD_SIZE-byte records, little
+endian (see RECORD).
+"""
+
+import os
+import struct
+import time
+
+from hid_protocol import trace_stamp
+
+TRACE_ENV = "TIDBIT_TRACE"
+MAGIC = b"TIDTRACE1\n"
+
+# kind, opcode, command, steps (int8), seq, keyboard event ms, keyboard
+# sent ms, host received us, host dispatched us, host done us.
+# A clock sample (KIND_SYNC) keeps the keyboard uptime in the event field,
+# the host time before the query in received and after the reply in done.
+RECORD = struct.Struct('<cBBbHIIqqq')
+RECORD_SIZE = RECORD.size
+KIND_EVENT = b'E'
+KIND_SYNC = b'S'
+
+FLUSH_RECORDS = 64  # Records buffered before they are written out
+
+
+def now_us():
+    """Host time of the trace records"""
+    return time.monotonic_ns() // 1000
+
+
+class TraceLog:
+    """Writes trace records for one daemon
+
+    Args:
+        path: file to append to (created with a header if new)
+    """
+
+    enabled = True
+
+    def __init__(self, path):
+        self.path = path
+        new = not os.path.exists(path) or os.path.getsize(path) == 0
+        self.file = open(path, 'ab')
+        if new:
+            self.file.write(MAGIC)
+        self.pending = 0
+
+    def event(self, data, received_us, dispatched_us, done_us=None, steps=0):
+        """Record a handled report; unstamped reports (older firmware) are skipped"""
+        stamp = trace_stamp(data)
+        if stamp is None:
+            return
+        seq, event_ms, sent_ms = stamp
+        self._write(RECORD.pack(KIND_EVENT, data[0], data[1], max(-128, min(127, steps)), seq,
+                                event_ms, sent_ms, received_us, dispatched_us,
+                                now_us() if done_us is None else done_us))
+
+    def sync(self, sent_us, uptime_ms, received_us):
+        """Record a clock sample: a query sent at sent_us answered with uptime_ms at received_us"""
+        self._write(RECORD.pack(KIND_SYNC, 0, 0, 0, 0, uptime_ms, 0, sent_us, 0, received_us))
+        self.flush()
+
+    def _write(self, record):
+        self.file.write(record)
+        self.pending += 1
+        if self.pending >= FLUSH_RECORDS:
+            self.flush()
+
+    def flush(self):
+        self.file.flush()
+        self.pending = 0
+
+    def close(self):
+        if not self.file.closed:
+            self.file.close()
+
+
+class NullTrace:
+    """Stands in for TraceLog while tracing is off"""
+
+    enabled = False
+
+    def event(self, data, received_us, dispatched_us, done_us=None, steps=0):
+        pass
+
+    def sync(self, sent_us, uptime_ms, received_us):
+        pass
+
+    def flush(self):
+        pass
+
+    def close(self):
+        pass
+
+
+def open_trace(source):
+    """TraceLog for the daemon called source if TIDBIT_TRACE is set, else a NullTrace"""
+    directory = os.environ.get(TRACE_ENV)
+    if not directory:
+        return NullTrace()
+    os.makedirs(directory, exist_ok=True)
+    return TraceLog(os.path.join(directory, f"{source}-{os.getpid()}.trace"))
+
+
+def read_trace(path):
+    """Records of a trace file as tuples in RECORD order; ValueError if it is not one"""
+    with open(path, 'rb') as f:
+        if f.read(len(MAGIC)) != MAGIC:
+            raise ValueError(f"{path}: not a trace file")
+        data = f.read()
+    usable = len(data) - len(data) % RECORD_SIZE  # A daemon killed mid-write leaves a partial record
+    return [RECORD.unpack_from(data, offset) for offset in range(0, usable, RECORD_SIZE)]
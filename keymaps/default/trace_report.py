@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Encoder-to-action latency per stage, from the daemons' trace files
+
+Reads the records trace_log.py wrote (see there for turning tracing on)
+and prints, for each encoder, a latency histogram of every stage a report
+goes through:
+
+    batch      first detent to the report leaving the keyboard (encoder_batch.c)
+    transport  report sent to the daemon receiving it: USB, hid_broker.py, socket
+    queue      received to the daemon starting on it
+    handle     dispatch to done: adjust_volumes(), the roster step, the lamp model
+    total      first detent to done
+
+Keyboard times are mapped onto the host clock with the sample of each file
+taken by check_version(); transport and total are good to about half that
+sample's round trip plus the keyboard's 1 ms timer resolution, which is
+printed with them.
+
+    python trace_report.py traces            # every *.trace in the directory
+    python trace_report.py traces/lifx-*.trace
+"""
+
+import argparse
+import glob
+import os
+import sys
+
+from hid_protocol import HID_OP_VOLUME, HID_OP_DISCORD, HID_OP_LIFX
+from trace_log import KIND_EVENT, KIND_SYNC, read_trace
+
+STAGES = ("batch", "transport", "queue", "handle", "total")
+BOUNDS_MS = (0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100)  # Upper bounds of the histogram buckets
+ENCODERS = {HID_OP_VOLUME: "volume (encoder 1)", HID_OP_DISCORD: "discord (encoder 2)", HID_OP_LIFX: "lifx (encoder 3)"}
+
+
+def trace_files(paths):
+    """Trace files named by paths, directories expanded to their *.trace"""
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files.extend(sorted(glob.glob(os.path.join(path, "*.trace"))))
+        else:
+            files.append(path)
+    return files
+
+
+def clock_offset(syncs):
+    """(host us - keyboard ms * 1000, uncertainty us) from the best clock sample, None without one
+
+    The sample with the shortest round trip wins; the keyboard read its
+    clock somewhere within it, taken to be the middle.
+    """
+    if not syncs:
+        return None
+    _, _, _, _, _, uptime_ms, _, sent_us, _, received_us = min(syncs, key=lambda r: r[9] - r[7])
+    return (sent_us + received_us) / 2 - uptime_ms * 1000, (received_us - sent_us) / 2
+
+
+def stage_latencies(records):
+    """({opcode: {stage: [us, ...]}}, worst clock uncertainty us) of one file's records"""
+    sync = clock_offset([r for r in records if r[0] == KIND_SYNC])
+    stages = {}
+    for kind, opcode, _, _, _, event_ms, sent_ms, received, dispatched, done in records:
+        if kind != KIND_EVENT:
+            continue
+        by_stage = stages.setdefault(opcode, {stage: [] for stage in STAGES})
+        by_stage["batch"].append((sent_ms - event_ms) * 1000)
+        by_stage["queue"].append(dispatched - received)
+        by_stage["handle"].append(done - dispatched)
+        if sync:
+            offset = sync[0]
+            by_stage["transport"].append(received - (sent_ms * 1000 + offset))
+            by_stage["total"].append(done - (event_ms * 1000 + offset))
+    return stages, sync[1] if sync else None
+
+
+def collect(files):
+    """Stage latencies of every file merged by opcode, and the worst clock uncertainty"""
+    merged = {}
+    uncertainty = 0.0
+    for path in files:
+        stages, error = stage_latencies(read_trace(path))
+        if error is not None:
+            uncertainty = max(uncertainty, error)
+        for opcode, by_stage in stages.items():
+            target = merged.setdefault(opcode, {stage: [] for stage in STAGES})
+            for stage, values in by_stage.items():
+                target[stage].extend(values)
+    return merged, uncertainty
+
+
+def histogram(values_us):
+    """Counts per BOUNDS_MS bucket, the last one for everything above"""
+    counts = [0] * (len(BOUNDS_MS) + 1)
+    for value in values_us:
+        bucket = 0
+        while bucket < len(BOUNDS_MS) and value >= BOUNDS_MS[bucket] * 1000:
+            bucket += 1
+        counts[bucket] += 1
+    return counts
+
+
+def percentile(ordered, fraction):
+    return ordered[min(len(ordered) - 1, int(len(ordered) * fraction))]
+
+
+def format_report(merged, uncertainty):
+    """Lines of the per-encoder stage tables"""
+    heading = " ".join(f"{'<' + format(b, 'g'):>6}" for b in BOUNDS_MS) + f" {'more':>6}"
+    lines = []
+    for opcode in sorted(merged):
+        by_stage = merged[opcode]
+        lines.append(f"{ENCODERS.get(opcode, hex(opcode))}: {len(by_stage['batch'])} reports")
+        lines.append(f"  {'stage':<10} {'p50 ms':>8} {'p95 ms':>8} {'max ms':>8}  {heading}")
+        for stage in STAGES:
+            values = sorted(by_stage[stage])
+            if not values:
+                lines.append(f"  {stage:<10} {'no clock sample':>26}")
+                continue
+            counts = " ".join(f"{count:6d}" for count in histogram(values))
+            lines.append(f"  {stage:<10} {percentile(values, 0.5) / 1000:8.3f} {percentile(values, 0.95) / 1000:8.3f} "
+                         f"{values[-1] / 1000:8.3f}  {counts}")
+        lines.append("")
+    lines.append(f"transport and total are good to +/-{uncertainty / 1000 + 1:.1f} ms (clock sample, 1 ms keyboard timer)")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("paths", nargs="+", help="trace files, or directories of them")
+    args = parser.parse_args()
+
+    files = trace_files(args.paths)
+    if not files:
+        sys.exit("ERROR: no trace files")
+    try:
+        merged, uncertainty = collect(files)
+    except (OSError, ValueError) as e:
+        sys.exit(f"ERROR: {e}")
+    if not merged:
+        sys.exit("ERROR: no traced reports - is the firmware older than protocol v8?")
+    print("\n".join(format_report(merged, uncertainty)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+Voice channel roster for discord_voice_control.py
+
+VoiceRoster holds the non-bot members in the guild's voice channels in
+display order (channel position, then join order) and is kept up to date
+from on_voice_state_update's before/after states, so a join, leave or move
+costs one sorted-list insert or delete instead of a walk over every voice
+channel and member. Mute, deafen and stream changes leave the roster
+untouched.
+
+The selected user is kept by member ID, so it stays on the same person
+when others join or leave above them. view() is what the OLED shows,
+(index, total, name); the bot only sends a new user report when it differs
+from the last one sent.
+
+FakeGuild and voice_events() stand in for discord.py, to run and benchmark
+the roster without a bot (see sim/roster_bench.py).
+"""
+
+import bisect
+import itertools
+import random
+
+NO_USERS = "No users"  # Shown by the keyboard when the roster is empty
+
+
+class VoiceRoster:
+    """Non-bot voice members in display order, with a selection by member ID"""
+
+    def __init__(self):
+        self.order = []        # Sorted (channel position, channel id, seq, member id)
+        self.entries = {}      # member id -> (sort key, member, channel name)
+        self.seq = itertools.count()
+        self.selected_id = None
+
+    def load(self, guild):
+        """Build the roster from a full scan, once at startup"""
+        self.order.clear()
+        self.entries.clear()
+        for channel in guild.voice_channels:
+            for member in channel.members:
+                if not member.bot:
+                    self._insert(member, channel)
+        self._reselect(0)
+
+    def apply(self, member, before, after):
+        """Apply one voice state update; True if the roster changed"""
+        if member.bot:
+            return False
+        old, new = before.channel, after.channel
+        if old is not None and new is not None and old.id == new.id:
+            return False  # Mute, deafen, stream or video in the same channel
+        if member.id not in self.entries and new is None:
+            return False
+        index = self.index()
+        if member.id in self.entries:
+            self._delete(member.id)
+        if new is not None:
+            self._insert(member, new)
+        if self.selected_id not in self.entries:
+            # The selected user left: select whoever now has their place
+            self._reselect(index)
+        return True
+
+    def _insert(self, member, channel):
+        key = (channel.position, channel.id, next(self.seq), member.id)
+        self.entries[member.id] = (key, member, channel.name)
+        bisect.insort(self.order, key)
+
+    def _delete(self, member_id):
+        key, _, _ = self.entries.pop(member_id)
+        del self.order[bisect.bisect_left(self.order, key)]
+
+    def _reselect(self, index):
+        if not self.order:
+            self.selected_id = None
+        else:
+            self.selected_id = self.order[min(max(index, 0), len(self.order) - 1)][3]
+
+    def index(self):
+        """Position of the selected user, 0 when there is none"""
+        if self.selected_id is None:
+            return 0
+        key = self.entries[self.selected_id][0]
+        return bisect.bisect_left(self.order, key)
+
+    def step(self, steps):
+        """Move the selection by steps, wrapping around"""
+        if self.order:
+            self._reselect((self.index() + steps) % len(self.order))
+
+    def selected(self):
+        """discord.Member of the selected user, or None"""
+        if self.selected_id is None:
+            return None
+        return self.entries[self.selected_id][1]
+
+    def view(self):
+        """(index, total, name) as the OLED shows it"""
+        member = self.selected()
+        if member is None:
+            return 0, 0, NO_USERS
+        return self.index(), len(self.order), member.display_name
+
+    def users(self):
+        """(member, channel name) in display order"""
+        return [self.entries[key[3]][1:] for key in self.order]
+
+    def __len__(self):
+        return len(self.order)
+
+
+# --- Stand-ins for discord.py ---
+
+class FakeMember:
+    def __init__(self, member_id, display_name, bot=False):
+        self.id = member_id
+        self.display_name = display_name
+        self.bot = bot
+
+
+class FakeChannel:
+    def __init__(self, channel_id, name, position):
+        self.id = channel_id
+        self.name = name
+        self.position = position
+        self.members = []      # Join order, like discord.VoiceChannel.members
+
+
+class FakeVoiceState:
+    def __init__(self, channel=None):
+        self.channel = channel
+
+
+class FakeGuild:
+    """Voice channels and their members, changed through join/leave/move"""
+
+    def __init__(self, name="Test server", channels=8):
+        self.name = name
+        self.voice_channels = [FakeChannel(900 + i, f"Voice {i + 1}", i) for i in range(channels)]
+        self.location = {}     # member id -> channel
+
+    def connect(self, member, channel):
+        """Move member to channel (None to disconnect); (before, after) states"""
+        before = FakeVoiceState(self.location.get(member.id))
+        if before.channel is not None:
+            before.channel.members.remove(member)
+            del self.location[member.id]
+        if channel is not None:
+            channel.members.append(member)
+            self.location[member.id] = channel
+        return before, FakeVoiceState(channel)
+
+
+def voice_events(guild, members, rng=None, count=1000, churn=0.5):
+    """Yield (member, before, after) for random voice activity in guild
+
+    About churn of the events are joins, leaves and moves; the rest are
+    mute/deafen toggles, which keep the member in the same channel.
+    """
+    rng = rng or random.Random(1)
+    for _ in range(count):
+        member = rng.choice(members)
+        current = guild.location.get(member.id)
+        if current is not None and rng.random() >= churn:
+            yield member, FakeVoiceState(current), FakeVoiceState(current)
+            continue
+        if current is None:
+            target = rng.choice(guild.voice_channels)
+        elif rng.random() < 0.5:
+            target = None
+        else:
+            target = rng.choice([c for c in guild.voice_channels if c is not current])
+        before, after = guild.connect(member, target)
+        yield member, before, after
@@ -14,26 +14,21 @@ Testing mode: Run with --test flag to use keyboard numeric keys
   3 key = Game up, Discord down (CW)
 
 Game detection: Edit games.txt to add/remove games
+
+supervisor.py runs serve() on a thread of its own instead of main().
 """
 
 import time
 import sys
 import os
+import threading
 
 # Check for test mode
 TEST_MODE = "--test" in sys.argv
 
-try:
-    import hid
-    HID_AVAILABLE = True
-except ImportError:
-    HID_AVAILABLE = False
-    if not TEST_MODE:
-        print("ERROR: hidapi not available - install with: pip install hidapi")
-        exit(1)
-
 try:
     from pycaw.pycaw import AudioUtilities, ISimpleAudioVolume, IAudioEndpointVolume
+    import comtypes
     from comtypes import CLSCTX_ALL
     PYCAW_AVAILABLE = True
 except ImportError:
@@ -51,33 +46,23 @@ if TEST_MODE:
         print("ERROR: keyboard library not available - install with: pip install keyboard")
         exit(1)
 
-# QMK HID RAW settings
-VID = 0x6E61  # OffReno keyboard vendor ID
-PID = 0x6064  # OffReno keyboard product ID
+from audio_sessions import SessionIndex, PycawBackend, REFRESH_INTERVAL
+from game_matcher import GameLibrary
+from hid_client import HidClient
+from hid_protocol import HID_OP_VOLUME, HID_CMD_BUTTON, ReportAcker, check_version, encoder_steps
+from trace_log import now_us, open_trace
 
 VOLUME_STEP = 0.06  # 6% volume change per encoder click
+STOP_POLL_MS = 250  # How often serve() checks whether it should stop
 STEAM_GAMES_PATH = r"D:\Steam\steamapps\common"
 GAMES_FILE = os.path.join(os.path.dirname(__file__), "games.txt")
 
-def load_game_names():
-    """Load game names from games.txt file"""
-    game_names = []
-    if os.path.exists(GAMES_FILE):
-        try:
-            with open(GAMES_FILE, 'r', encoding='utf-8') as f:
-                for line in f:
-                    line = line.strip()
-                    # Skip comments and empty lines
-                    if line and not line.startswith('#'):
-                        game_names.append(line.lower())
-        except Exception as e:
-            print(f"Warning: Could not read games.txt: {e}")
-
-    # Add Discord as fallback
-    if 'discord' not in game_names:
-        game_names.append('discord')
-
-    return game_names
+def load_game_library():
+    """games.txt, compiled for matching and reloaded whenever it is edited"""
+    games = GameLibrary(GAMES_FILE)
+    matcher = games.current()
+    print(f"Loaded {len(matcher)} game names from {'cache' if games.from_cache else 'games.txt'}")
+    return games
 
 def scan_steam_games():
     """Scan Steam directory and update games.txt"""
@@ -147,15 +132,25 @@ def list_all_audio_sessions():
         print("  No active audio sessions found")
     print("=============================\n")
 
-def get_session_by_name(name_part):
-    """Find audio session by process name (case-insensitive partial match)"""
-    sessions = AudioUtilities.GetAllSessions()
-    for session in sessions:
-        if session.Process and session.Process.name():
-            process_name = session.Process.name().lower()
-            if name_part.lower() in process_name:
-                return session
-    return None
+def open_session_index(games):
+    """Index the running audio sessions and keep it fresh in the background"""
+    sessions = SessionIndex(PycawBackend(), games).start()
+
+    discord_session = sessions.discord()
+    if discord_session:
+        print(f"Found Discord: {discord_session.Process.name()}")
+    else:
+        print("WARNING: Discord session not found!")
+
+    game_session = sessions.game()
+    if game_session:
+        print(f"Found game: {game_session.Process.name()}")
+    else:
+        print("WARNING: Game session not found! Make sure a game is running with audio.")
+
+    if not sessions.notified:
+        print(f"New sessions are picked up within {REFRESH_INTERVAL:g} seconds")
+    return sessions
 
 def set_app_volume(session, volume):
     """Set application volume (0.0 to 1.0)"""
@@ -201,8 +196,8 @@ def balance_volumes(discord_session, game_session):
 
 def adjust_volumes(discord_session, game_session, direction):
     """
-    Adjust volumes inversely by 6% each
-    direction: 1 = game up/discord down, -1 = discord up/game down
+    Adjust volumes inversely by VOLUME_STEP per step, in one read-modify-write
+    direction: signed steps, positive = game up/discord down, negative = discord up/game down
     """
     if not discord_session:
         print("\nDiscord session not found!", end='\r')
@@ -224,25 +219,6 @@ def adjust_volumes(discord_session, game_session, direction):
     master_vol = int(get_master_volume() * 100)
     print(f"Master: {master_vol}%  Discord: {int(new_discord*100)}%  Game: {int(new_game*100)}%", end='\r')
 
-def find_keyboard():
-    """Find the OffReno keyboard RAW HID interface"""
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            # QMK RAW HID uses usage_page 0xFF60 and usage 0x61
-            # Check if this is the RAW HID interface
-            if device.get('usage_page') == 0xFF60 and device.get('usage') == 0x61:
-                print(f"Found RAW HID interface: {device.get('interface_number', 'N/A')}")
-                return device['path']
-
-    # Fallback: try any interface with matching VID/PID
-    print("RAW HID interface not found by usage page, trying fallback...")
-    for device in hid.enumerate():
-        if device['vendor_id'] == VID and device['product_id'] == PID:
-            print(f"Using interface: {device.get('interface_number', 'N/A')} usage_page={device.get('usage_page', 'N/A'):04X}")
-            return device['path']
-
-    return None
-
 def main_test_mode():
     """Test mode - use keyboard keys"""
     print("Volume Balancer starting in TEST MODE...")
@@ -256,41 +232,16 @@ def main_test_mode():
     list_all_audio_sessions()
 
     # Load game names from games.txt
-    GAME_NAMES = load_game_names()
-    print(f"Loaded {len(GAME_NAMES)} game names from games.txt")
+    games = load_game_library()
     print("TIP: Edit games.txt to add/remove games, or run with --scan to auto-detect Steam games\n")
 
     # Load sessions at startup
     print("Loading audio sessions...")
 
-    # Find Discord session (always use "discord")
-    discord_session = get_session_by_name("discord")
-    if discord_session:
-        print(f"Found Discord: {discord_session.Process.name()}")
-    else:
-        print("WARNING: Discord session not found!")
-
-    # Find game session (exclude Discord from game search)
-    game_session = None
-    for game_name in GAME_NAMES:
-        if game_name == "discord":  # Skip Discord in game search
-            continue
-        temp_session = get_session_by_name(game_name)
-        if temp_session:
-            # Make sure we didn't accidentally find Discord (e.g., "disco" matches "discord")
-            if temp_session.Process and temp_session.Process.name().lower() != "discord.exe":
-                game_session = temp_session
-                print(f"Found game: {game_session.Process.name()}")
-                break
-
-    if not game_session:
-        print("WARNING: Game session not found! Make sure a game is running with audio.")
+    sessions = open_session_index(games)
 
     print()
 
-    # Cache sessions (refresh every 5 seconds)
-    last_refresh = time.time()
-
     print("Listening for keys... (Press ESC to stop)\n")
 
     # Flag to control the loop
@@ -299,15 +250,15 @@ def main_test_mode():
     # Define key press handlers
     def on_key_1(event):
         if event.event_type == 'down':
-            balance_volumes(discord_session, game_session)
+            balance_volumes(sessions.discord(), sessions.game())
 
     def on_key_2(event):
         if event.event_type == 'down':
-            adjust_volumes(discord_session, game_session, -1)  # Discord up, Game down (CCW)
+            adjust_volumes(sessions.discord(), sessions.game(), -1)  # Discord up, Game down (CCW)
 
     def on_key_3(event):
         if event.event_type == 'down':
-            adjust_volumes(discord_session, game_session, 1)  # Game up, Discord down (CW)
+            adjust_volumes(sessions.discord(), sessions.game(), 1)  # Game up, Discord down (CW)
 
     def on_esc(event):
         nonlocal running
@@ -323,24 +274,6 @@ def main_test_mode():
 
     try:
         while running:
-            # Refresh sessions periodically
-            if time.time() - last_refresh > 5.0:
-                discord_session = get_session_by_name("discord")
-
-                # Try to find game session (exclude Discord)
-                game_session = None
-                for game_name in GAME_NAMES:
-                    if game_name == "discord":  # Skip Discord in game search
-                        continue
-                    temp_session = get_session_by_name(game_name)
-                    if temp_session:
-                        # Make sure we didn't accidentally find Discord
-                        if temp_session.Process and temp_session.Process.name().lower() != "discord.exe":
-                            game_session = temp_session
-                            break
-
-                last_refresh = time.time()
-
             time.sleep(0.1)  # Sleep longer since we're using event handlers
 
     except KeyboardInterrupt:
@@ -349,108 +282,90 @@ def main_test_mode():
         keyboard.unhook_all()
         print("Keyboard hooks removed")
 
-def main_hid_mode():
-    """Production mode - use HID RAW from QMK keyboard encoder"""
-    print("Volume Balancer starting in HID MODE (Encoder Control)...")
-    print("\nEncoder 1 Controls:")
-    print("  CW rotation  = Game up, Discord down")
-    print("  CCW rotation = Discord up, Game down")
-    print("  Button press = Balance (Master 100%, both 75%)\n")
+def thread_init():
+    """Initialize COM on the thread that will run serve(); returns the cleanup
+
+    comtypes only does this for the main thread on import, and pycaw fails
+    with "CoInitialize has not been called" anywhere else. supervisor.py
+    calls this on the module's thread before serve().
+    """
+    comtypes.CoInitializeEx(comtypes.COINIT_MULTITHREADED)
+    return comtypes.CoUninitialize
+
+def serve(stop):
+    """Handle encoder 1 until stop (a threading.Event) is set
 
+    Raises ConnectionError if the HID broker connection is lost, OSError if
+    the broker cannot be reached at the start.
+    """
     # List all audio sessions at startup
     list_all_audio_sessions()
 
     # Load game names from games.txt
-    GAME_NAMES = load_game_names()
-    print(f"Loaded {len(GAME_NAMES)} game names from games.txt")
+    games = load_game_library()
     print("TIP: Edit games.txt to add/remove games\n")
 
-    keyboard_path = find_keyboard()
-    if not keyboard_path:
-        print("ERROR: Could not find OffReno keyboard!")
-        print(f"Looking for VID: 0x{VID:04X}, PID: 0x{PID:04X}")
-        return
-
-    try:
-        keyboard = hid.device()
-        keyboard.open_path(keyboard_path)
-        print("Connected to OffReno keyboard")
-    except Exception as e:
-        print(f"ERROR: Could not open keyboard: {e}")
-        return
+    keyboard = HidClient([HID_OP_VOLUME])
+    print("Connected to HID broker")
+    trace = open_trace("volume")
+    check_version(keyboard, trace=trace)
+    acker = ReportAcker(keyboard, HID_OP_VOLUME).hello()
 
-    print("Listening for encoder commands... (Ctrl+C to stop)\n")
+    print("Listening for encoder commands...\n")
 
     # Load sessions at startup
-    # Find Discord session (always use "discord")
-    discord_session = get_session_by_name("discord")
-    if discord_session:
-        print(f"Found Discord: {discord_session.Process.name()}")
-    else:
-        print("WARNING: Discord session not found!")
+    sessions = open_session_index(games)
 
-    # Find game session (exclude Discord from game search)
-    game_session = None
-    for game_name in GAME_NAMES:
-        if game_name == "discord":  # Skip Discord in game search
-            continue
-        temp_session = get_session_by_name(game_name)
-        if temp_session:
-            # Make sure we didn't accidentally find Discord (e.g., "disco" matches "discord")
-            if temp_session.Process and temp_session.Process.name().lower() != "discord.exe":
-                game_session = temp_session
-                print(f"Found game: {game_session.Process.name()}")
-                break
-
-    if not game_session:
-        print("WARNING: Game session not found! Make sure a game is running with audio.")
+    try:
+        while not stop.is_set():
+            try:
+                # Wait for a report, waking up now and then to check stop;
+                # sessions are refreshed in the background
+                data = keyboard.read(33, timeout_ms=STOP_POLL_MS)
+
+                if data and len(data) > 0:
+                    # Check for volume control commands
+                    if data[0] == HID_OP_VOLUME and acker.accept(data):  # Volume command, not a resent copy
+                        dispatched = now_us()
+                        command = data[1]
+                        discord_session, game_session = sessions.discord(), sessions.game()
+
+                        steps = encoder_steps(data)
+
+                        if steps:  # CW: Game up, Discord down; CCW: Discord up, Game down
+                            adjust_volumes(discord_session, game_session, steps)
+                        elif command == HID_CMD_BUTTON:  # Button press: Rebalance
+                            balance_volumes(discord_session, game_session)
+                        trace.event(data, keyboard.received_us, dispatched, steps=steps)
+
+            except ConnectionError:
+                print("\nHID broker connection lost")
+                raise
+            except Exception as e:
+                print(f"\nError: {e}")
+                stop.wait(1)
+    finally:
+        keyboard.close()
+        sessions.stop()
+        trace.close()
 
-    # Cache sessions (refresh every 5 seconds)
-    last_refresh = time.time()
-
-    while True:
-        try:
-            # Refresh sessions periodically
-            if time.time() - last_refresh > 5.0:
-                discord_session = get_session_by_name("discord")
-
-                # Try to find game session (exclude Discord)
-                game_session = None
-                for game_name in GAME_NAMES:
-                    if game_name == "discord":  # Skip Discord in game search
-                        continue
-                    temp_session = get_session_by_name(game_name)
-                    if temp_session:
-                        # Make sure we didn't accidentally find Discord
-                        if temp_session.Process and temp_session.Process.name().lower() != "discord.exe":
-                            game_session = temp_session
-                            break
-
-                last_refresh = time.time()
-
-            # Read HID data (blocking with 100ms timeout)
-            data = keyboard.read(33, timeout_ms=100)
-
-            if data and len(data) > 0:
-                # Check for volume control commands
-                if data[0] == 0xF1:  # Volume command identifier
-                    command = data[1]
-
-                    if command == 0x01:  # Clockwise: Game up, Discord down
-                        adjust_volumes(discord_session, game_session, 1)
-                    elif command == 0x02:  # Counter-clockwise: Discord up, Game down
-                        adjust_volumes(discord_session, game_session, -1)
-                    elif command == 0x03:  # Button press: Rebalance
-                        balance_volumes(discord_session, game_session)
-
-        except KeyboardInterrupt:
-            print("\n\nVolume Balancer stopped")
-            break
-        except Exception as e:
-            print(f"\nError: {e}")
-            time.sleep(1)
+def main_hid_mode():
+    """Production mode - use HID RAW from QMK keyboard encoder"""
+    print("Volume Balancer starting in HID MODE (Encoder Control)...")
+    print("\nEncoder 1 Controls:")
+    print("  CW rotation  = Game up, Discord down")
+    print("  CCW rotation = Discord up, Game down")
+    print("  Button press = Balance (Master 100%, both 75%)")
+    print("Press Ctrl+C to stop\n")
 
-    keyboard.close()
+    try:
+        serve(threading.Event())
+    except KeyboardInterrupt:
+        print("\n\nVolume Balancer stopped")
+    except ConnectionError:
+        pass
+    except OSError as e:
+        print(f"ERROR: Could not connect to HID broker: {e}")
 
 def main():
     # Check for --scan flag to update games.txt
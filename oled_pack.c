@@ -0,0 +1,43 @@
+#include "oled_pack.h"
+
+#ifdef OLED_ENABLE
+void oled_write_packed_P(const char *data_P) {
+    uint16_t out = 0;
+    while (out < OLED_MATRIX_SIZE) {
+        uint8_t op    = pgm_read_byte(data_P++);
+        uint8_t count = (op & 0x3F) + 1;
+        switch (op & 0xC0) {
+            case OLED_PACK_LITERAL:
+                while (count--) {
+                    oled_write_raw_byte(pgm_read_byte(data_P++), out++);
+                }
+                break;
+
+            case OLED_PACK_ZEROS:
+                while (count--) {
+                    oled_write_raw_byte(0, out++);
+                }
+                break;
+
+            case OLED_PACK_RUN: {
+                uint8_t value = pgm_read_byte(data_P++);
+                count += 2;
+                while (count--) {
+                    oled_write_raw_byte(value, out++);
+                }
+                break;
+            }
+
+            default: {
+                // The source may overlap what this op writes, so read a byte at a time
+                const uint8_t *from = oled_read_raw(out - pgm_read_byte(data_P++) - 1).current_element;
+                count += 2;
+                while (count--) {
+                    oled_write_raw_byte(*from++, out++);
+                }
+                break;
+            }
+        }
+    }
+}
+#endif
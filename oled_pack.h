@@ -0,0 +1,30 @@
+#pragma once
+
+#include "quantum.h"
+
+// Packed full-screen bitmaps for the 128x32 SSD1306.
+//
+// A bitmap is the 512-byte page buffer (4 pages of 128 column bytes) as a
+// stream of ops, produced at build time by keymaps/default/logo_pack.py.
+// Each op is one byte, the top two bits selecting the kind and the low six
+// a count:
+//
+//   00nnnnnn             n+1 literal bytes follow (1-64)
+//   01nnnnnn             n+1 zero bytes (1-64)
+//   10nnnnnn b           n+3 copies of b (3-66)
+//   11nnnnnn d           copy n+3 bytes from d+1 bytes back (3-66, 1-256)
+//
+// Blank columns dominate these logos, and copies pick up shapes repeated
+// along a page or from the page above (d = 127 or 128). The decoder writes
+// each byte straight into the OLED buffer with oled_write_raw_byte(), so it
+// needs no RAM of its own: copies read back what it already wrote.
+
+#define OLED_PACK_LITERAL 0x00
+#define OLED_PACK_ZEROS   0x40
+#define OLED_PACK_RUN     0x80
+#define OLED_PACK_COPY    0xC0
+
+#ifdef OLED_ENABLE
+// Decode a packed bitmap from PROGMEM over the whole screen
+void oled_write_packed_P(const char *data_P);
+#endif
@@ -0,0 +1,119 @@
+#include "perf_stats.h"
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <ch.h>
+#    define CLOCK_NOW() ((perf_time_t)chVTGetSystemTimeX())
+#    define CLOCK_US(ticks) ((uint32_t)TIME_I2US(ticks))
+#elif defined(__AVR__)
+#    include <avr/io.h>
+#    include <util/atomic.h>
+// QMK's millisecond timer is Timer0 in CTC mode with a prescaler of 64
+// (timer_avr.h for F_CPU up to 16 MHz): TCNT0 counts 4 us ticks at 16 MHz
+// and the compare interrupt at OCR0A bumps the millisecond count.
+#    if F_CPU > 16000000 || F_CPU <= 2000000
+#        error "perf_stats.c assumes QMK's Timer0 prescaler of 64"
+#    endif
+#    define TICK_US (64 / (F_CPU / 1000000UL))
+#    define CLOCK_NOW() avr_ticks()
+#    define CLOCK_US(ticks) ((ticks) * TICK_US)
+
+// Milliseconds times ticks per millisecond plus the count within it. The
+// differences stay right across the 32-bit wrap, being taken modulo 2^32.
+static perf_time_t avr_ticks(void) {
+    uint32_t ms;
+    uint8_t  count, top;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms    = timer_read32();
+        count = TCNT0;
+        top   = OCR0A;
+        if ((TIFR0 & _BV(OCF0A)) && count < top) {
+            ms++;  // Compare matched, its interrupt has not run yet
+        }
+    }
+    return ms * (top + 1u) + count;
+}
+#elif defined(PERF_CLOCK_US)
+#    define CLOCK_NOW() ((perf_time_t)PERF_CLOCK_US())
+#    define CLOCK_US(ticks) (ticks)
+#else
+#    define CLOCK_NOW() timer_read32()
+#    define CLOCK_US(ticks) ((ticks) * 1000)
+#endif
+
+const uint16_t PROGMEM perf_bucket_us[PERF_BUCKETS - 1] = {50, 100, 250, 500, 1000, 2500, 10000};
+
+static perf_stats_t probes[PERF_PROBE_COUNT];
+static perf_time_t  last_mark[PERF_PROBE_COUNT];  // Last perf_period() of each probe
+static bool         marked[PERF_PROBE_COUNT];     // last_mark is set
+static uint32_t     dropped;
+static uint32_t     reset_at;  // timer_read32() of the last reset
+
+perf_time_t perf_now(void) {
+    return CLOCK_NOW();
+}
+
+static void add(perf_probe_t probe, uint32_t elapsed_us) {
+    perf_stats_t *stats = &probes[probe];
+    uint16_t      us    = elapsed_us > UINT16_MAX ? UINT16_MAX : elapsed_us;
+    if (stats->calls == 0 || us < stats->min_us) stats->min_us = us;
+    if (us > stats->max_us) stats->max_us = us;
+    stats->calls++;
+
+    // The mean is over the last 32768 to 65535 calls: halving both when the
+    // count is full keeps it without a division per call
+    if (stats->sum_calls == UINT16_MAX) {
+        stats->sum_us /= 2;
+        stats->sum_calls /= 2;
+    }
+    stats->sum_us += us;  // At most 65535 * 65535, no overflow
+    stats->sum_calls++;
+
+    uint8_t bucket = 0;
+    while (bucket < PERF_BUCKETS - 1 && us >= pgm_read_word(&perf_bucket_us[bucket])) {
+        bucket++;
+    }
+    stats->buckets[bucket]++;
+}
+
+void perf_record(perf_probe_t probe, perf_time_t start) {
+    add(probe, CLOCK_US(CLOCK_NOW() - start));
+}
+
+void perf_period(perf_probe_t probe, perf_time_t now) {
+    if (marked[probe]) {
+        add(probe, CLOCK_US(now - last_mark[probe]));
+    }
+    last_mark[probe] = now;
+    marked[probe]    = true;
+}
+
+void perf_drop(void) {
+    dropped++;
+}
+
+const perf_stats_t *perf_get(perf_probe_t probe) {
+    return &probes[probe];
+}
+
+uint16_t perf_mean_us(const perf_stats_t *stats) {
+    return stats->sum_calls ? stats->sum_us / stats->sum_calls : 0;
+}
+
+uint32_t perf_dropped(void) {
+    return dropped;
+}
+
+uint32_t perf_elapsed_ms(void) {
+    return timer_elapsed32(reset_at);
+}
+
+uint16_t perf_resolution_us(void) {
+    return CLOCK_US(1);
+}
+
+void perf_reset(void) {
+    memset(probes, 0, sizeof(probes));
+    memset(marked, 0, sizeof(marked));
+    dropped  = 0;
+    reset_at = timer_read32();
+}
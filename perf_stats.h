@@ -0,0 +1,55 @@
+#pragma once
+
+// Self-profiling of the firmware's main callbacks.
+//
+// Each probe counts its calls and keeps the shortest, longest and mean
+// duration since the last perf_reset(), plus a histogram over the
+// perf_bucket_us bounds. Durations are in microseconds: from the 1 MHz
+// system timer on ChibiOS (RP2040 converter builds), and from Timer0's
+// count, 4 us per tick, on the atmega32u4. Other builds fall back to the
+// millisecond timer, so only stalls of a millisecond or more register.
+// Durations are kept as the HID_OP_PERF reply carries them: min and max
+// saturate at 65535 us, the histogram counts wrap at 65536.
+//
+//     perf_time_t start = perf_now();
+//     ...
+//     perf_record(PERF_OLED, start);
+
+#include "quantum.h"
+
+typedef enum {
+    PERF_SCAN = 0,  // matrix_scan_kb
+    PERF_GAP,       // start of one matrix_scan_kb to the next: the scan period
+    PERF_OLED,      // oled_task_kb
+    PERF_HID,       // raw_hid_receive
+    PERF_ENCODER,   // encoder_update_user
+    PERF_PROBE_COUNT
+} perf_probe_t;
+
+#define PERF_BUCKETS 8  // The last bucket takes everything above the last bound
+
+typedef uint32_t perf_time_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t sum_us;     // Of the last sum_calls calls, see perf_mean_us()
+    uint16_t sum_calls;
+    uint16_t min_us;
+    uint16_t max_us;
+    uint16_t buckets[PERF_BUCKETS];
+} perf_stats_t;
+
+// Upper bounds (exclusive) of the first PERF_BUCKETS - 1 buckets, in us
+extern const uint16_t PROGMEM perf_bucket_us[PERF_BUCKETS - 1];
+
+perf_time_t perf_now(void);
+void        perf_record(perf_probe_t probe, perf_time_t start);  // Duration since start
+void        perf_period(perf_probe_t probe, perf_time_t now);    // Time since the last call, from the second call on
+void        perf_drop(void);                                      // Count a dropped raw HID report
+
+const perf_stats_t *perf_get(perf_probe_t probe);
+uint16_t            perf_mean_us(const perf_stats_t *stats);
+uint32_t            perf_dropped(void);
+uint32_t            perf_elapsed_ms(void);   // Since the last reset
+uint16_t            perf_resolution_us(void);
+void                perf_reset(void);
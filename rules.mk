@@ -1,5 +1,7 @@
 # Project specific files
 PIN_COMPATIBLE = promicro
+SRC += oled_pack.c
+SRC += perf_stats.c
 
 # # Only include these for the *native* Pro Micro/Bit-C build.
 # # When converting to RP2040 etc. (CONVERT_TO != empty) they must be excluded.
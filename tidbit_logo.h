@@ -0,0 +1,18 @@
+// Generated by logo_pack.py from the bitmaps in logos/, do not edit.
+// Draw with oled_write_packed_P(); the format is described in oled_pack.h.
+
+#pragma once
+
+// tidbit_oled: 512 bytes packed into 157
+static const char PROGMEM tidbit_oled[] = {
+    0x01, 0x00, 0x0e, 0x85, 0x1f, 0x83, 0xff, 0x85, 0x1f, 0x00, 0x0e, 0x42, 0x00, 0xfe, 0x80, 0xff,
+    0x00, 0xfe, 0x45, 0x02, 0xf8, 0xfe, 0xfe, 0xc8, 0x1c, 0x08, 0x3e, 0x3e, 0x7e, 0xfc, 0xfc, 0xf8,
+    0xf0, 0xe0, 0xc0, 0xd1, 0x1c, 0x06, 0x3f, 0x7e, 0xfe, 0xfe, 0xfc, 0xf8, 0xe0, 0x43, 0xc7, 0x43,
+    0xc7, 0x66, 0xca, 0x65, 0x00, 0x1e, 0x4a, 0x83, 0xff, 0x40, 0xcd, 0x11, 0xd5, 0x1c, 0x00, 0x03,
+    0x81, 0xff, 0x01, 0xfe, 0xc0, 0xc7, 0x1c, 0x84, 0xe0, 0x07, 0xf0, 0xf0, 0xf8, 0xff, 0xff, 0xbf,
+    0x1f, 0x0f, 0x46, 0xd3, 0x54, 0x48, 0xf6, 0x7f, 0x01, 0x80, 0xe0, 0x81, 0xff, 0x01, 0x7f, 0x03,
+    0xc7, 0x1c, 0x86, 0x03, 0x02, 0x07, 0x07, 0xbf, 0xc1, 0x9a, 0x00, 0xf0, 0xec, 0x7f, 0x01, 0x3f,
+    0x7f, 0xc0, 0x4f, 0x00, 0x3f, 0x4b, 0x00, 0x7f, 0xc1, 0x61, 0x45, 0x02, 0x1f, 0x7f, 0x7f, 0xc0,
+    0x0d, 0x83, 0xf8, 0x80, 0x7c, 0x07, 0x7e, 0x3e, 0x3f, 0x3f, 0x1f, 0x0f, 0x07, 0x01, 0xca, 0x1c,
+    0xc7, 0x1d, 0xc0, 0x1c, 0x00, 0x1f, 0xc4, 0x1c, 0xc2, 0x54, 0xce, 0x66, 0x49
+};